@@ -0,0 +1,402 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+#include "callback_worker_thread/callback_worker_thread_c.h"
+#include "callback_worker_thread/cpu_topology.h"
+#include "callback_worker_thread/parallel.h"
+#include "callback_worker_thread/task_graph.h"
+
+// Run with --benchmark_out=<file> --benchmark_out_format=json to record results, or build the
+// bench_callback_worker_thread_json target which does that for the whole suite.
+
+namespace {
+
+using namespace callback_worker_thread;
+using Clock = std::chrono::steady_clock;
+
+constexpr int kTasksPerProducer = 10000;
+constexpr int kTasksPerBatch = 1000;
+
+// Wait until counter reaches target without sleeping (sleeping would dominate short runs)
+void WaitForCount(const std::atomic<int64_t>& counter, int64_t target) {
+  while (counter.load(std::memory_order_acquire) < target) {
+    std::this_thread::yield();
+  }
+}
+
+QueueType QueueTypeArg(int64_t arg) {
+  return arg == 0 ? QueueType::kLocked : QueueType::kLockFree;
+}
+
+WaitStrategy WaitStrategyArg(int64_t arg) {
+  switch (arg) {
+    case 1:
+      return WaitStrategy::kSpinThenPark;
+    case 2:
+      return WaitStrategy::kYield;
+    case 3:
+      return WaitStrategy::kBusySpin;
+    default:
+      return WaitStrategy::kBlock;
+  }
+}
+
+// Value at quantile q (0..1) of sorted samples
+double Percentile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const auto index = static_cast<size_t>(q * static_cast<double>(sorted.size() - 1));
+  return sorted[index];
+}
+
+double Nanoseconds(Clock::duration duration) {
+  return static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+// Args: producers, workers, queue type (0 = locked, 1 = lock-free)
+void BM_EnqueueThroughput(benchmark::State& state) {
+  const auto producers = static_cast<int>(state.range(0));
+  CallbackWorkerThreadOptions options;
+  options.thread_count = static_cast<size_t>(state.range(1));
+  options.queue_type = QueueTypeArg(state.range(2));
+  CallbackWorkerThread worker(options);
+
+  std::atomic<int64_t> executed(0);
+  int64_t expected = 0;
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    threads.reserve(producers);
+    for (int p = 0; p < producers; ++p) {
+      threads.emplace_back([&worker, &executed]() {
+        for (int i = 0; i < kTasksPerProducer; ++i) {
+          worker.Post([&executed]() { executed.fetch_add(1, std::memory_order_release); });
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    expected += static_cast<int64_t>(producers) * kTasksPerProducer;
+    WaitForCount(executed, expected);
+  }
+  state.SetItemsProcessed(expected);
+}
+BENCHMARK(BM_EnqueueThroughput)
+    ->ArgNames({"producers", "workers", "lockfree"})
+    ->ArgsProduct({{1, 2, 4, 8}, {1, 2, 4, 8}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Unloaded latency of a single task. Args: wait strategy (0 = block, 1 = spin-then-park,
+// 2 = yield, 3 = busy-spin)
+void BM_Latency(benchmark::State& state) {
+  CallbackWorkerThreadOptions options;
+  options.wait_strategy = WaitStrategyArg(state.range(0));
+  CallbackWorkerThread worker(options);
+
+  std::vector<double> to_start;
+  std::vector<double> to_complete;
+  std::atomic<bool> done(false);
+  Clock::time_point started;
+
+  for (auto _ : state) {
+    done.store(false, std::memory_order_relaxed);
+    const Clock::time_point enqueued = Clock::now();
+    worker.Post([&started, &done]() {
+      started = Clock::now();
+      done.store(true, std::memory_order_release);
+    });
+    while (!done.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    const Clock::time_point completed = Clock::now();
+
+    to_start.push_back(Nanoseconds(started - enqueued));
+    to_complete.push_back(Nanoseconds(completed - enqueued));
+  }
+
+  std::sort(to_start.begin(), to_start.end());
+  std::sort(to_complete.begin(), to_complete.end());
+  state.counters["start_p50_ns"] = Percentile(to_start, 0.50);
+  state.counters["start_p99_ns"] = Percentile(to_start, 0.99);
+  state.counters["start_p999_ns"] = Percentile(to_start, 0.999);
+  state.counters["complete_p50_ns"] = Percentile(to_complete, 0.50);
+  state.counters["complete_p99_ns"] = Percentile(to_complete, 0.99);
+  state.counters["complete_p999_ns"] = Percentile(to_complete, 0.999);
+}
+BENCHMARK(BM_Latency)->ArgName("wait_strategy")->DenseRange(0, 3)->UseRealTime();
+
+// Cost of pushing and running a task that does nothing, without and with a future.
+// BM_EmptyTaskPost args: metrics collection (0 = off, 1 = on)
+void BM_EmptyTaskPost(benchmark::State& state) {
+  CallbackWorkerThreadOptions options;
+  options.enable_metrics = state.range(0) != 0;
+  CallbackWorkerThread worker(options);
+  std::atomic<int64_t> executed(0);
+  int64_t expected = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < kTasksPerBatch; ++i) {
+      worker.Post([&executed]() { executed.fetch_add(1, std::memory_order_release); });
+    }
+    expected += kTasksPerBatch;
+    WaitForCount(executed, expected);
+  }
+  state.SetItemsProcessed(expected);
+}
+BENCHMARK(BM_EmptyTaskPost)->ArgName("metrics")->Arg(0)->Arg(1)->UseRealTime();
+
+void BM_EmptyTaskEnqueue(benchmark::State& state) {
+  CallbackWorkerThread worker;
+  std::vector<std::future<void>> futures;
+  futures.reserve(kTasksPerBatch);
+  for (auto _ : state) {
+    for (int i = 0; i < kTasksPerBatch; ++i) {
+      futures.push_back(worker.Enqueue([]() {}));
+    }
+    for (auto& future : futures) {
+      future.wait();
+    }
+    futures.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerBatch);
+}
+BENCHMARK(BM_EmptyTaskEnqueue)->UseRealTime();
+
+// EnqueueDefault copies its string argument into the task. Args: string length
+void BM_EnqueueDefaultString(benchmark::State& state) {
+  CallbackWorkerThread worker;
+  const std::string message(static_cast<size_t>(state.range(0)), 'x');
+  auto callback = [](int, double, const std::string& text) {
+    benchmark::DoNotOptimize(text.data());
+  };
+
+  std::vector<std::future<void>> futures;
+  futures.reserve(kTasksPerBatch);
+  for (auto _ : state) {
+    for (int i = 0; i < kTasksPerBatch; ++i) {
+      futures.push_back(worker.EnqueueDefault(callback, i, 1.0, message));
+    }
+    for (auto& future : futures) {
+      future.wait();
+    }
+    futures.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerBatch);
+  state.SetBytesProcessed(state.iterations() * kTasksPerBatch * state.range(0));
+}
+BENCHMARK(BM_EnqueueDefaultString)->ArgName("length")->RangeMultiplier(8)->Range(8, 32768)
+    ->UseRealTime();
+
+// Remote-memory penalty. One producer per NUMA node fills a buffer (first touch places it in
+// that node's memory) and posts tasks that read it. Args: numa (0 = unpinned workers and one
+// shared queue, 1 = workers bound to nodes with NUMA-local queues). Both variants are equal on
+// single-node machines.
+constexpr size_t kChunkInts = 16 * 1024;
+constexpr size_t kChunksPerNode = 64;
+constexpr int kPassesPerIteration = 4;
+
+void BM_NumaLocality(benchmark::State& state) {
+  const CpuTopology topology = CpuTopology::Detect();
+  const size_t nodes = topology.nodes.size();
+  CallbackWorkerThreadOptions options;
+  options.thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  if (state.range(0) != 0) {
+    options.placement = WorkerPlacement::kNumaNode;
+    options.numa_local_queues = true;
+  }
+  CallbackWorkerThread worker(options);
+
+  std::vector<std::vector<int64_t>> buffers(nodes);
+  std::atomic<int64_t> executed(0);
+  int64_t expected = 0;
+  std::atomic<int64_t> checksum(0);
+
+  auto run_producers = [&](bool allocate) {
+    std::vector<std::thread> producers;
+    for (size_t node = 0; node < nodes; ++node) {
+      producers.emplace_back([&, node, allocate]() {
+        SetCurrentThreadAffinity(topology.nodes[node]);
+        std::vector<int64_t>& buffer = buffers[node];
+        if (allocate) {
+          buffer.assign(kChunkInts * kChunksPerNode, 1);
+          return;
+        }
+        for (size_t chunk = 0; chunk < kChunksPerNode; ++chunk) {
+          const int64_t* data = buffer.data() + chunk * kChunkInts;
+          worker.Post([data, &checksum, &executed]() {
+            int64_t sum = 0;
+            for (size_t i = 0; i < kChunkInts; ++i) {
+              sum += data[i];
+            }
+            checksum.fetch_add(sum, std::memory_order_relaxed);
+            executed.fetch_add(1, std::memory_order_release);
+          });
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+  };
+
+  run_producers(true);
+  for (auto _ : state) {
+    for (int pass = 0; pass < kPassesPerIteration; ++pass) {
+      run_producers(false);
+      expected += static_cast<int64_t>(nodes * kChunksPerNode);
+    }
+    WaitForCount(executed, expected);
+  }
+  benchmark::DoNotOptimize(checksum.load());
+  state.counters["nodes"] = static_cast<double>(nodes);
+  state.SetItemsProcessed(expected);
+  state.SetBytesProcessed(expected * static_cast<int64_t>(kChunkInts * sizeof(int64_t)));
+}
+BENCHMARK(BM_NumaLocality)->ArgName("numa")->Arg(0)->Arg(1)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Fine-grained DAG: layers of empty nodes, each depending on two nodes of the layer above
+// (the shape Taskflow's benchmarks use), on a work-stealing pool so that released nodes go to
+// the releasing worker's deque. Args: layer width
+void BM_TaskGraphLayers(benchmark::State& state) {
+  constexpr int kLayers = 32;
+  const auto width = static_cast<size_t>(state.range(0));
+  CallbackWorkerThreadOptions options;
+  options.thread_count = std::max(std::thread::hardware_concurrency(), 2u);
+  options.work_stealing = true;
+  options.wait_strategy = WaitStrategy::kSpinThenPark;
+  CallbackWorkerThread worker(options);
+  TaskGraph graph;
+  std::vector<TaskGraph::NodeId> above;
+  for (int layer = 0; layer < kLayers; ++layer) {
+    std::vector<TaskGraph::NodeId> current;
+    for (size_t i = 0; i < width; ++i) {
+      current.push_back(graph.Emplace([]() {}));
+      if (!above.empty()) {
+        graph.Precede(above[i], current.back());
+        graph.Precede(above[(i + 1) % width], current.back());
+      }
+    }
+    above = std::move(current);
+  }
+
+  for (auto _ : state) {
+    graph.Run(worker).get();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph.size()));
+}
+BENCHMARK(BM_TaskGraphLayers)->ArgName("width")->Arg(1)->Arg(16)->Arg(256)->UseRealTime();
+
+// Dependent steps: each step needs the previous result. Args: 0 = std::future, the caller
+// blocks in get() before submitting the next step; 1 = Future::Then, submitted up front
+void BM_FutureChain(benchmark::State& state) {
+  constexpr int kSteps = 64;
+  CallbackWorkerThread worker;
+  for (auto _ : state) {
+    int value = 0;
+    if (state.range(0) == 0) {
+      for (int i = 0; i < kSteps; ++i) {
+        value = worker.Enqueue([](int x) { return x + 1; }, value).get();
+      }
+    } else {
+      Future<int> future = worker.EnqueueFuture([]() { return 0; });
+      for (int i = 1; i < kSteps; ++i) {
+        future = future.Then([](int x) { return x + 1; });
+      }
+      value = future.Get();
+    }
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetItemsProcessed(state.iterations() * kSteps);
+}
+BENCHMARK(BM_FutureChain)->ArgName("then")->Arg(0)->Arg(1)->UseRealTime();
+
+// Irregular loop: iteration i costs (i % 256) rounds of integer mixing, so equal-sized chunks
+// carry very different amounts of work
+constexpr int kParallelIterations = 1 << 16;
+
+uint64_t IrregularWork(int i) {
+  uint64_t x = static_cast<uint64_t>(i) + 1;
+  for (int round = 0; round < i % 256; ++round) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  return x;
+}
+
+void BM_ParallelForSerial(benchmark::State& state) {
+  std::vector<uint64_t> out(kParallelIterations);
+  for (auto _ : state) {
+    for (int i = 0; i < kParallelIterations; ++i) {
+      out[static_cast<size_t>(i)] = IrregularWork(i);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kParallelIterations);
+}
+BENCHMARK(BM_ParallelForSerial)->UseRealTime();
+
+// Args: grain (0 = automatic)
+void BM_ParallelForPool(benchmark::State& state) {
+  CallbackWorkerThread worker(std::max(std::thread::hardware_concurrency(), 2u));
+  std::vector<uint64_t> out(kParallelIterations);
+  for (auto _ : state) {
+    ParallelFor(worker, 0, kParallelIterations,
+                [&out](int i) { out[static_cast<size_t>(i)] = IrregularWork(i); },
+                static_cast<size_t>(state.range(0)));
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kParallelIterations);
+}
+BENCHMARK(BM_ParallelForPool)->ArgName("grain")->Arg(0)->Arg(64)->Arg(4096)->UseRealTime();
+
+#if defined(CALLBACK_WORKER_THREAD_BENCH_OPENMP)
+void BM_ParallelForOpenMP(benchmark::State& state) {
+  std::vector<uint64_t> out(kParallelIterations);
+  for (auto _ : state) {
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < kParallelIterations; ++i) {
+      out[static_cast<size_t>(i)] = IrregularWork(i);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kParallelIterations);
+}
+BENCHMARK(BM_ParallelForOpenMP)->UseRealTime();
+#endif
+
+int AddInts(int a, int b) {
+  return a + b;
+}
+
+// Synchronous C API call: enqueue, run on the worker, wait for the result
+void BM_CSyncRoundTrip(benchmark::State& state) {
+  CallbackWorkerThreadC* worker = nullptr;
+  if (callback_worker_create(1, &worker) != CALLBACK_WORKER_SUCCESS) {
+    state.SkipWithError("callback_worker_create failed");
+    return;
+  }
+
+  int result = 0;
+  for (auto _ : state) {
+    callback_worker_enqueue_int_return_sync(worker, AddInts, 1, 2, &result);
+    benchmark::DoNotOptimize(result);
+  }
+  callback_worker_destroy(worker);
+}
+BENCHMARK(BM_CSyncRoundTrip)->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -122,6 +122,20 @@ int main() {
     }
     printf("  Parallel tasks completed\n\n");
 
+    // 6b. Asynchronous submission with a completion handle
+    printf("6b. Asynchronous task execution:\n");
+    CallbackWorkerTaskHandle* handle = NULL;
+    for (int i = 0; i < 3; ++i) {
+        result = callback_worker_enqueue_int_async(worker, int_callback, i, NULL);
+        CHECK_RESULT(result, "Async task enqueue");
+    }
+    result = callback_worker_enqueue_string_async(worker, string_callback, "Async done", &handle);
+    CHECK_RESULT(result, "Async task enqueue with handle");
+    result = callback_worker_task_wait_timeout(handle, 1000);
+    CHECK_RESULT(result, "Async task wait");
+    callback_worker_task_release(handle);
+    printf("  Asynchronous tasks submitted\n\n");
+
     // 7. Check queue size
     result = callback_worker_get_queue_size(worker, &queue_size);
     CHECK_RESULT(result, "Final queue size get");
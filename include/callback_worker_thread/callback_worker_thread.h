@@ -1,17 +1,235 @@
 #ifndef CALLBACK_WORKER_THREAD_CALLBACK_WORKER_THREAD_H_
 #define CALLBACK_WORKER_THREAD_CALLBACK_WORKER_THREAD_H_
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
+#include <iterator>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#include "callback_worker_thread/callback_worker_thread_options.h"
+#include "callback_worker_thread/cancellation.h"
+#include "callback_worker_thread/cpu_topology.h"
+#include "callback_worker_thread/future.h"
+#include "callback_worker_thread/metrics.h"
+#include "callback_worker_thread/mpmc_queue.h"
+#include "callback_worker_thread/task.h"
+#include "callback_worker_thread/task_allocator.h"
+#include "callback_worker_thread/timer_wheel.h"
+#include "callback_worker_thread/work_stealing_deque.h"
+
 namespace callback_worker_thread {
 
+/// Thrown when a bounded queue is full and the overflow policy is OverflowPolicy::kReject
+class QueueFullError : public std::runtime_error {
+ public:
+  QueueFullError() : std::runtime_error("Cannot enqueue task: queue is full") {}
+};
+
+namespace detail {
+
+/// @return Promise whose shared state is placed by the task allocator (unless R is over-aligned)
+template <typename R>
+std::promise<R> MakeTaskPromise() {
+  if constexpr (IsTaskAllocatable<R>()) {
+    return std::promise<R>(std::allocator_arg, TaskAllocator<char>());
+  } else {
+    return std::promise<R>();
+  }
+}
+
+/**
+ * @brief Run a nullary invoker and publish its result through a promise
+ * @param promise Promise receiving the return value or the thrown exception
+ * @param invoke Invoker returning R
+ */
+template <typename R, typename Invoke>
+void FulfillPromise(std::promise<R>& promise, Invoke&& invoke) {
+  try {
+    if constexpr (std::is_void<R>::value) {
+      invoke();
+      promise.set_value();
+    } else {
+      promise.set_value(invoke());
+    }
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+  }
+}
+
+/**
+ * @brief Completion state shared by the tasks of an aggregate batch
+ *
+ * The last task to finish fulfills the promise, with the first exception thrown by any task
+ * of the batch if there was one.
+ */
+class BatchCompletion {
+ public:
+  explicit BatchCompletion(size_t count) : remaining_(count) {}
+
+  std::future<void> GetFuture() { return promise_.get_future(); }
+
+  /**
+   * @brief Record completion of one task
+   * @param exception Exception thrown by the task, or nullptr
+   */
+  void Complete(std::exception_ptr exception) {
+    if (exception) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!first_exception_) {
+        first_exception_ = exception;
+      }
+    }
+    if (remaining_.fetch_sub(1) == 1) {
+      // All other tasks have finished, so first_exception_ is no longer written
+      if (first_exception_) {
+        promise_.set_exception(first_exception_);
+      } else {
+        promise_.set_value();
+      }
+    }
+  }
+
+ private:
+  std::atomic<size_t> remaining_;
+  std::mutex mutex_;
+  std::exception_ptr first_exception_;
+  std::promise<void> promise_;
+};
+
+/**
+ * @brief Wrap a nullary callable so that it reports to a BatchCompletion
+ * @param completion Shared completion state
+ * @param func Callable (its return value is discarded)
+ * @return Task reporting the callable's outcome to completion
+ */
+template <typename F>
+Task MakeBatchTask(const std::shared_ptr<BatchCompletion>& completion, F&& func) {
+  return Task([completion, func = std::forward<F>(func)]() mutable {
+    std::exception_ptr exception;
+    try {
+      func();
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    completion->Complete(exception);
+  });
+}
+
+/// Result type of a cancellable task: callables accepting the token first receive it
+template <typename F, typename... Args>
+struct CancellableResult
+    : std::conditional_t<std::is_invocable_v<F, const CancellationToken&, Args...>,
+                         std::invoke_result<F, const CancellationToken&, Args...>,
+                         std::invoke_result<F, Args...>> {};
+
+/**
+ * @brief Call a cancellable task's callable with its bound arguments
+ * @param func Callable
+ * @param token Token passed first if func accepts it
+ * @param args Tuple of bound arguments
+ * @return Result of the call
+ */
+template <typename F, typename Tuple>
+decltype(auto) ApplyWithToken(F& func, const CancellationToken& token, Tuple& args) {
+  return std::apply(
+      [&func, &token](auto&... unpacked) -> decltype(auto) {
+        if constexpr (std::is_invocable_v<F&, const CancellationToken&, decltype(unpacked)...>) {
+          return std::invoke(func, token, unpacked...);
+        } else {
+          return std::invoke(func, unpacked...);
+        }
+      },
+      args);
+}
+
+/// State of a delayed or periodic task (defined in the source file)
+struct TimerEntry;
+
+/// Per-run state of a TaskGraph (defined in the task graph source file)
+struct GraphRun;
+
+/// State of one ParallelFor/ParallelReduce/ParallelTransform call (defined in parallel.cpp)
+struct ParallelJob;
+
+}  // namespace detail
+
+class CallbackWorkerThread;
+
+/**
+ * @brief Handle to a delayed or periodic task (see CallbackWorkerThread::EnqueueAfter)
+ *
+ * Copies refer to the same timer; a default-constructed handle refers to none. Dropping the
+ * handle does not cancel the timer. Once the pool is destroyed the handle does nothing.
+ */
+class TimerHandle {
+ public:
+  TimerHandle() = default;
+
+  /**
+   * @brief Cancel the timer (O(1), no queue scan)
+   * @return true if this call prevented a run: a delayed task that had not fired yet, or the
+   *         remaining runs of a periodic task (a run already in progress finishes)
+   *
+   * A cancelled delayed task is destroyed, so its future reports
+   * std::future_errc::broken_promise.
+   */
+  bool Cancel();
+
+  /**
+   * @brief Check whether the timer may still run
+   * @return true if a delayed task has not fired yet, or a periodic task is not cancelled
+   */
+  bool IsActive() const;
+
+ private:
+  friend class CallbackWorkerThread;
+
+  TimerHandle(CallbackWorkerThread* pool, std::weak_ptr<detail::TimerEntry> entry)
+      : pool_(pool), entry_(std::move(entry)) {}
+
+  CallbackWorkerThread* pool_ = nullptr;
+  std::weak_ptr<detail::TimerEntry> entry_;
+};
+
+/**
+ * @brief Result of CallbackWorkerThread::EnqueueAfter / EnqueueAt
+ * @tparam R Return type of the task
+ */
+template <typename R>
+struct ScheduledTask {
+  /// Result of the task; broken_promise if it was cancelled or the pool stopped first
+  std::future<R> future;
+  /// Cancels the task before it fires
+  TimerHandle timer;
+};
+
+/**
+ * @brief Result of CallbackWorkerThread::EnqueueCancellable
+ * @tparam R Return type of the task
+ */
+template <typename R>
+struct CancellableTask {
+  /// Result of the task; broken_promise if it was cancelled before it started
+  std::future<R> future;
+  /// Cancels the task (see CallbackWorkerThread::Enqueue(CancellationToken, ...))
+  CancellationSource cancellation;
+};
+
 /**
  * @brief Thread pool class for callback processing
  * 
@@ -27,12 +245,24 @@ class CallbackWorkerThread {
   template<typename... Args>
   using Callback = std::function<void(Args...)>;
 
+  /// Handler for exceptions thrown by posted (fire-and-forget) tasks
+  using ExceptionHandler = std::function<void(std::exception_ptr)>;
+
   /**
    * @brief Constructor
    * @param thread_count Number of worker threads (default: 1)
    */
   explicit CallbackWorkerThread(size_t thread_count = 1);
 
+  /**
+   * @brief Constructor with options
+   * @param options Construction options (thread count, queue implementation, ...)
+   * @throws std::invalid_argument if options.thread_count is 0 or outside the elastic bounds,
+   *         max_queue_size exceeds lock_free_queue_size with QueueType::kLockFree, or
+   *         numa_local_queues is set without a placement
+   */
+  explicit CallbackWorkerThread(const CallbackWorkerThreadOptions& options);
+
   /**
    * @brief Destructor
    * 
@@ -59,6 +289,19 @@ class CallbackWorkerThread {
                                    double arg2,
                                    const std::string& arg3);
 
+  /**
+   * @brief Enqueue default callback function, moving the string argument into the task
+   * @param callback Callback function to execute
+   * @param arg1 First argument
+   * @param arg2 Second argument
+   * @param arg3 Third argument; its buffer is handed to the callback without being copied
+   * @return Future for retrieving execution result
+   */
+  std::future<void> EnqueueDefault(DefaultCallback callback,
+                                   int arg1,
+                                   double arg2,
+                                   std::string&& arg3);
+
   /**
    * @brief Enqueue generic callback function
    * @tparam F Function type
@@ -66,23 +309,399 @@ class CallbackWorkerThread {
    * @param f Function to execute
    * @param args Function arguments
    * @return Future for retrieving execution result
+   *
+   * If CallbackWorkerThreadOptions::max_queue_size is set and the queue is full, this blocks,
+   * throws QueueFullError or drops the oldest task, according to the overflow policy (as do
+   * Post and the batch functions).
    */
   template<typename F, typename... Args>
   auto Enqueue(F&& f, Args&&... args) 
       -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+  /**
+   * @brief Enqueue generic callback function with a priority
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param priority Scheduling priority
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future for retrieving execution result
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Each priority level has its own FIFO; workers take from the highest non-empty level
+   * (subject to CallbackWorkerThreadOptions::starvation_limit). In work-stealing mode only
+   * kNormal tasks submitted from a worker go to its local deque.
+   */
+  template<typename F, typename... Args>
+  auto Enqueue(TaskPriority priority, F&& f, Args&&... args)
+      -> std::future<typename std::invoke_result<F, Args...>::type>;
+
+  /**
+   * @brief Enqueue a range of callables as one batch
+   * @tparam InputIt Input iterator whose value type is invocable with no arguments
+   * @param first Beginning of the range
+   * @param last End of the range
+   * @return Futures for the individual results, in range order
+   * @throws std::runtime_error if the thread pool is stopped (no task is enqueued)
+   *
+   * The whole batch is inserted under one queue lock acquisition, and at most
+   * min(N, parked workers) threads are woken. Callables are copied out of the range
+   * (use std::make_move_iterator to move them).
+   */
+  template<typename InputIt>
+  auto EnqueueBatch(InputIt first, InputIt last)
+      -> std::vector<std::future<
+          std::invoke_result_t<typename std::iterator_traits<InputIt>::value_type&>>>;
+
+  /**
+   * @brief Enqueue one callable for each argument of a range as one batch
+   * @tparam F Function type invocable with the range's value type
+   * @tparam InputIt Input iterator
+   * @param f Function to execute (copied into every task)
+   * @param first Beginning of the argument range
+   * @param last End of the argument range
+   * @return Futures for the individual results, in range order
+   * @throws std::runtime_error if the thread pool is stopped (no task is enqueued)
+   */
+  template<typename F, typename InputIt>
+  auto EnqueueBatch(F&& f, InputIt first, InputIt last)
+      -> std::vector<std::future<std::invoke_result_t<
+          std::decay_t<F>&, typename std::iterator_traits<InputIt>::value_type&>>>;
+
+  /**
+   * @brief Enqueue a range of callables as one batch with a single aggregate future
+   * @tparam InputIt Input iterator whose value type is invocable with no arguments
+   * @param first Beginning of the range
+   * @param last End of the range
+   * @return Future that becomes ready when every task has finished. If any task threw, it
+   *         holds the first exception thrown. Ready immediately for an empty range.
+   * @throws std::runtime_error if the thread pool is stopped (no task is enqueued)
+   */
+  template<typename InputIt>
+  std::future<void> EnqueueBatchAll(InputIt first, InputIt last);
+
+  /**
+   * @brief Enqueue one callable per argument as one batch with a single aggregate future
+   * @tparam F Function type invocable with the range's value type
+   * @tparam InputIt Input iterator
+   * @param f Function to execute (copied into every task)
+   * @param first Beginning of the argument range
+   * @param last End of the argument range
+   * @return Future that becomes ready when every task has finished (see above)
+   * @throws std::runtime_error if the thread pool is stopped (no task is enqueued)
+   */
+  template<typename F, typename InputIt>
+  std::future<void> EnqueueBatchAll(F&& f, InputIt first, InputIt last);
+
+  /**
+   * @brief Post a range of callables as one batch without result channels
+   * @tparam InputIt Input iterator whose value type is invocable with no arguments
+   * @param first Beginning of the range
+   * @param last End of the range
+   * @throws std::runtime_error if the thread pool is stopped (no task is posted)
+   */
+  template<typename InputIt>
+  void PostBatch(InputIt first, InputIt last);
+
+  /**
+   * @brief Post one callable for each argument of a range as one batch
+   * @tparam F Function type invocable with the range's value type
+   * @tparam InputIt Input iterator
+   * @param f Function to execute (copied into every task)
+   * @param first Beginning of the argument range
+   * @param last End of the argument range
+   * @throws std::runtime_error if the thread pool is stopped (no task is posted)
+   */
+  template<typename F, typename InputIt>
+  void PostBatch(F&& f, InputIt first, InputIt last);
+
+  /**
+   * @brief Post default callback function without a result channel
+   * @param callback Callback function to execute
+   * @param arg1 First argument
+   * @param arg2 Second argument
+   * @param arg3 Third argument
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Exceptions thrown by the callback are passed to the exception handler.
+   */
+  void PostDefault(DefaultCallback callback, int arg1, double arg2, const std::string& arg3);
+
+  /**
+   * @brief Post default callback function, moving the string argument into the task
+   * @param callback Callback function to execute
+   * @param arg1 First argument
+   * @param arg2 Second argument
+   * @param arg3 Third argument; its buffer is handed to the callback without being copied
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  void PostDefault(DefaultCallback callback, int arg1, double arg2, std::string&& arg3);
+
+  /**
+   * @brief Post generic callback function without a result channel (fire-and-forget)
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param f Function to execute (its return value is discarded)
+   * @param args Function arguments
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * No future or promise is created. If the callable and its arguments fit in
+   * Task::kInlineSize bytes, posting does not allocate at all. Exceptions thrown by the
+   * callable are passed to the exception handler.
+   */
+  template<typename F, typename... Args>
+  void Post(F&& f, Args&&... args);
+
+  /**
+   * @brief Post generic callback function with a priority (fire-and-forget)
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param priority Scheduling priority
+   * @param f Function to execute (its return value is discarded)
+   * @param args Function arguments
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  void Post(TaskPriority priority, F&& f, Args&&... args);
+
+  /**
+   * @brief Enqueue generic callback function that can be cancelled
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param token Cancellation token (from a CancellationSource or GetTagToken)
+   * @param f Function to execute; if it is invocable as f(token, args...), it receives the
+   *        token so that it can poll it and stop early
+   * @param args Function arguments
+   * @return Future for retrieving execution result
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * A task whose token is cancelled before it starts is skipped when a worker dequeues it: the
+   * check is O(1) and the queue is never scanned. Its future then reports
+   * std::future_errc::broken_promise. Skipped tasks still count as in flight until dequeued.
+   */
+  template<typename F, typename... Args>
+  auto Enqueue(CancellationToken token, F&& f, Args&&... args)
+      -> std::future<typename detail::CancellableResult<F, Args...>::type>;
+
+  /**
+   * @brief Enqueue generic callback function with its own cancellation source
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param f Function to execute (may take the token first, as for Enqueue(CancellationToken, ...))
+   * @param args Function arguments
+   * @return Future plus the source that cancels the task
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  auto EnqueueCancellable(F&& f, Args&&... args)
+      -> CancellableTask<typename detail::CancellableResult<F, Args...>::type>;
+
+  /**
+   * @brief Post generic callback function that can be cancelled (fire-and-forget)
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param token Cancellation token; the task is skipped if it is cancelled before it starts
+   * @param f Function to execute (may take the token first; its return value is discarded)
+   * @param args Function arguments
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  void Post(CancellationToken token, F&& f, Args&&... args);
+
+  /**
+   * @brief Enqueue generic callback function, returning a pool-native Future
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future whose Then() continuations are scheduled back onto this pool
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Unlike Enqueue, follow-up work can be chained without blocking a thread in get(); the
+   * result and its continuation share one allocation. Continuations bypass max_queue_size.
+   */
+  template<typename F, typename... Args>
+  auto EnqueueFuture(F&& f, Args&&... args)
+      -> Future<typename std::invoke_result<F, Args...>::type>;
+
+  /**
+   * @brief Get the token of a cancellation group
+   * @param tag Group identifier chosen by the caller (e.g. a client or request id)
+   * @return Token shared by every task submitted with this tag until CancelTag(tag)
+   *
+   * Submit a group's tasks with Enqueue(GetTagToken(tag), ...) to cancel them together. Once a
+   * tag is cancelled, the next GetTagToken(tag) starts a fresh group. Groups with no live
+   * token are forgotten, so tags cost nothing once their tasks are gone.
+   */
+  CancellationToken GetTagToken(uint64_t tag);
+
+  /**
+   * @brief Cancel every task holding the tag's current token (O(1), no queue scan)
+   * @param tag Group identifier
+   * @return true if the group had live tokens
+   */
+  bool CancelTag(uint64_t tag);
+
+  /**
+   * @brief Enqueue generic callback function unless the queue is full
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future for retrieving execution result, or std::nullopt if
+   *         CallbackWorkerThreadOptions::max_queue_size tasks are already queued
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Never blocks or drops tasks, whatever the overflow policy.
+   */
+  template<typename F, typename... Args>
+  auto TryEnqueue(F&& f, Args&&... args)
+      -> std::optional<std::future<typename std::invoke_result<F, Args...>::type>>;
+
+  /**
+   * @brief Enqueue generic callback function, waiting at most timeout for a free slot
+   * @param timeout Maximum time to wait while the queue is full
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future for retrieving execution result, or std::nullopt on timeout
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename Rep, typename Period, typename F, typename... Args>
+  auto TryEnqueueFor(const std::chrono::duration<Rep, Period>& timeout, F&& f, Args&&... args)
+      -> std::optional<std::future<typename std::invoke_result<F, Args...>::type>>;
+
+  /**
+   * @brief Post generic callback function unless the queue is full (fire-and-forget)
+   * @param f Function to execute (its return value is discarded)
+   * @param args Function arguments
+   * @return false if the queue was full and nothing was posted
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  bool TryPost(F&& f, Args&&... args);
+
+  /**
+   * @brief Post generic callback function, waiting at most timeout for a free slot
+   * @param timeout Maximum time to wait while the queue is full
+   * @param f Function to execute (its return value is discarded)
+   * @param args Function arguments
+   * @return false on timeout (nothing was posted)
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename Rep, typename Period, typename F, typename... Args>
+  bool TryPostFor(const std::chrono::duration<Rep, Period>& timeout, F&& f, Args&&... args);
+
+  /**
+   * @brief Enqueue generic callback function to run after a delay
+   * @param delay Time to wait before the task becomes runnable
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future plus a handle that cancels the task before it fires
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Timers live in a hierarchical timing wheel with CallbackWorkerThreadOptions::timer_tick
+   * resolution, served by the workers themselves: an idle worker sleeps until the next
+   * deadline, and busy workers check for due timers between batches. A task fires at most one
+   * tick late while a worker is idle, but may wait for a running batch when all are busy. On
+   * firing it joins the queue at normal priority (bypassing max_queue_size). Timers that have
+   * not fired when the pool stops are discarded. WaitIdle() does not wait for timers that
+   * have not fired.
+   */
+  template<typename Rep, typename Period, typename F, typename... Args>
+  auto EnqueueAfter(const std::chrono::duration<Rep, Period>& delay, F&& f, Args&&... args)
+      -> ScheduledTask<typename std::invoke_result<F, Args...>::type>;
+
+  /**
+   * @brief Enqueue generic callback function to run at a point in time
+   * @param when Time at which the task becomes runnable (past times fire on the next tick)
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future plus a handle that cancels the task before it fires
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  auto EnqueueAt(std::chrono::steady_clock::time_point when, F&& f, Args&&... args)
+      -> ScheduledTask<typename std::invoke_result<F, Args...>::type>;
+
+  /**
+   * @brief Run a callback function repeatedly
+   * @param interval Time between runs (greater than 0); the first run is one interval from now
+   * @param f Function to execute (its return value is discarded)
+   * @param args Function arguments (stored and passed by lvalue on every run)
+   * @return Handle that stops further runs
+   * @throws std::invalid_argument if interval is not positive
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Runs never overlap: the next run is armed when the previous one returns, at the next
+   * multiple of interval from the previous deadline (missed runs are skipped, not bunched).
+   * Exceptions go to the exception handler, as for Post().
+   */
+  template<typename Rep, typename Period, typename F, typename... Args>
+  TimerHandle SchedulePeriodic(const std::chrono::duration<Rep, Period>& interval,
+                               F&& f, Args&&... args);
+
+  /**
+   * @brief Set handler for exceptions escaping posted tasks
+   * @param handler Handler called on the worker thread with the exception (empty to ignore)
+   *
+   * Exceptions from Enqueue'd tasks are delivered through their futures and never reach the
+   * handler. Exceptions thrown by the handler itself are ignored. Thread-safe.
+   */
+  void SetExceptionHandler(ExceptionHandler handler);
+
   /**
    * @brief Get number of worker threads
-   * @return Thread count
+   * @return Thread count (for an elastic pool, the current size; workers asked to retire by
+   *         Resize are no longer counted)
    */
   size_t GetThreadCount() const;
 
+  /**
+   * @brief Change the number of worker threads at runtime
+   * @param thread_count New thread count (between CallbackWorkerThreadOptions::min_thread_count
+   *        and max_thread_count)
+   * @throws std::invalid_argument if thread_count is outside the bounds
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Growing starts the new workers before returning. Shrinking asks workers to retire; each
+   * one finishes its current batch first. The elastic policy keeps adjusting the size
+   * afterwards.
+   */
+  void Resize(size_t thread_count);
+
   /**
    * @brief Get number of pending tasks
    * @return Number of tasks in queue
+   *
+   * Lock-free; the value is a snapshot and may be stale by the time it is used.
    */
   size_t GetQueueSize() const;
 
+  /**
+   * @brief Get number of workers currently parked
+   * @return Parked worker count snapshot (always 0 with kYield / kBusySpin)
+   */
+  size_t GetIdleWorkerCount() const;
+
+  /**
+   * @brief Get a snapshot of the pool's metrics
+   * @return Per-worker counters plus merged queue-wait and execution-time histograms
+   *
+   * Workers record into their own cache-line-padded counters; this merges them without
+   * stopping the workers. All counters stay at zero while collection is disabled (see
+   * SetMetricsEnabled) or when the library is built with ENABLE_METRICS=OFF.
+   */
+  MetricsSnapshot GetMetrics() const;
+
+  /**
+   * @brief Turn metrics collection on or off at runtime
+   * @param enabled true to collect (no effect if metrics are compiled out)
+   *
+   * Collected values are kept while collection is off. Tasks submitted while collection was
+   * off contribute no queue-wait sample.
+   */
+  void SetMetricsEnabled(bool enabled);
+
   /**
    * @brief Stop thread pool
    * 
@@ -92,48 +711,866 @@ class CallbackWorkerThread {
 
   /**
    * @brief Wait for all tasks to complete
+   * @throws std::logic_error if called from one of this pool's workers
+   *
+   * Same as WaitIdle(); does not require Stop().
    */
   void WaitForCompletion();
 
+  /**
+   * @brief Block until every submitted task has finished running
+   * @throws std::logic_error if called from one of this pool's workers (it would wait for
+   *         itself)
+   *
+   * Unlike Stop(), the pool keeps accepting work, so this can serve as a barrier between
+   * pipeline stages. Tasks submitted by running tasks are waited for too; tasks submitted by
+   * other threads during the wait may delay the return.
+   */
+  void WaitIdle();
+
+  /**
+   * @brief Block until every submitted task has finished or the timeout elapses
+   * @param timeout Maximum time to wait
+   * @return true if the pool became idle, false on timeout
+   * @throws std::logic_error if called from one of this pool's workers
+   */
+  template<typename Rep, typename Period>
+  bool WaitIdleFor(const std::chrono::duration<Rep, Period>& timeout);
+
+  /**
+   * @brief Get number of submitted tasks that have not finished yet
+   * @return Queued plus running task count snapshot
+   */
+  size_t GetInFlightCount() const;
+
+  /**
+   * @brief Wait for a future, running this pool's queued tasks on the calling thread meanwhile
+   * @param future Future to wait for (result of Enqueue or EnqueueFuture on any pool)
+   * @throws std::future_error (no_state) if the future is not valid
+   *
+   * Unlike future.wait(), this is safe from a worker of this pool: a task that enqueues work
+   * and waits for it runs that work itself instead of deadlocking a pool whose workers are
+   * all waiting. From other threads it lends the caller to the pool instead of idling it.
+   * Helped tasks run to completion before the wait re-checks the future, so the return may
+   * be delayed by up to one task. Tasks a worker has already taken in a dequeue batch are not
+   * visible to helpers.
+   */
+  template<typename R>
+  void WaitHelping(const std::future<R>& future);
+
+  /// @copydoc WaitHelping(const std::future<R>&)
+  template<typename R>
+  void WaitHelping(const std::shared_future<R>& future);
+
+  /// @copydoc WaitHelping(const std::future<R>&)
+  template<typename R>
+  void WaitHelping(const Future<R>& future);
+
+  /**
+   * @brief WaitHelping with a timeout
+   * @param future Future to wait for
+   * @param timeout Maximum time to wait
+   * @return true if the future is ready, false on timeout
+   * @throws std::future_error (no_state) if the future is not valid
+   *
+   * A helped task is not interrupted, so the return may come up to one task after the timeout.
+   */
+  template<typename R, typename Rep, typename Period>
+  bool WaitHelpingFor(const std::future<R>& future,
+                      const std::chrono::duration<Rep, Period>& timeout);
+
+  /**
+   * @brief Run a callable on the pool and return its result (synchronous submission)
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return f's return value
+   * @throws The exception f threw, or std::runtime_error if the thread pool is stopped
+   *
+   * Called from a worker of this pool, f runs inline (caller-runs): queueing it would only
+   * add latency, and the worker would have to wait for it anyway. Otherwise f is enqueued and
+   * the caller helps with queued tasks until it is done (see WaitHelping).
+   */
+  template<typename F, typename... Args>
+  auto Invoke(F&& f, Args&&... args) -> typename std::invoke_result<F, Args...>::type;
+
  private:
+  friend class TimerHandle;
+  friend class Strand;
+  friend class ScheduleAwaiter;
+  friend class TaskGraph;
+  friend struct detail::GraphRun;
+  friend struct detail::ParallelJob;
+  friend std::shared_ptr<detail::PoolAnchor> detail::AnchorOf(CallbackWorkerThread& pool);
+  friend void detail::ScheduleContinuation(const std::shared_ptr<detail::PoolAnchor>& anchor,
+                                           Task&& task);
+
+  /// Per-worker state (defined in the source file)
+  struct WorkerContext;
+
+  /// Shared queue of one NUMA node (there is a single one unless numa_local_queues is set)
+  struct alignas(kCacheLineSize) SharedQueue {
+    // QueueType::kLocked storage, one FIFO per priority level (guarded by queue_mutex_)
+    std::deque<Task> tasks[kTaskPriorityLevels];
+    // QueueType::kLockFree storage; rings are created on first use
+    std::atomic<MpmcQueue<Task>*> rings[kTaskPriorityLevels];
+    // Tasks admitted with AdmitMode::kForce while drops are possible (see pin_forced_), in both
+    // queue modes; DropOldestTask never looks here (guarded by queue_mutex_)
+    std::deque<Task> pinned[kTaskPriorityLevels];
+  };
+
+  /// How a push behaves when the bounded queue is full
+  enum class AdmitMode {
+    kPolicy,    ///< Apply CallbackWorkerThreadOptions::overflow_policy
+    kTry,       ///< Fail immediately
+    kDeadline,  ///< Wait for a free slot until the deadline, then fail
+    kForce,     ///< Admit over the limit and never drop (timers, continuations, strands)
+  };
+
+  using Deadline = std::chrono::steady_clock::time_point;
+
   /**
    * @brief Main worker thread processing
+   * @param context State of the worker running this loop
+   */
+  void WorkerThreadMain(WorkerContext* context);
+
+  /**
+   * @brief Report an exception that escaped a task to the exception handler
+   * @param exception Exception thrown by the task
+   */
+  void HandleTaskException(std::exception_ptr exception);
+
+  /**
+   * @brief Push a task and wake a worker if one is parked
+   * @param task Task to push
+   * @param priority Priority level
+   * @param mode Behaviour when the bounded queue is full
+   * @param deadline Deadline for AdmitMode::kDeadline
+   * @return false if the queue was full and mode gave up (the task is left untouched)
+   * @throws std::runtime_error if the thread pool is stopped
+   * @throws QueueFullError if the queue is full under OverflowPolicy::kReject
+   *
+   * In work-stealing mode a task pushed from one of this pool's workers goes to that worker's
+   * own deque; everything else goes to the shared queue.
    */
-  void WorkerThreadMain();
+  bool PushTask(Task&& task, TaskPriority priority = TaskPriority::kNormal,
+                AdmitMode mode = AdmitMode::kPolicy, Deadline deadline = Deadline());
 
-  std::vector<std::thread> workers_;
-  std::queue<std::function<void()>> tasks_;
+  /**
+   * @brief Push several tasks under one lock acquisition and one wakeup pass
+   * @param tasks Tasks to push (moved from)
+   * @param count Number of tasks
+   * @param priority Priority level of every task
+   * @param mode Behaviour when the bounded queue is full
+   * @param deadline Deadline for AdmitMode::kDeadline
+   * @return false if the queue was full and mode gave up (no task is pushed)
+   * @throws std::runtime_error if the thread pool is stopped (no task is pushed)
+   * @throws QueueFullError if the queue is full under OverflowPolicy::kReject
+   * @throws std::invalid_argument if priority is not a TaskPriority value
+   */
+  bool PushTasks(Task* tasks, size_t count, TaskPriority priority = TaskPriority::kNormal,
+                 AdmitMode mode = AdmitMode::kPolicy, Deadline deadline = Deadline());
+
+  /**
+   * @brief Get the lock-free ring of a priority level
+   * @param queue Shared queue owning the ring
+   * @param level Priority level index
+   * @param create Create the ring if it does not exist yet
+   * @return Ring, or nullptr if it does not exist and create is false
+   */
+  MpmcQueue<Task>* LockFreeLevel(SharedQueue& queue, size_t level, bool create);
+
+  /**
+   * @brief Pick the shared queue a submission goes to
+   * @param current Calling worker of this pool, or nullptr
+   * @return Index into shared_queues_ (the submitting thread's NUMA node)
+   */
+  size_t SubmitQueueIndex(const WorkerContext* current) const;
+
+  /**
+   * @brief Count tasks about to be pushed, applying the queue limit
+   * @param count Number of tasks
+   * @param mode Behaviour when the bounded queue is full
+   * @param deadline Deadline for AdmitMode::kDeadline
+   * @return false if the queue was full and mode gave up (nothing is counted)
+   * @throws std::runtime_error if the thread pool is stopped
+   * @throws QueueFullError if the queue is full under OverflowPolicy::kReject
+   */
+  bool ReserveQueueSlots(size_t count, AdmitMode mode, Deadline deadline);
+
+  /**
+   * @brief Uncount popped or dropped tasks and wake producers waiting for space
+   * @param count Number of tasks
+   */
+  void ReleaseQueueSlots(size_t count);
+
+  /**
+   * @brief Block until count more tasks fit in the bounded queue, the pool stops, or the
+   *        deadline passes
+   * @param count Number of tasks to fit
+   * @param mode kDeadline to honour deadline, anything else to wait indefinitely
+   * @param deadline Deadline for AdmitMode::kDeadline
+   * @return false on timeout
+   */
+  bool WaitForQueueSpace(size_t count, AdmitMode mode, Deadline deadline);
+
+  /**
+   * @brief Drop the oldest task of the lowest non-empty priority level (kDropOldest)
+   * @return false if no task could be taken from the shared queue
+   */
+  bool DropOldestTask();
+
+  /**
+   * @brief Uncount finished (or discarded) tasks and wake WaitIdle callers at zero
+   * @param count Number of tasks
+   */
+  void FinishTasks(size_t count);
+
+  /**
+   * @brief Wait until no task is in flight
+   * @param deadline Give up at this time; nullptr waits indefinitely
+   * @return false on timeout
+   * @throws std::logic_error if called from one of this pool's workers
+   */
+  bool WaitIdleUntil(const Deadline* deadline);
+
+  /// Polls (timeout 0) or waits for a type-erased future; returns true once it is ready
+  using ReadyWait = bool (*)(const void* future, std::chrono::microseconds timeout);
+
+  /**
+   * @brief Run queued tasks on the calling thread until a future is ready
+   * @param wait Readiness check of the future
+   * @param future Future passed to wait
+   * @param deadline Give up at this time; nullptr waits indefinitely
+   * @return false on timeout
+   */
+  bool HelpUntilReady(ReadyWait wait, const void* future, const Deadline* deadline = nullptr);
+
+  /**
+   * @brief Take one queued task and run it on the calling thread
+   * @return false if no task was available
+   */
+  bool TryRunQueuedTask();
+
+  /// @return true if the calling thread is one of this pool's workers
+  bool IsWorkerThread() const;
+
+  /**
+   * @brief Wake up to count parked workers
+   * @param count Number of newly available tasks
+   */
+  void WakeWorkers(size_t count);
+
+  /**
+   * @brief Pop up to max_count tasks from the shared queues without blocking
+   * @param tasks Destination array (at least max_count elements)
+   * @param max_count Maximum number of tasks to pop
+   * @param home Index of the shared queue to serve first at each priority level
+   * @return Number of tasks popped
+   *
+   * In QueueType::kLocked mode all tasks are taken under a single lock acquisition.
+   */
+  size_t TryPopSharedTasks(Task* tasks, size_t max_count, size_t home);
+
+  /**
+   * @brief Get up to max_count tasks for a worker without blocking
+   * @param context Calling worker's state
+   * @param tasks Destination array (at least max_count elements)
+   * @param max_count Maximum number of tasks to take
+   * @return Number of tasks taken
+   *
+   * In work-stealing mode, looks at the worker's own deque, then the shared queue, then steals
+   * from other workers (one task at a time except from the shared queue).
+   */
+  size_t TryGetTasks(WorkerContext* context, Task* tasks, size_t max_count);
+
+  /**
+   * @brief Wait according to the wait strategy until a task may be available or the pool stops
+   * @param timed_out Set to true if the worker parked for the whole keep-alive interval
+   *        (elastic pools only)
+   * @return false if the worker should exit (stopped and no tasks remain)
+   */
+  bool WaitForTask(bool* timed_out);
+
+  /**
+   * @brief Start a worker thread in a free slot (resize_mutex_ must be held)
+   * @return false if every slot is still occupied by a running or retiring thread
+   */
+  bool StartWorker();
+
+  /**
+   * @brief Start a worker if the pool is below its maximum size (elastic pools)
+   *
+   * Never blocks: gives up if another thread is resizing the pool.
+   */
+  void MaybeGrow();
+
+  /**
+   * @brief Decide whether the calling worker should retire
+   * @param idle_timeout true if the worker has just been idle for the keep-alive interval
+   * @return true if the worker must exit (it is no longer counted in GetThreadCount)
+   */
+  bool ShouldRetire(bool idle_timeout);
+
+  /**
+   * @brief Arm a timer running task at deadline_ns (and every interval_ns after, if not 0)
+   * @param task Task to run
+   * @param deadline_ns steady_clock time in nanoseconds
+   * @param interval_ns Period of a periodic task, 0 for a one-shot task
+   * @return Handle to the timer
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  TimerHandle ScheduleTimer(Task&& task, uint64_t deadline_ns, uint64_t interval_ns);
+
+  /**
+   * @brief Link a timer into the wheel (timer_mutex_ must be held)
+   * @param entry Unlinked timer
+   * @param deadline_ns steady_clock time in nanoseconds
+   * @return true if the wheel now needs attention earlier than before
+   */
+  bool ArmTimer(detail::TimerEntry& entry, uint64_t deadline_ns);
+
+  /**
+   * @brief Recompute next_timer_ns_ from the wheel (timer_mutex_ must be held)
+   * @return true if it moved earlier
+   */
+  bool UpdateNextTimer();
+
+  /// Wake parked workers so that the timer leader re-reads next_timer_ns_
+  void WakeTimerLeader();
+
+  /// @return true if the timer wheel needs attention now (cheap when no timer is armed)
+  bool TimerDue() const;
+
+  /// Fire due timers into the queue (returns at once if another worker is doing it)
+  void PollTimers();
+
+  /**
+   * @brief Run one instance of a periodic task and re-arm it
+   * @param entry Periodic timer
+   */
+  void RunPeriodic(const std::shared_ptr<detail::TimerEntry>& entry);
+
+  /**
+   * @brief Cancel a timer (see TimerHandle::Cancel)
+   * @param entry Timer to cancel
+   * @return true if a run was prevented
+   */
+  bool CancelTimer(const std::shared_ptr<detail::TimerEntry>& entry);
+
+  /**
+   * @brief Check whether a timer may still run (see TimerHandle::IsActive)
+   * @param entry Timer to check
+   */
+  bool TimerActive(const std::shared_ptr<detail::TimerEntry>& entry);
+
+  /// Destroy every armed timer (on Stop and destruction)
+  void DiscardTimers();
+
+  /**
+   * @brief Run a task, routing escaping exceptions to the exception handler
+   * @param task Task to run
+   * @return false if an exception escaped the task
+   */
+  bool RunTask(Task& task);
+
+  /**
+   * @brief Run a batch of tasks while recording queue-wait and execution metrics
+   * @param context Calling worker's state
+   * @param batch Tasks to run (reset after running)
+   * @param count Number of tasks
+   */
+  void RunBatchMeasured(WorkerContext* context, Task* batch, size_t count);
+
+  /// Worker running on the current thread (nullptr on non-worker threads)
+  static thread_local WorkerContext* current_worker_;
+
+  const QueueType queue_type_;
+  const bool work_stealing_;
+  const size_t max_dequeue_batch_;
+  const bool adaptive_dequeue_batch_;
+  const WaitStrategy wait_strategy_;
+  const size_t spin_iterations_;
+  const size_t yield_iterations_;
+
+  // Elastic pool settings (elastic_ is false when min and max thread counts are equal)
+  const size_t min_threads_;
+  const size_t max_threads_;
+  const bool elastic_;
+  const std::chrono::milliseconds keep_alive_;
+  const size_t grow_queue_depth_;
+  const uint64_t grow_wait_threshold_ns_;
+
+  // One slot per possible worker (max_threads_), allocated up front so that thieves and
+  // GetMetrics can iterate worker_contexts_ while threads come and go
+  std::vector<std::thread> workers_;  // guarded by resize_mutex_
+  std::vector<std::unique_ptr<WorkerContext>> worker_contexts_;
+  // Serializes starting and joining worker threads
+  std::mutex resize_mutex_;
+  // Workers counted in GetThreadCount
+  std::atomic<size_t> active_workers_;
+  // Workers Resize asked to retire that have not exited yet
+  std::atomic<size_t> retire_requests_;
+
+  // CPUs of options.cpu_set grouped by NUMA node; decides worker placement and, with
+  // numa_local_queues, which shared queue a submission goes to
+  const CpuTopology topology_;
+  const WorkerPlacement placement_;
+  const bool numa_local_queues_;
+  // One per node with numa_local_queues, otherwise one in total
+  const size_t shared_queue_count_;
+  std::unique_ptr<SharedQueue[]> shared_queues_;
+  const size_t lock_free_queue_size_;
+  // Dequeue counter driving starvation protection (only used when starvation_limit_ > 0)
+  const size_t starvation_limit_;
+  std::atomic<size_t> dequeue_counter_;
+
+  // Queue limit (0 = unbounded)
+  const size_t max_queue_size_;
+  const OverflowPolicy overflow_policy_;
+  const std::function<void()> drop_handler_;
+  // Set when OverflowPolicy::kDropOldest can drop tasks; forced tasks then go to the pinned
+  // queues, since dropping a strand's drain task or a coroutine resumption loses work for good
+  const bool pin_forced_;
+
+  // Also used to park idle workers in both queue modes
   mutable std::mutex queue_mutex_;
   std::condition_variable condition_;
-  bool stop_;
+  // Producers blocked on a full bounded queue wait here (with queue_mutex_)
+  std::condition_variable space_condition_;
+  // WaitIdle callers wait here (with queue_mutex_)
+  std::condition_variable idle_condition_;
+
+  // Number of submitted tasks that have not been popped yet. Producers increment it before the
+  // task becomes visible, so workers never exit or park while a push is still in progress.
+  alignas(kCacheLineSize) std::atomic<size_t> queued_count_;
+  // Number of workers parked on condition_; producers skip the wakeup when it is 0
+  alignas(kCacheLineSize) std::atomic<size_t> sleeping_workers_;
+  // Number of producers waiting on space_condition_; consumers skip the wakeup when it is 0
+  std::atomic<size_t> waiting_producers_;
+  // Number of tasks in the pinned queues; consumers skip their lock when it is 0
+  std::atomic<size_t> pinned_count_;
+  // Number of submitted tasks that have not finished running (queued_count_ plus running ones)
+  alignas(kCacheLineSize) std::atomic<size_t> in_flight_count_;
+  // Number of threads waiting on idle_condition_
+  std::atomic<size_t> idle_waiters_;
+  std::atomic<bool> stop_;
+  // Runtime metrics switch (see SetMetricsEnabled)
+  std::atomic<bool> metrics_enabled_;
+
+  // Delayed and periodic tasks; the wheel is guarded by timer_mutex_
+  std::mutex timer_mutex_;
+  const uint64_t timer_tick_ns_;
+  TimerWheel timer_wheel_;
+  // steady_clock time (ns) at which the wheel next needs attention, UINT64_MAX when it is
+  // empty; workers read it without the lock to decide whether to poll
+  std::atomic<uint64_t> next_timer_ns_;
+  // Set while a parked worker sleeps until next_timer_ns_ on behalf of the pool
+  std::atomic<bool> timer_leader_;
+
+  // Cancellation groups (see GetTagToken); expired entries are pruned as the map grows
+  std::mutex tag_mutex_;
+  std::unordered_map<uint64_t, std::weak_ptr<detail::CancellationState>> tag_states_;
+  size_t tag_prune_threshold_;
+
+  std::mutex exception_handler_mutex_;
+  ExceptionHandler exception_handler_;
+
+  // Shared with the futures scheduling on this pool; cleared by the destructor
+  const std::shared_ptr<detail::PoolAnchor> anchor_;
 };
 
 // Template function implementation
 template<typename F, typename... Args>
 auto CallbackWorkerThread::Enqueue(F&& f, Args&&... args)
     -> std::future<typename std::invoke_result<F, Args...>::type> {
+  return Enqueue(TaskPriority::kNormal, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<typename F, typename... Args>
+auto CallbackWorkerThread::Enqueue(TaskPriority priority, F&& f, Args&&... args)
+    -> std::future<typename std::invoke_result<F, Args...>::type> {
   using return_type = typename std::invoke_result<F, Args...>::type;
 
-  auto task = std::make_shared<std::packaged_task<return_type()>>(
-      std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+  // The promise, callable and arguments travel inside the Task itself, so a small task costs
+  // only the promise's shared state instead of packaged_task + std::function + shared_ptr.
+  auto promise = detail::MakeTaskPromise<return_type>();
+  std::future<return_type> res = promise.get_future();
 
-  std::future<return_type> res = task->get_future();
-  
-  {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
-    
-    // Throw exception if thread pool is stopped
-    if (stop_) {
-      throw std::runtime_error("Cannot enqueue task: thread pool is stopped");
-    }
+  PushTask([promise = std::move(promise), func = std::forward<F>(f),
+            bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    detail::FulfillPromise(promise, [&]() { return std::apply(func, bound_args); });
+  }, priority);
+  return res;
+}
+
+template<typename InputIt>
+auto CallbackWorkerThread::EnqueueBatch(InputIt first, InputIt last)
+    -> std::vector<std::future<
+        std::invoke_result_t<typename std::iterator_traits<InputIt>::value_type&>>> {
+  using Callable = typename std::iterator_traits<InputIt>::value_type;
+  using return_type = std::invoke_result_t<Callable&>;
 
-    tasks_.emplace([task]() { (*task)(); });
+  std::vector<Task> tasks;
+  std::vector<std::future<return_type>> futures;
+  for (; first != last; ++first) {
+    auto promise = detail::MakeTaskPromise<return_type>();
+    futures.push_back(promise.get_future());
+    tasks.emplace_back([promise = std::move(promise), func = Callable(*first)]() mutable {
+      detail::FulfillPromise(promise, func);
+    });
   }
-  
-  condition_.notify_one();
+
+  PushTasks(tasks.data(), tasks.size());
+  return futures;
+}
+
+template<typename F, typename InputIt>
+auto CallbackWorkerThread::EnqueueBatch(F&& f, InputIt first, InputIt last)
+    -> std::vector<std::future<std::invoke_result_t<
+        std::decay_t<F>&, typename std::iterator_traits<InputIt>::value_type&>>> {
+  using Callable = std::decay_t<F>;
+  using Arg = typename std::iterator_traits<InputIt>::value_type;
+  using return_type = std::invoke_result_t<Callable&, Arg&>;
+
+  std::vector<Task> tasks;
+  std::vector<std::future<return_type>> futures;
+  for (; first != last; ++first) {
+    auto promise = detail::MakeTaskPromise<return_type>();
+    futures.push_back(promise.get_future());
+    tasks.emplace_back([promise = std::move(promise), func = Callable(f),
+                        arg = Arg(*first)]() mutable {
+      detail::FulfillPromise(promise, [&]() { return std::invoke(func, arg); });
+    });
+  }
+
+  PushTasks(tasks.data(), tasks.size());
+  return futures;
+}
+
+template<typename InputIt>
+std::future<void> CallbackWorkerThread::EnqueueBatchAll(InputIt first, InputIt last) {
+  using Callable = typename std::iterator_traits<InputIt>::value_type;
+
+  std::vector<Callable> callables(first, last);
+  auto completion = std::make_shared<detail::BatchCompletion>(callables.size());
+  std::future<void> res = completion->GetFuture();
+  if (callables.empty()) {
+    completion->Complete(nullptr);
+    return res;
+  }
+
+  std::vector<Task> tasks;
+  tasks.reserve(callables.size());
+  for (auto& callable : callables) {
+    tasks.push_back(detail::MakeBatchTask(completion, std::move(callable)));
+  }
+
+  PushTasks(tasks.data(), tasks.size());
   return res;
 }
 
+template<typename F, typename InputIt>
+std::future<void> CallbackWorkerThread::EnqueueBatchAll(F&& f, InputIt first, InputIt last) {
+  using Callable = std::decay_t<F>;
+  using Arg = typename std::iterator_traits<InputIt>::value_type;
+
+  std::vector<Arg> args(first, last);
+  auto completion = std::make_shared<detail::BatchCompletion>(args.size());
+  std::future<void> res = completion->GetFuture();
+  if (args.empty()) {
+    completion->Complete(nullptr);
+    return res;
+  }
+
+  std::vector<Task> tasks;
+  tasks.reserve(args.size());
+  for (auto& arg : args) {
+    tasks.push_back(detail::MakeBatchTask(
+        completion, [func = Callable(f), arg = std::move(arg)]() mutable {
+          std::invoke(func, arg);
+        }));
+  }
+
+  PushTasks(tasks.data(), tasks.size());
+  return res;
+}
+
+template<typename InputIt>
+void CallbackWorkerThread::PostBatch(InputIt first, InputIt last) {
+  using Callable = typename std::iterator_traits<InputIt>::value_type;
+
+  std::vector<Task> tasks;
+  for (; first != last; ++first) {
+    tasks.emplace_back(Callable(*first));
+  }
+
+  PushTasks(tasks.data(), tasks.size());
+}
+
+template<typename F, typename InputIt>
+void CallbackWorkerThread::PostBatch(F&& f, InputIt first, InputIt last) {
+  using Callable = std::decay_t<F>;
+  using Arg = typename std::iterator_traits<InputIt>::value_type;
+
+  std::vector<Task> tasks;
+  for (; first != last; ++first) {
+    tasks.emplace_back([func = Callable(f), arg = Arg(*first)]() mutable {
+      std::invoke(func, arg);
+    });
+  }
+
+  PushTasks(tasks.data(), tasks.size());
+}
+
+template<typename F, typename... Args>
+auto CallbackWorkerThread::TryEnqueue(F&& f, Args&&... args)
+    -> std::optional<std::future<typename std::invoke_result<F, Args...>::type>> {
+  using return_type = typename std::invoke_result<F, Args...>::type;
+
+  auto promise = detail::MakeTaskPromise<return_type>();
+  std::future<return_type> res = promise.get_future();
+  Task task([promise = std::move(promise), func = std::forward<F>(f),
+             bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    detail::FulfillPromise(promise, [&]() { return std::apply(func, bound_args); });
+  });
+  if (!PushTask(std::move(task), TaskPriority::kNormal, AdmitMode::kTry)) {
+    return std::nullopt;
+  }
+  return res;
+}
+
+template<typename Rep, typename Period, typename F, typename... Args>
+auto CallbackWorkerThread::TryEnqueueFor(const std::chrono::duration<Rep, Period>& timeout,
+                                         F&& f, Args&&... args)
+    -> std::optional<std::future<typename std::invoke_result<F, Args...>::type>> {
+  using return_type = typename std::invoke_result<F, Args...>::type;
+
+  const Deadline deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+  auto promise = detail::MakeTaskPromise<return_type>();
+  std::future<return_type> res = promise.get_future();
+  Task task([promise = std::move(promise), func = std::forward<F>(f),
+             bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    detail::FulfillPromise(promise, [&]() { return std::apply(func, bound_args); });
+  });
+  if (!PushTask(std::move(task), TaskPriority::kNormal, AdmitMode::kDeadline, deadline)) {
+    return std::nullopt;
+  }
+  return res;
+}
+
+template<typename F, typename... Args>
+bool CallbackWorkerThread::TryPost(F&& f, Args&&... args) {
+  return PushTask(Task([func = std::forward<F>(f),
+                        bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                    std::apply(func, bound_args);
+                  }),
+                  TaskPriority::kNormal, AdmitMode::kTry);
+}
+
+template<typename Rep, typename Period, typename F, typename... Args>
+bool CallbackWorkerThread::TryPostFor(const std::chrono::duration<Rep, Period>& timeout,
+                                      F&& f, Args&&... args) {
+  const Deadline deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+  return PushTask(Task([func = std::forward<F>(f),
+                        bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                    std::apply(func, bound_args);
+                  }),
+                  TaskPriority::kNormal, AdmitMode::kDeadline, deadline);
+}
+
+template<typename Rep, typename Period, typename F, typename... Args>
+auto CallbackWorkerThread::EnqueueAfter(const std::chrono::duration<Rep, Period>& delay,
+                                        F&& f, Args&&... args)
+    -> ScheduledTask<typename std::invoke_result<F, Args...>::type> {
+  return EnqueueAt(std::chrono::steady_clock::now() +
+                       std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay),
+                   std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<typename F, typename... Args>
+auto CallbackWorkerThread::EnqueueAt(std::chrono::steady_clock::time_point when,
+                                     F&& f, Args&&... args)
+    -> ScheduledTask<typename std::invoke_result<F, Args...>::type> {
+  using return_type = typename std::invoke_result<F, Args...>::type;
+
+  const auto since_epoch =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count();
+  auto promise = detail::MakeTaskPromise<return_type>();
+  ScheduledTask<return_type> scheduled;
+  scheduled.future = promise.get_future();
+  scheduled.timer = ScheduleTimer(
+      Task([promise = std::move(promise), func = std::forward<F>(f),
+            bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        detail::FulfillPromise(promise, [&]() { return std::apply(func, bound_args); });
+      }),
+      since_epoch > 0 ? static_cast<uint64_t>(since_epoch) : 0, 0);
+  return scheduled;
+}
+
+template<typename Rep, typename Period, typename F, typename... Args>
+TimerHandle CallbackWorkerThread::SchedulePeriodic(
+    const std::chrono::duration<Rep, Period>& interval, F&& f, Args&&... args) {
+  const auto interval_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+  if (interval_ns <= 0) {
+    throw std::invalid_argument("Periodic interval must be greater than 0");
+  }
+
+  const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count();
+  return ScheduleTimer(
+      Task([func = std::forward<F>(f),
+            bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        std::apply(func, bound_args);
+      }),
+      static_cast<uint64_t>(now + interval_ns), static_cast<uint64_t>(interval_ns));
+}
+
+template<typename Rep, typename Period>
+bool CallbackWorkerThread::WaitIdleFor(const std::chrono::duration<Rep, Period>& timeout) {
+  const Deadline deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+  return WaitIdleUntil(&deadline);
+}
+
+template<typename R>
+void CallbackWorkerThread::WaitHelping(const std::future<R>& future) {
+  if (!future.valid()) {
+    throw std::future_error(std::future_errc::no_state);
+  }
+  HelpUntilReady([](const void* waited, std::chrono::microseconds timeout) {
+    return static_cast<const std::future<R>*>(waited)->wait_for(timeout) ==
+           std::future_status::ready;
+  }, &future);
+}
+
+template<typename R>
+void CallbackWorkerThread::WaitHelping(const std::shared_future<R>& future) {
+  if (!future.valid()) {
+    throw std::future_error(std::future_errc::no_state);
+  }
+  HelpUntilReady([](const void* waited, std::chrono::microseconds timeout) {
+    return static_cast<const std::shared_future<R>*>(waited)->wait_for(timeout) ==
+           std::future_status::ready;
+  }, &future);
+}
+
+template<typename R>
+void CallbackWorkerThread::WaitHelping(const Future<R>& future) {
+  if (!future.Valid()) {
+    throw std::future_error(std::future_errc::no_state);
+  }
+  HelpUntilReady([](const void* waited, std::chrono::microseconds timeout) {
+    return static_cast<const Future<R>*>(waited)->WaitFor(timeout);
+  }, &future);
+}
+
+template<typename R, typename Rep, typename Period>
+bool CallbackWorkerThread::WaitHelpingFor(const std::future<R>& future,
+                                          const std::chrono::duration<Rep, Period>& timeout) {
+  if (!future.valid()) {
+    throw std::future_error(std::future_errc::no_state);
+  }
+  const Deadline deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+  return HelpUntilReady([](const void* waited, std::chrono::microseconds slice) {
+    return static_cast<const std::future<R>*>(waited)->wait_for(slice) ==
+           std::future_status::ready;
+  }, &future, &deadline);
+}
+
+template<typename F, typename... Args>
+auto CallbackWorkerThread::Invoke(F&& f, Args&&... args)
+    -> typename std::invoke_result<F, Args...>::type {
+  if (IsWorkerThread()) {
+    return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+  }
+  auto future = Enqueue(std::forward<F>(f), std::forward<Args>(args)...);
+  WaitHelping(future);
+  return future.get();
+}
+
+template<typename F, typename... Args>
+auto CallbackWorkerThread::Enqueue(CancellationToken token, F&& f, Args&&... args)
+    -> std::future<typename detail::CancellableResult<F, Args...>::type> {
+  using return_type = typename detail::CancellableResult<F, Args...>::type;
+
+  auto promise = detail::MakeTaskPromise<return_type>();
+  std::future<return_type> res = promise.get_future();
+
+  PushTask([token = std::move(token), promise = std::move(promise), func = std::forward<F>(f),
+            bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    // Skipped: the promise is destroyed with the task, reporting broken_promise
+    if (token.IsCancellationRequested()) {
+      return;
+    }
+    detail::FulfillPromise(promise,
+                           [&]() { return detail::ApplyWithToken(func, token, bound_args); });
+  }, TaskPriority::kNormal);
+  return res;
+}
+
+template<typename F, typename... Args>
+auto CallbackWorkerThread::EnqueueFuture(F&& f, Args&&... args)
+    -> Future<typename std::invoke_result<F, Args...>::type> {
+  using return_type = typename std::invoke_result<F, Args...>::type;
+
+  Promise<return_type> promise(this);
+  Future<return_type> res = promise.GetFuture();
+
+  PushTask([promise = std::move(promise), func = std::forward<F>(f),
+            bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    detail::FulfillPromise(promise, [&]() { return std::apply(func, bound_args); });
+  }, TaskPriority::kNormal);
+  return res;
+}
+
+template<typename F, typename... Args>
+auto CallbackWorkerThread::EnqueueCancellable(F&& f, Args&&... args)
+    -> CancellableTask<typename detail::CancellableResult<F, Args...>::type> {
+  CancellableTask<typename detail::CancellableResult<F, Args...>::type> task;
+  task.future = Enqueue(task.cancellation.GetToken(), std::forward<F>(f),
+                        std::forward<Args>(args)...);
+  return task;
+}
+
+template<typename F, typename... Args>
+void CallbackWorkerThread::Post(CancellationToken token, F&& f, Args&&... args) {
+  PushTask([token = std::move(token), func = std::forward<F>(f),
+            bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    if (!token.IsCancellationRequested()) {
+      detail::ApplyWithToken(func, token, bound_args);
+    }
+  }, TaskPriority::kNormal);
+}
+
+template<typename F, typename... Args>
+void CallbackWorkerThread::Post(F&& f, Args&&... args) {
+  Post(TaskPriority::kNormal, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<typename F, typename... Args>
+void CallbackWorkerThread::Post(TaskPriority priority, F&& f, Args&&... args) {
+  if constexpr (sizeof...(Args) == 0) {
+    PushTask(Task(std::forward<F>(f)), priority);
+  } else {
+    PushTask([func = std::forward<F>(f),
+              bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+      std::apply(func, bound_args);
+    }, priority);
+  }
+}
+
 }  // namespace callback_worker_thread
 
 #endif  // CALLBACK_WORKER_THREAD_CALLBACK_WORKER_THREAD_H_ 
\ No newline at end of file
@@ -18,6 +18,15 @@ extern "C" {
 /// Opaque pointer type
 typedef struct CallbackWorkerThreadC CallbackWorkerThreadC;
 
+/// Opaque completion handle for an asynchronously enqueued task
+typedef struct CallbackWorkerTaskHandle CallbackWorkerTaskHandle;
+
+/// Opaque handle to a delayed or periodic callback
+typedef struct CallbackWorkerTimer CallbackWorkerTimer;
+
+/// Opaque cancellation source shared by a group of callbacks
+typedef struct CallbackWorkerCancelSource CallbackWorkerCancelSource;
+
 /// Return status codes
 typedef enum {
     CALLBACK_WORKER_SUCCESS = 0,           ///< Success
@@ -25,9 +34,28 @@ typedef enum {
     CALLBACK_WORKER_ERROR_NULL_POINTER,    ///< NULL pointer error
     CALLBACK_WORKER_ERROR_THREAD_STOPPED,  ///< Thread pool is stopped
     CALLBACK_WORKER_ERROR_MEMORY,          ///< Out of memory
-    CALLBACK_WORKER_ERROR_UNKNOWN          ///< Unknown error
+    CALLBACK_WORKER_ERROR_UNKNOWN,         ///< Unknown error
+    CALLBACK_WORKER_ERROR_TIMEOUT,         ///< Wait timed out before the task completed
+    CALLBACK_WORKER_ERROR_QUEUE_FULL,      ///< Bounded queue is full (task not enqueued)
+    CALLBACK_WORKER_ERROR_DROPPED,         ///< Task was discarded unrun (DROP_OLDEST policy)
+    CALLBACK_WORKER_ERROR_CANCELLED        ///< Task was skipped unrun because it was cancelled
 } CallbackWorkerResult;
 
+/// Behaviour of a bounded worker when its queue is full
+typedef enum {
+    CALLBACK_WORKER_OVERFLOW_BLOCK = 0,   ///< Block the caller until a slot frees up
+    CALLBACK_WORKER_OVERFLOW_REJECT,      ///< Fail with CALLBACK_WORKER_ERROR_QUEUE_FULL
+    CALLBACK_WORKER_OVERFLOW_DROP_OLDEST, ///< Discard the oldest queued task to make room
+    CALLBACK_WORKER_OVERFLOW_CALLER_RUNS  ///< Run the task on the calling thread
+} CallbackWorkerOverflowPolicy;
+
+/// Task priority (mirrors callback_worker_thread::TaskPriority)
+typedef enum {
+    CALLBACK_WORKER_PRIORITY_HIGH = 0,  ///< Run before normal and low priority tasks
+    CALLBACK_WORKER_PRIORITY_NORMAL,    ///< Default priority
+    CALLBACK_WORKER_PRIORITY_LOW        ///< Run when no higher priority task is queued
+} CallbackWorkerPriority;
+
 /// Default callback function type definition (int, double, const char*)
 typedef void (*DefaultCallbackFunc)(int arg1, double arg2, const char* arg3);
 
@@ -43,6 +71,52 @@ typedef int (*IntReturnCallbackFunc)(int arg1, int arg2);
 /// Single string argument callback function type definition
 typedef void (*StringCallbackFunc)(const char* arg);
 
+/// User data callback function type definition
+typedef void (*UserDataCallbackFunc)(void* user_data);
+
+/// Releases a buffer handed over to the worker (e.g. free)
+typedef void (*BufferFreeFunc)(void* buffer);
+
+/// Batch item: callback and the argument passed to it
+typedef struct {
+    UserDataCallbackFunc callback;  ///< Callback function
+    void* user_data;                ///< Argument passed to the callback (not owned)
+} CallbackWorkerBatchItem;
+
+/// Metrics snapshot (see callback_worker_get_metrics); times are in nanoseconds
+typedef struct {
+    int enabled;                     ///< 1 if collection is enabled
+    size_t thread_count;             ///< Number of worker threads
+    size_t queue_size;               ///< Tasks queued at the time of the snapshot
+    uint64_t tasks_executed;         ///< Tasks run, summed over workers
+    uint64_t exceptions;             ///< Exceptions escaping fire-and-forget tasks
+    uint64_t busy_ns;                ///< Time spent running tasks, summed over workers
+    uint64_t idle_ns;                ///< Time spent waiting for tasks, summed over workers
+    uint64_t queue_wait_p50_ns;      ///< Median time from submission to start
+    uint64_t queue_wait_p99_ns;      ///< 99th percentile time from submission to start
+    uint64_t queue_wait_max_ns;      ///< Longest time from submission to start
+    uint64_t execution_p50_ns;       ///< Median execution time
+    uint64_t execution_p99_ns;       ///< 99th percentile execution time
+    uint64_t execution_max_ns;       ///< Longest execution time
+} CallbackWorkerMetrics;
+
+/// Counters of one worker slot (see callback_worker_get_worker_metrics); times in nanoseconds
+typedef struct {
+    uint64_t tasks_executed;  ///< Tasks run by this worker
+    uint64_t exceptions;      ///< Exceptions escaping fire-and-forget tasks run by this worker
+    uint64_t busy_ns;         ///< Time this worker spent running tasks
+    uint64_t idle_ns;         ///< Time this worker spent waiting for tasks
+} CallbackWorkerWorkerMetrics;
+
+/// Task allocator counters (see callback_worker_get_allocator_stats)
+typedef struct {
+    uint64_t slab_allocations;     ///< Slabs obtained from the system allocator since start
+    uint64_t large_allocations;    ///< Oversized blocks served by operator new since start
+    uint64_t remote_free_batches;  ///< Remote-free lists taken back by their owning thread
+    size_t reserved_bytes;         ///< Bytes currently held in slabs
+    size_t thread_caches;          ///< Per-thread caches alive
+} CallbackWorkerAllocatorStats;
+
 /**
  * @brief Create CallbackWorkerThread instance
  * @param thread_count Number of worker threads (1 or more)
@@ -51,6 +125,46 @@ typedef void (*StringCallbackFunc)(const char* arg);
  */
 CallbackWorkerResult callback_worker_create(size_t thread_count, CallbackWorkerThreadC** worker);
 
+/**
+ * @brief Create CallbackWorkerThread instance with a bounded queue
+ * @param thread_count Number of worker threads (1 or more)
+ * @param max_queue_size Maximum number of queued tasks (1 or more)
+ * @param policy What enqueue functions do when the queue is full
+ * @param drop_callback Called once per dropped task with CALLBACK_WORKER_OVERFLOW_DROP_OLDEST,
+ *                      or NULL
+ * @param drop_user_data Argument passed to drop_callback (not owned)
+ * @param worker Address of variable to store the created instance pointer
+ * @return CallbackWorkerResult Status code
+ *
+ * With CALLBACK_WORKER_OVERFLOW_REJECT, enqueue functions return
+ * CALLBACK_WORKER_ERROR_QUEUE_FULL when the queue is full. With
+ * CALLBACK_WORKER_OVERFLOW_DROP_OLDEST, a dropped task's completion handle completes with
+ * CALLBACK_WORKER_ERROR_DROPPED, and so does a synchronous enqueue function whose task was
+ * dropped.
+ */
+CallbackWorkerResult callback_worker_create_bounded(size_t thread_count,
+                                                    size_t max_queue_size,
+                                                    CallbackWorkerOverflowPolicy policy,
+                                                    UserDataCallbackFunc drop_callback,
+                                                    void* drop_user_data,
+                                                    CallbackWorkerThreadC** worker);
+
+/**
+ * @brief Create an elastic CallbackWorkerThread instance
+ * @param min_threads Minimum (and initial) number of worker threads (1 or more)
+ * @param max_threads Maximum number of worker threads (min_threads or more)
+ * @param keep_alive_ms Idle time after which a worker above min_threads retires
+ * @param worker Address of variable to store the created instance pointer
+ * @return CallbackWorkerResult Status code
+ *
+ * The pool starts a worker whenever tasks are queued while every worker is busy, up to
+ * max_threads. Use callback_worker_resize to change the size explicitly.
+ */
+CallbackWorkerResult callback_worker_create_elastic(size_t min_threads,
+                                                    size_t max_threads,
+                                                    uint32_t keep_alive_ms,
+                                                    CallbackWorkerThreadC** worker);
+
 /**
  * @brief Destroy CallbackWorkerThread instance
  * @param worker Instance to destroy
@@ -66,6 +180,10 @@ CallbackWorkerResult callback_worker_destroy(CallbackWorkerThreadC* worker);
  * @param arg2 Second argument
  * @param arg3 Third argument
  * @return CallbackWorkerResult Status code
+ *
+ * Waits for the callback to finish, as do the other enqueue functions below that are not
+ * marked "without waiting". The calling thread runs other queued callbacks while it waits, so
+ * these functions may also be called from inside a callback, even on a one-thread worker.
  */
 CallbackWorkerResult callback_worker_enqueue_default(CallbackWorkerThreadC* worker,
                                                       DefaultCallbackFunc callback,
@@ -119,6 +237,332 @@ CallbackWorkerResult callback_worker_enqueue_string(CallbackWorkerThreadC* worke
                                                      StringCallbackFunc callback,
                                                      const char* arg);
 
+/**
+ * @brief Enqueue default callback without waiting for it to run
+ * @param worker Worker instance
+ * @param callback Callback function
+ * @param arg1 First argument
+ * @param arg2 Second argument
+ * @param arg3 Third argument (copied before this function returns)
+ * @param handle Address of variable to store the completion handle,
+ *               or NULL for fire-and-forget submission
+ * @return CallbackWorkerResult Status code
+ *
+ * A handle returned through @p handle must be released with
+ * callback_worker_task_release().
+ */
+CallbackWorkerResult callback_worker_enqueue_default_async(CallbackWorkerThreadC* worker,
+                                                            DefaultCallbackFunc callback,
+                                                            int arg1,
+                                                            double arg2,
+                                                            const char* arg3,
+                                                            CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue no-argument callback without waiting for it to run
+ * @param worker Worker instance
+ * @param callback Callback function
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CallbackWorkerResult Status code
+ */
+CallbackWorkerResult callback_worker_enqueue_no_arg_async(CallbackWorkerThreadC* worker,
+                                                           NoArgCallbackFunc callback,
+                                                           CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue single integer argument callback without waiting for it to run
+ * @param worker Worker instance
+ * @param callback Callback function
+ * @param arg Argument
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CallbackWorkerResult Status code
+ */
+CallbackWorkerResult callback_worker_enqueue_int_async(CallbackWorkerThreadC* worker,
+                                                        IntCallbackFunc callback,
+                                                        int arg,
+                                                        CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue single string argument callback without waiting for it to run
+ * @param worker Worker instance
+ * @param callback Callback function
+ * @param arg String argument (copied before this function returns)
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CallbackWorkerResult Status code
+ */
+CallbackWorkerResult callback_worker_enqueue_string_async(CallbackWorkerThreadC* worker,
+                                                           StringCallbackFunc callback,
+                                                           const char* arg,
+                                                           CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue single string argument callback, handing over the string buffer
+ * @param worker Worker instance
+ * @param callback Callback function
+ * @param arg NUL-terminated string buffer, owned by the worker from this call on
+ * @param free_func Called as free_func(arg) once the buffer is no longer needed, or NULL if it
+ *                  needs no release
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CallbackWorkerResult Status code
+ *
+ * Unlike callback_worker_enqueue_string_async, the string is never copied. The buffer is
+ * released after the callback has run, or before this function returns if the task cannot
+ * be enqueued (whatever the error), so the caller must not touch it after the call.
+ */
+CallbackWorkerResult callback_worker_enqueue_string_owned(CallbackWorkerThreadC* worker,
+                                                           StringCallbackFunc callback,
+                                                           char* arg,
+                                                           BufferFreeFunc free_func,
+                                                           CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue several callbacks at once without waiting for them to run
+ * @param worker Worker instance
+ * @param items Array of callback/argument pairs
+ * @param count Number of items
+ * @param handle Address of variable to store a completion handle that completes when every
+ *               item has run, or NULL for fire-and-forget submission
+ * @return CallbackWorkerResult Status code
+ *
+ * The batch is inserted under one queue lock acquisition and wakes at most
+ * min(count, idle workers) threads. If any item has a NULL callback, nothing is enqueued.
+ */
+CallbackWorkerResult callback_worker_enqueue_batch(CallbackWorkerThreadC* worker,
+                                                    const CallbackWorkerBatchItem* items,
+                                                    size_t count,
+                                                    CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue a callback with a priority without waiting for it to run
+ * @param worker Worker instance
+ * @param priority Scheduling priority
+ * @param callback Callback function
+ * @param user_data Argument passed to the callback (not owned)
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CallbackWorkerResult Status code
+ *   (CALLBACK_WORKER_ERROR_INVALID_PARAM for an unknown priority)
+ */
+CallbackWorkerResult callback_worker_enqueue_priority(CallbackWorkerThreadC* worker,
+                                                      CallbackWorkerPriority priority,
+                                                      UserDataCallbackFunc callback,
+                                                      void* user_data,
+                                                      CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue a callback unless the queue is full
+ * @param worker Worker instance
+ * @param callback Callback function
+ * @param user_data Argument passed to the callback (not owned)
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CALLBACK_WORKER_ERROR_QUEUE_FULL if the queue is full, whatever the overflow policy
+ */
+CallbackWorkerResult callback_worker_try_enqueue(CallbackWorkerThreadC* worker,
+                                                 UserDataCallbackFunc callback,
+                                                 void* user_data,
+                                                 CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue a callback, waiting at most timeout_ms for room in a full queue
+ * @param worker Worker instance
+ * @param callback Callback function
+ * @param user_data Argument passed to the callback (not owned)
+ * @param timeout_ms Maximum time to wait in milliseconds (0 behaves like try_enqueue)
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CALLBACK_WORKER_ERROR_QUEUE_FULL if the queue was still full at the timeout
+ */
+CallbackWorkerResult callback_worker_enqueue_timeout(CallbackWorkerThreadC* worker,
+                                                     UserDataCallbackFunc callback,
+                                                     void* user_data,
+                                                     uint32_t timeout_ms,
+                                                     CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Create a cancellation source
+ * @param source Address of variable to store the created source
+ * @return CallbackWorkerResult Status code
+ *
+ * The source must be released with callback_worker_cancel_source_release(). It may be used
+ * with any number of workers and callbacks.
+ */
+CallbackWorkerResult callback_worker_cancel_source_create(CallbackWorkerCancelSource** source);
+
+/**
+ * @brief Cancel every callback enqueued with a source
+ * @param source Cancellation source
+ * @return CallbackWorkerResult Status code
+ *
+ * Callbacks that have not started are skipped (their completion handles still complete);
+ * running callbacks may poll callback_worker_cancel_source_is_cancelled() to stop early.
+ */
+CallbackWorkerResult callback_worker_cancel_source_cancel(CallbackWorkerCancelSource* source);
+
+/**
+ * @brief Check whether a source has been cancelled
+ * @param source Cancellation source
+ * @param cancelled Address of variable to store 1 if cancelled, 0 otherwise
+ * @return CallbackWorkerResult Status code
+ */
+CallbackWorkerResult callback_worker_cancel_source_is_cancelled(CallbackWorkerCancelSource* source,
+                                                                int* cancelled);
+
+/**
+ * @brief Release a cancellation source
+ * @param source Cancellation source
+ * @return CallbackWorkerResult Status code
+ *
+ * Releasing does not cancel; callbacks already enqueued keep their own reference.
+ */
+CallbackWorkerResult callback_worker_cancel_source_release(CallbackWorkerCancelSource* source);
+
+/**
+ * @brief Enqueue a callback that is skipped if its source is cancelled before it starts
+ * @param worker Worker instance
+ * @param source Cancellation source
+ * @param callback Callback function
+ * @param user_data Argument passed to the callback (not owned)
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CallbackWorkerResult Status code
+ *
+ * If the callback is skipped, its completion handle completes with
+ * CALLBACK_WORKER_ERROR_CANCELLED.
+ */
+CallbackWorkerResult callback_worker_enqueue_cancellable(CallbackWorkerThreadC* worker,
+                                                         CallbackWorkerCancelSource* source,
+                                                         UserDataCallbackFunc callback,
+                                                         void* user_data,
+                                                         CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Enqueue a callback into a cancellation group
+ * @param worker Worker instance
+ * @param tag Group identifier (e.g. a client id)
+ * @param callback Callback function
+ * @param user_data Argument passed to the callback (not owned)
+ * @param handle Address of variable to store the completion handle, or NULL
+ * @return CallbackWorkerResult Status code
+ *
+ * If the group is cancelled before the callback starts, its completion handle completes with
+ * CALLBACK_WORKER_ERROR_CANCELLED.
+ */
+CallbackWorkerResult callback_worker_enqueue_tagged(CallbackWorkerThreadC* worker,
+                                                    uint64_t tag,
+                                                    UserDataCallbackFunc callback,
+                                                    void* user_data,
+                                                    CallbackWorkerTaskHandle** handle);
+
+/**
+ * @brief Skip every callback of a group that has not started yet
+ * @param worker Worker instance
+ * @param tag Group identifier
+ * @param cancelled Address of variable to store 1 if the group had pending callbacks, or NULL
+ * @return CallbackWorkerResult Status code
+ *
+ * Callbacks enqueued with the tag afterwards form a new group and run normally.
+ */
+CallbackWorkerResult callback_worker_cancel_tag(CallbackWorkerThreadC* worker,
+                                                uint64_t tag,
+                                                int* cancelled);
+
+/**
+ * @brief Run a callback after a delay
+ * @param worker Worker instance
+ * @param delay_ms Delay in milliseconds
+ * @param callback Callback function
+ * @param user_data Argument passed to the callback (not owned)
+ * @param timer Address of variable to store a handle that cancels the callback, or NULL
+ * @return CallbackWorkerResult Status code
+ *
+ * A handle returned through @p timer must be released with callback_worker_timer_release().
+ * Callbacks that have not run when the worker stops are discarded.
+ */
+CallbackWorkerResult callback_worker_enqueue_after(CallbackWorkerThreadC* worker,
+                                                   uint32_t delay_ms,
+                                                   UserDataCallbackFunc callback,
+                                                   void* user_data,
+                                                   CallbackWorkerTimer** timer);
+
+/**
+ * @brief Run a callback every interval_ms milliseconds
+ * @param worker Worker instance
+ * @param interval_ms Interval in milliseconds (1 or more); the first run is one interval away
+ * @param callback Callback function
+ * @param user_data Argument passed to the callback (not owned)
+ * @param timer Address of variable to store a handle that stops the runs, or NULL to run until
+ *              the worker stops
+ * @return CallbackWorkerResult Status code
+ *
+ * Runs never overlap; runs missed because the callback overran are skipped.
+ */
+CallbackWorkerResult callback_worker_schedule_periodic(CallbackWorkerThreadC* worker,
+                                                       uint32_t interval_ms,
+                                                       UserDataCallbackFunc callback,
+                                                       void* user_data,
+                                                       CallbackWorkerTimer** timer);
+
+/**
+ * @brief Cancel a delayed or periodic callback
+ * @param timer Timer handle
+ * @param cancelled Address of variable to store 1 if a run was prevented (the delayed callback
+ *                  had not run yet, or the periodic callback was still scheduled), or NULL
+ * @return CallbackWorkerResult Status code
+ *
+ * A periodic run already in progress completes. The handle must still be released.
+ */
+CallbackWorkerResult callback_worker_timer_cancel(CallbackWorkerTimer* timer, int* cancelled);
+
+/**
+ * @brief Release a timer handle
+ * @param timer Timer handle
+ * @return CallbackWorkerResult Status code
+ *
+ * Releasing a handle does not cancel the timer. Handles may be released after the worker is
+ * destroyed.
+ */
+CallbackWorkerResult callback_worker_timer_release(CallbackWorkerTimer* timer);
+
+/**
+ * @brief Check whether an asynchronously enqueued task has completed
+ * @param handle Completion handle
+ * @param completed Address of variable to store 1 if completed, 0 otherwise
+ * @return CallbackWorkerResult Status code; once completed, the task's outcome as for
+ *         callback_worker_task_wait
+ */
+CallbackWorkerResult callback_worker_task_poll(CallbackWorkerTaskHandle* handle, int* completed);
+
+/**
+ * @brief Block until an asynchronously enqueued task has completed
+ * @param handle Completion handle
+ * @return CALLBACK_WORKER_SUCCESS if the callback ran, CALLBACK_WORKER_ERROR_CANCELLED if it
+ *         was skipped by cancellation, CALLBACK_WORKER_ERROR_DROPPED if the task was discarded
+ *         by CALLBACK_WORKER_OVERFLOW_DROP_OLDEST without running
+ *
+ * While the task is pending, the caller runs other queued tasks of the worker, so waiting
+ * from inside a callback of the same worker does not deadlock.
+ */
+CallbackWorkerResult callback_worker_task_wait(CallbackWorkerTaskHandle* handle);
+
+/**
+ * @brief Block until an asynchronously enqueued task has completed or the timeout elapses
+ * @param handle Completion handle
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return CALLBACK_WORKER_ERROR_TIMEOUT if the task has not completed, its outcome as for
+ *         callback_worker_task_wait otherwise
+ *
+ * Helps the worker like callback_worker_task_wait; a helped callback is not interrupted, so
+ * the call may return up to one callback after the timeout.
+ */
+CallbackWorkerResult callback_worker_task_wait_timeout(CallbackWorkerTaskHandle* handle,
+                                                        uint32_t timeout_ms);
+
+/**
+ * @brief Release a completion handle
+ * @param handle Completion handle
+ * @return CallbackWorkerResult Status code
+ *
+ * Releasing a handle does not cancel or wait for the task; the task still runs.
+ */
+CallbackWorkerResult callback_worker_task_release(CallbackWorkerTaskHandle* handle);
+
 /**
  * @brief Get number of worker threads
  * @param worker Worker instance
@@ -128,6 +572,17 @@ CallbackWorkerResult callback_worker_enqueue_string(CallbackWorkerThreadC* worke
 CallbackWorkerResult callback_worker_get_thread_count(CallbackWorkerThreadC* worker,
                                                        size_t* count);
 
+/**
+ * @brief Change the number of worker threads
+ * @param worker Worker instance
+ * @param thread_count New thread count (within the bounds given at creation)
+ * @return CallbackWorkerResult Status code (CALLBACK_WORKER_ERROR_INVALID_PARAM if out of
+ *         bounds)
+ *
+ * Shrinking lets the surplus workers finish their current tasks before they exit.
+ */
+CallbackWorkerResult callback_worker_resize(CallbackWorkerThreadC* worker, size_t thread_count);
+
 /**
  * @brief Get number of pending tasks
  * @param worker Worker instance
@@ -137,6 +592,55 @@ CallbackWorkerResult callback_worker_get_thread_count(CallbackWorkerThreadC* wor
 CallbackWorkerResult callback_worker_get_queue_size(CallbackWorkerThreadC* worker,
                                                      size_t* size);
 
+/**
+ * @brief Turn metrics collection on or off
+ * @param worker Worker instance
+ * @param enabled Non-zero to collect (no effect if the library was built without metrics)
+ * @return CallbackWorkerResult Status code
+ */
+CallbackWorkerResult callback_worker_set_metrics_enabled(CallbackWorkerThreadC* worker,
+                                                         int enabled);
+
+/**
+ * @brief Get a metrics snapshot
+ * @param worker Worker instance
+ * @param metrics Address of structure to fill
+ * @return CallbackWorkerResult Status code
+ *
+ * Percentiles are estimated from log-bucketed histograms (within 25% of the exact value).
+ */
+CallbackWorkerResult callback_worker_get_metrics(CallbackWorkerThreadC* worker,
+                                                 CallbackWorkerMetrics* metrics);
+
+/**
+ * @brief Get the per-worker counters
+ * @param worker Worker instance
+ * @param metrics Array receiving one entry per worker slot, or NULL if capacity is 0
+ * @param capacity Number of entries metrics can hold
+ * @param count Address of variable to store the number of worker slots
+ * @return CallbackWorkerResult Status code
+ *
+ * Fills the first min(capacity, *count) entries from a single snapshot; call with capacity 0
+ * to learn the number of slots. Elastic workers have one slot per possible thread, so retired
+ * threads keep their counters and unused slots read as zero.
+ */
+CallbackWorkerResult callback_worker_get_worker_metrics(CallbackWorkerThreadC* worker,
+                                                        CallbackWorkerWorkerMetrics* metrics,
+                                                        size_t capacity,
+                                                        size_t* count);
+
+/**
+ * @brief Get the task allocator counters, shared by every worker instance of the process
+ * @param stats Address of structure to fill
+ * @return CallbackWorkerResult Status code
+ *
+ * Task state, result state and the string copies of the _async functions are placed in
+ * per-thread slab caches. Once they are warm, slab_allocations and large_allocations stay
+ * constant: enqueueing no longer calls the system allocator. All counters are 0 when the
+ * library is built with ENABLE_TASK_ALLOCATOR=OFF.
+ */
+CallbackWorkerResult callback_worker_get_allocator_stats(CallbackWorkerAllocatorStats* stats);
+
 /**
  * @brief Stop thread pool
  * @param worker Worker instance
@@ -148,9 +652,30 @@ CallbackWorkerResult callback_worker_stop(CallbackWorkerThreadC* worker);
  * @brief Wait for all tasks to complete
  * @param worker Worker instance
  * @return CallbackWorkerResult Status code
+ *
+ * Same as callback_worker_wait_idle().
  */
 CallbackWorkerResult callback_worker_wait_completion(CallbackWorkerThreadC* worker);
 
+/**
+ * @brief Wait until every submitted task has finished running
+ * @param worker Worker instance
+ * @return CallbackWorkerResult Status code
+ *
+ * The worker keeps accepting tasks; unlike callback_worker_stop() this is a reusable barrier.
+ * Must not be called from a callback running on the same worker.
+ */
+CallbackWorkerResult callback_worker_wait_idle(CallbackWorkerThreadC* worker);
+
+/**
+ * @brief Wait until every submitted task has finished or the timeout elapses
+ * @param worker Worker instance
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return CALLBACK_WORKER_SUCCESS if idle, CALLBACK_WORKER_ERROR_TIMEOUT otherwise
+ */
+CallbackWorkerResult callback_worker_wait_idle_timeout(CallbackWorkerThreadC* worker,
+                                                       uint32_t timeout_ms);
+
 /**
  * @brief Convert error code to string
  * @param result Error code
@@ -0,0 +1,164 @@
+#ifndef CALLBACK_WORKER_THREAD_CALLBACK_WORKER_THREAD_OPTIONS_H_
+#define CALLBACK_WORKER_THREAD_CALLBACK_WORKER_THREAD_OPTIONS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <vector>
+
+namespace callback_worker_thread {
+
+/// Task queue implementation used by CallbackWorkerThread
+enum class QueueType {
+  kLocked,    ///< Unbounded FIFO guarded by a mutex (default)
+  kLockFree,  ///< Bounded lock-free multi-producer/multi-consumer ring buffer
+};
+
+/// Scheduling priority of a task
+enum class TaskPriority {
+  kHigh = 0,    ///< Dequeued before normal and low priority tasks
+  kNormal = 1,  ///< Default priority
+  kLow = 2,     ///< Dequeued only when no higher priority task is queued (see starvation_limit)
+};
+
+/// Number of TaskPriority levels
+inline constexpr size_t kTaskPriorityLevels = 3;
+
+/// What Enqueue/Post do when CallbackWorkerThreadOptions::max_queue_size tasks are queued
+enum class OverflowPolicy {
+  kBlock,       ///< Block the producer until a worker frees a slot (default)
+  kReject,      ///< Throw QueueFullError
+  /// Discard the oldest task of the lowest non-empty priority level. Tasks the pool submits
+  /// for admitted work (timers, continuations, strands, coroutine resumptions) and tasks in
+  /// work-stealing deques are never dropped; if only those are queued, the new task is admitted
+  /// over the limit.
+  kDropOldest,
+  kCallerRuns,  ///< Run the task on the submitting thread (throttles producers to the pool's pace)
+};
+
+/// What an idle worker does while the queue is empty
+enum class WaitStrategy {
+  kBlock,         ///< Park on the condition variable immediately (default, no CPU use)
+  kSpinThenPark,  ///< Spin with a CPU pause hint, then yield, then park
+  kYield,         ///< Never park; yield the CPU between polls
+  kBusySpin,      ///< Never park; poll with a CPU pause hint (lowest latency, one core per worker)
+};
+
+/// Where worker threads run (see CpuTopology for how NUMA nodes are detected)
+enum class WorkerPlacement {
+  kNone,      ///< Let the OS schedule workers, within cpu_set if it is not empty (default)
+  kCpu,       ///< Pin each worker to one CPU; consecutive workers go to different NUMA nodes
+  kNumaNode,  ///< Bind each worker to every CPU of one NUMA node, round-robin over the nodes
+};
+
+/**
+ * @brief Construction options for CallbackWorkerThread
+ *
+ * Every field has a default, so callers only set what they need:
+ * @code
+ * CallbackWorkerThreadOptions options;
+ * options.thread_count = 16;
+ * options.queue_type = QueueType::kLockFree;
+ * CallbackWorkerThread worker(options);
+ * @endcode
+ */
+struct CallbackWorkerThreadOptions {
+  /// Number of worker threads (must be greater than 0); the initial size of an elastic pool
+  size_t thread_count = 1;
+
+  /// Elastic pool bounds: the pool grows up to max_thread_count under load and retires idle
+  /// workers down to min_thread_count. 0 means thread_count, so by default the pool is fixed.
+  /// Must satisfy 0 < min_thread_count <= thread_count <= max_thread_count.
+  size_t min_thread_count = 0;
+  size_t max_thread_count = 0;
+
+  /// Elastic pools: a parked worker above min_thread_count retires after this long without
+  /// work (workers using kYield or kBusySpin never park, so they are only retired by Resize)
+  std::chrono::milliseconds keep_alive{60000};
+
+  /// Elastic pools: start a worker when a push leaves more than grow_queue_depth tasks queued
+  /// while no worker is parked
+  size_t grow_queue_depth = 0;
+
+  /// Elastic pools: also start a worker when a task waited in the queue longer than this
+  /// (checked when a worker takes it; 0 disables the check)
+  std::chrono::microseconds grow_wait_threshold{0};
+
+  /// Task queue implementation
+  QueueType queue_type = QueueType::kLocked;
+
+  /// Ring buffer size for QueueType::kLockFree (rounded up to a power of two).
+  /// Producers wait for a free slot when the ring is full (TryEnqueue and friends fail
+  /// instead); max_queue_size must not exceed it.
+  size_t lock_free_queue_size = 65536;
+
+  /// Give every worker its own work-stealing deque. Tasks enqueued from inside a worker go to
+  /// that worker's deque (popped LIFO by the owner); idle workers steal from the others.
+  /// Tasks enqueued from other threads still go through the shared queue.
+  bool work_stealing = false;
+
+  /// Maximum number of tasks a worker takes from the shared queue per acquisition (must be
+  /// greater than 0). Values above 1 amortize lock and wakeup cost for tiny callbacks, at the
+  /// price of tasks waiting in one worker's buffer while other workers could run them.
+  size_t dequeue_batch_size = 1;
+
+  /// Adapt the per-acquisition batch between 1 and dequeue_batch_size: double it while a
+  /// backlog remains after a full batch, halve it when the queue runs short.
+  bool adaptive_dequeue_batch = false;
+
+  /// Starvation protection for priority levels: every starvation_limit-th dequeue takes the
+  /// oldest task of the lowest non-empty level instead of the highest. 0 disables it (strict
+  /// priority order).
+  size_t starvation_limit = 0;
+
+  /// Idle strategy for workers. Anything but kBlock trades CPU time for lower wakeup latency;
+  /// producers only pay for a wakeup when at least one worker is actually parked.
+  WaitStrategy wait_strategy = WaitStrategy::kBlock;
+
+  /// kSpinThenPark: number of pause-spins before the worker starts yielding
+  size_t spin_iterations = 2000;
+
+  /// kSpinThenPark: number of yields before the worker parks
+  size_t yield_iterations = 20;
+
+  /// Maximum number of queued (not yet started) tasks; 0 means unbounded. Tasks submitted
+  /// from this pool's own workers are never blocked by the limit, since they could deadlock.
+  size_t max_queue_size = 0;
+
+  /// Behaviour of Enqueue/Post/batches when the queue is full (TryEnqueue and friends never
+  /// block or drop)
+  OverflowPolicy overflow_policy = OverflowPolicy::kBlock;
+
+  /// kDropOldest: called on the producer thread once per dropped task. A dropped Enqueue'd
+  /// task's future reports std::future_errc::broken_promise.
+  std::function<void()> drop_handler;
+
+  /// Resolution of EnqueueAfter/EnqueueAt/SchedulePeriodic deadlines (must be greater than 0);
+  /// timers fire up to one tick late
+  std::chrono::microseconds timer_tick{1000};
+
+  /// CPUs workers may run on; empty means every CPU. Pinning is best effort: a CPU the process
+  /// may not use leaves the worker unpinned.
+  std::vector<int> cpu_set;
+
+  /// How workers are placed on the CPUs of cpu_set
+  WorkerPlacement placement = WorkerPlacement::kNone;
+
+  /// Keep one shared queue per NUMA node. A submission goes to the queue of the node the
+  /// submitting thread runs on, and workers serve their own node's queue before the others
+  /// (priority still comes first). Requires placement kCpu or kNumaNode.
+  bool numa_local_queues = false;
+
+  /// Collect per-worker metrics (see CallbackWorkerThread::GetMetrics). Costs two clock reads
+  /// per task while on; can be toggled later with SetMetricsEnabled.
+  bool enable_metrics = false;
+
+  /// Handler for exceptions escaping posted tasks (see CallbackWorkerThread::Post).
+  /// Called on the worker thread; empty means such exceptions are ignored.
+  std::function<void(std::exception_ptr)> exception_handler;
+};
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_CALLBACK_WORKER_THREAD_OPTIONS_H_
@@ -0,0 +1,86 @@
+#ifndef CALLBACK_WORKER_THREAD_CANCELLATION_H_
+#define CALLBACK_WORKER_THREAD_CANCELLATION_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace callback_worker_thread {
+
+class CallbackWorkerThread;
+
+namespace detail {
+
+/// Flag shared by a CancellationSource and its tokens
+struct CancellationState {
+  std::atomic<bool> cancelled{false};
+};
+
+}  // namespace detail
+
+/**
+ * @brief Read side of a cancellation flag (a C++17 stand-in for std::stop_token)
+ *
+ * Tasks submitted with a token are skipped if it is cancelled before they start; a running
+ * task polls IsCancellationRequested() to stop early. Copying a token is cheap (one
+ * shared_ptr). A default-constructed token is never cancelled.
+ *
+ * Thread safety: all members may be called concurrently.
+ */
+class CancellationToken {
+ public:
+  CancellationToken() = default;
+
+  /// @return true once the owning source (or tag) has been cancelled
+  bool IsCancellationRequested() const {
+    return state_ != nullptr && state_->cancelled.load(std::memory_order_acquire);
+  }
+
+  /// @return false for a default-constructed token, which can never be cancelled
+  bool CanBeCancelled() const { return state_ != nullptr; }
+
+ private:
+  friend class CancellationSource;
+  friend class CallbackWorkerThread;
+
+  explicit CancellationToken(std::shared_ptr<detail::CancellationState> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<detail::CancellationState> state_;
+};
+
+/**
+ * @brief Write side of a cancellation flag (a C++17 stand-in for std::stop_source)
+ *
+ * Copies share the same flag. Cancellation is one-way and cannot be reset; use a new source
+ * for new work.
+ *
+ * Thread safety: all members may be called concurrently.
+ */
+class CancellationSource {
+ public:
+  CancellationSource() : state_(std::make_shared<detail::CancellationState>()) {}
+
+  /**
+   * @brief Cancel every task holding a token of this source
+   * @return true if this call made the request (false if it was already cancelled)
+   */
+  bool RequestCancel() {
+    return !state_->cancelled.exchange(true, std::memory_order_acq_rel);
+  }
+
+  /// @return true once RequestCancel() has been called
+  bool IsCancellationRequested() const {
+    return state_->cancelled.load(std::memory_order_acquire);
+  }
+
+  /// @return Token observing this source
+  CancellationToken GetToken() const { return CancellationToken(state_); }
+
+ private:
+  std::shared_ptr<detail::CancellationState> state_;
+};
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_CANCELLATION_H_
@@ -0,0 +1,317 @@
+#ifndef CALLBACK_WORKER_THREAD_COROUTINE_H_
+#define CALLBACK_WORKER_THREAD_COROUTINE_H_
+
+#if !defined(__cpp_impl_coroutine)
+#error "coroutine.h requires C++20 coroutines (configure with -DENABLE_COROUTINES=ON)"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+
+namespace callback_worker_thread {
+
+/**
+ * @brief Allocation hook for coroutine frames (CoTask and Spawn)
+ *
+ * Both functions must be thread-safe: frames may be freed on a different thread than the one
+ * that allocated them. allocate must return memory aligned to __STDCPP_DEFAULT_NEW_ALIGNMENT__
+ * or nullptr on failure.
+ */
+struct CoroutineFrameAllocator {
+  void* (*allocate)(size_t size);
+  void (*deallocate)(void* frame, size_t size);
+};
+
+namespace detail {
+
+inline std::atomic<const CoroutineFrameAllocator*> frame_allocator{nullptr};
+
+// Records which allocator a frame came from, so that changing the hook while coroutines are
+// alive is safe
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) FramePrefix {
+  const CoroutineFrameAllocator* allocator;
+};
+
+inline void* AllocateFrame(size_t size) {
+  const CoroutineFrameAllocator* allocator = frame_allocator.load(std::memory_order_acquire);
+  const size_t total = size + sizeof(FramePrefix);
+  void* raw = allocator != nullptr ? allocator->allocate(total) : ::operator new(total);
+  if (raw == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ::new (raw) FramePrefix{allocator} + 1;
+}
+
+inline void DeallocateFrame(void* frame, size_t size) {
+  FramePrefix* prefix = static_cast<FramePrefix*>(frame) - 1;
+  const CoroutineFrameAllocator* allocator = prefix->allocator;
+  const size_t total = size + sizeof(FramePrefix);
+  if (allocator != nullptr) {
+    allocator->deallocate(prefix, total);
+  } else {
+    ::operator delete(prefix, total);
+  }
+}
+
+/// Routes the frame allocation of a coroutine through the installed hook
+struct FrameAllocated {
+  static void* operator new(size_t size) { return AllocateFrame(size); }
+  static void operator delete(void* frame, size_t size) { DeallocateFrame(frame, size); }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Install the coroutine frame allocator
+ * @param allocator Hook used for frames created from now on (must outlive them), or nullptr to
+ *        return to global operator new
+ */
+inline void SetCoroutineFrameAllocator(const CoroutineFrameAllocator* allocator) {
+  detail::frame_allocator.store(allocator, std::memory_order_release);
+}
+
+/**
+ * @brief Awaitable that moves the awaiting coroutine onto a pool worker
+ *
+ * The coroutine handle is posted as an ordinary task; it fits the Task inline buffer, so
+ * suspending costs no allocation. Resumptions bypass CallbackWorkerThreadOptions::
+ * max_queue_size: a dropped resumption would leak the frame, and running it on the caller
+ * would resume the coroutine inside its own await_suspend.
+ */
+class ScheduleAwaiter {
+ public:
+  ScheduleAwaiter(CallbackWorkerThread& pool, TaskPriority priority)
+      : pool_(pool), priority_(priority) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  /// @throws std::runtime_error (at the co_await) if the thread pool is stopped
+  void await_suspend(std::coroutine_handle<> handle) {
+    pool_.PushTask(Task([handle]() { handle.resume(); }), priority_,
+                   CallbackWorkerThread::AdmitMode::kForce);
+  }
+
+  void await_resume() const noexcept {}
+
+ private:
+  CallbackWorkerThread& pool_;
+  TaskPriority priority_;
+};
+
+/**
+ * @brief Resume the calling coroutine on a worker of a pool
+ * @param pool Thread pool
+ * @param priority Scheduling priority of the resumption
+ * @return Awaitable (use as co_await Schedule(pool))
+ */
+inline ScheduleAwaiter Schedule(CallbackWorkerThread& pool,
+                                TaskPriority priority = TaskPriority::kNormal) {
+  return ScheduleAwaiter(pool, priority);
+}
+
+template <typename T = void>
+class CoTask;
+
+namespace detail {
+
+class CoTaskPromiseBase : public FrameAllocated {
+ public:
+  // Hands control back to the awaiter (symmetric transfer: no stack growth across chains)
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      std::coroutine_handle<> continuation = handle.promise().continuation_;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+  void set_continuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+
+ protected:
+  void RethrowIfFailed() const {
+    if (exception_ != nullptr) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+ private:
+  std::coroutine_handle<> continuation_;
+  std::exception_ptr exception_;
+};
+
+template <typename T>
+class CoTaskPromise : public CoTaskPromiseBase {
+ public:
+  CoTask<T> get_return_object() noexcept;
+
+  template <typename U>
+  void return_value(U&& value) {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  T TakeResult() {
+    RethrowIfFailed();
+    return std::move(*value_);
+  }
+
+ private:
+  std::optional<T> value_;
+};
+
+template <>
+class CoTaskPromise<void> : public CoTaskPromiseBase {
+ public:
+  CoTask<void> get_return_object() noexcept;
+
+  void return_void() const noexcept {}
+
+  void TakeResult() const { RethrowIfFailed(); }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Lazily started coroutine producing a T
+ * @tparam T Result type (may be void)
+ *
+ * The body starts when the task is first awaited and runs on the awaiting thread until it
+ * suspends (e.g. on co_await Schedule(pool)). When it finishes, the awaiting coroutine is
+ * resumed directly on the thread that finished it, typically a pool worker, with no
+ * intermediate task or blocked thread. The frame is the only allocation
+ * (see SetCoroutineFrameAllocator). Exceptions propagate to the awaiter.
+ *
+ * Named CoTask because Task is the pool's type-erased callable. Move-only; a task may be
+ * awaited once. Use Spawn() to start one from non-coroutine code.
+ */
+template <typename T>
+class [[nodiscard]] CoTask {
+ public:
+  using promise_type = detail::CoTaskPromise<T>;
+
+  CoTask() = default;
+  CoTask(CoTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  CoTask& operator=(CoTask&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  ~CoTask() { Reset(); }
+
+  /// @return true if the task holds a coroutine
+  bool Valid() const noexcept { return static_cast<bool>(handle_); }
+
+  /// Awaiting starts the coroutine and resumes the awaiter with its result
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().set_continuation(awaiting);
+        return handle;
+      }
+
+      T await_resume() {
+        if (!handle) {
+          throw std::future_error(std::future_errc::no_state);
+        }
+        return handle.promise().TakeResult();
+      }
+
+      std::coroutine_handle<promise_type> handle;
+    };
+    return Awaiter{handle_};
+  }
+
+ private:
+  friend class detail::CoTaskPromise<T>;
+
+  explicit CoTask(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+  void Reset() noexcept {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = nullptr;
+    }
+  }
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+CoTask<T> CoTaskPromise<T>::get_return_object() noexcept {
+  return CoTask<T>(std::coroutine_handle<CoTaskPromise<T>>::from_promise(*this));
+}
+
+inline CoTask<void> CoTaskPromise<void>::get_return_object() noexcept {
+  return CoTask<void>(std::coroutine_handle<CoTaskPromise<void>>::from_promise(*this));
+}
+
+/// Eagerly started coroutine that frees its own frame when it finishes
+struct DetachedCoroutine {
+  struct promise_type : FrameAllocated {
+    DetachedCoroutine get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    // The body catches everything and reports it through the promise
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+template <typename T>
+DetachedCoroutine RunSpawned(CallbackWorkerThread& pool, CoTask<T> task, Promise<T> promise) {
+  try {
+    co_await Schedule(pool);
+    if constexpr (std::is_void<T>::value) {
+      co_await std::move(task);
+      promise.SetValue();
+    } else {
+      promise.SetValue(co_await std::move(task));
+    }
+  } catch (...) {
+    promise.SetException(std::current_exception());
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Run a coroutine on a pool from non-coroutine code
+ * @param pool Thread pool
+ * @param task Coroutine to run; it starts on a worker of pool
+ * @return Future of the coroutine's result, whose Then() continuations run on pool. It holds
+ *         std::runtime_error if the pool is stopped.
+ */
+template <typename T>
+Future<T> Spawn(CallbackWorkerThread& pool, CoTask<T> task) {
+  Promise<T> promise(&pool);
+  Future<T> result = promise.GetFuture();
+  detail::RunSpawned(pool, std::move(task), std::move(promise));
+  return result;
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_COROUTINE_H_
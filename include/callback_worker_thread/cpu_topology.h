@@ -0,0 +1,81 @@
+#ifndef CALLBACK_WORKER_THREAD_CPU_TOPOLOGY_H_
+#define CALLBACK_WORKER_THREAD_CPU_TOPOLOGY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace callback_worker_thread {
+
+/**
+ * @brief NUMA layout of the machine's CPUs
+ *
+ * Detected from sysfs (/sys/devices/system/node) on Linux, so no libnuma is needed. Elsewhere,
+ * or when sysfs is unavailable, the machine is reported as a single node holding every CPU.
+ */
+struct CpuTopology {
+  /// CPU ids of each NUMA node, in ascending order; nodes without CPUs are omitted, and there
+  /// is always at least one node
+  std::vector<std::vector<int>> nodes;
+
+  /// Node index (into nodes) of each CPU id; CPUs outside every node map to 0
+  std::vector<size_t> node_of_cpu;
+
+  /**
+   * @brief Detect the topology of the running machine
+   * @return Detected topology
+   */
+  static CpuTopology Detect();
+
+  /**
+   * @brief Build a topology from per-node CPU lists
+   * @param node_cpus CPU ids of each node (empty nodes are dropped)
+   * @return Topology with node_of_cpu filled in
+   */
+  static CpuTopology FromNodes(std::vector<std::vector<int>> node_cpus);
+
+  /**
+   * @brief Keep only the given CPUs
+   * @param cpus CPUs to keep; empty keeps every CPU
+   * @return Topology whose nodes hold only CPUs from cpus (nodes left empty are dropped; if
+   *         none of cpus is known, a single node holding cpus)
+   */
+  CpuTopology Restrict(const std::vector<int>& cpus) const;
+
+  /**
+   * @brief Get the node of a CPU
+   * @param cpu CPU id (may be negative, meaning unknown)
+   * @return Node index, or 0 if the CPU is unknown
+   */
+  size_t NodeOfCpu(int cpu) const {
+    return cpu >= 0 && static_cast<size_t>(cpu) < node_of_cpu.size()
+               ? node_of_cpu[static_cast<size_t>(cpu)]
+               : 0;
+  }
+};
+
+/**
+ * @brief Parse a Linux CPU list such as "0-3,8,10-11"
+ * @param list CPU list text (surrounding whitespace is ignored)
+ * @return CPU ids in the order listed; malformed entries are skipped
+ */
+std::vector<int> ParseCpuList(const std::string& list);
+
+/**
+ * @brief Restrict the calling thread to a set of CPUs
+ * @param cpus CPU ids (must not be empty)
+ * @return false if the platform does not support affinity or the kernel refused the set
+ *
+ * Supported on Linux (pthread_setaffinity_np) and Windows (CPUs 0-63 of processor group 0).
+ */
+bool SetCurrentThreadAffinity(const std::vector<int>& cpus);
+
+/**
+ * @brief Get the CPU the calling thread is running on
+ * @return CPU id, or -1 if the platform cannot tell
+ */
+int GetCurrentCpu();
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_CPU_TOPOLOGY_H_
@@ -0,0 +1,574 @@
+#ifndef CALLBACK_WORKER_THREAD_FUTURE_H_
+#define CALLBACK_WORKER_THREAD_FUTURE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "callback_worker_thread/task.h"
+#include "callback_worker_thread/task_allocator.h"
+
+namespace callback_worker_thread {
+
+class CallbackWorkerThread;
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+namespace detail {
+
+/// Stand-in value of a void future
+struct Unit {};
+
+/// Type stored for a future of T
+template <typename T>
+using FutureValue = std::conditional_t<std::is_void<T>::value, Unit, T>;
+
+/**
+ * @brief Lifetime token of a pool, shared with the futures that schedule on it
+ *
+ * Futures may outlive their pool, so they hold the anchor instead of a pool pointer. The pool
+ * clears `pool` when it is destroyed and then waits until no submission is in progress.
+ */
+struct PoolAnchor {
+  explicit PoolAnchor(CallbackWorkerThread* owner) : pool(owner) {}
+
+  std::atomic<CallbackWorkerThread*> pool;
+  // Threads currently between reading pool and finishing their submission
+  std::atomic<size_t> submitters{0};
+};
+
+/// @return The anchor of a live pool (defined in future.cpp)
+std::shared_ptr<PoolAnchor> AnchorOf(CallbackWorkerThread& pool);
+
+/**
+ * @brief Submit a continuation to a pool (defined in future.cpp)
+ * @param anchor Anchor of the pool running the continuation
+ * @param task Continuation; destroyed unrun if the pool is stopped or destroyed, which breaks
+ *        its promise
+ *
+ * Continuations bypass CallbackWorkerThreadOptions::max_queue_size: the work they continue
+ * was already admitted, and blocking a completing worker could deadlock the pool.
+ */
+void ScheduleContinuation(const std::shared_ptr<PoolAnchor>& anchor, Task&& task);
+
+/**
+ * @brief Shared state of a Future/Promise pair
+ *
+ * One allocation holds the result, the waiters' condition variable and at most one
+ * continuation, which runs (or is submitted to its pool) as soon as the result is set.
+ */
+template <typename T>
+struct FutureState {
+  /**
+   * @brief Publish the result and release the continuation
+   * @param store Stores the value or exception (called under the lock)
+   * @return false if a result was already set
+   */
+  template <typename Store>
+  bool Complete(Store&& store) {
+    Task pending;
+    std::shared_ptr<PoolAnchor> pool;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (ready) {
+        return false;
+      }
+      store();
+      ready = true;
+      pending = std::move(continuation);
+      pool = std::move(continuation_pool);
+    }
+    ready_condition.notify_all();
+    if (pending) {
+      Dispatch(pool, std::move(pending));
+    }
+    return true;
+  }
+
+  /**
+   * @brief Attach the continuation; runs it at once if the result is already set
+   * @param pool Anchor of the pool to run it on, or nullptr to run it on the completing thread
+   * @param task Continuation
+   */
+  void SetContinuation(std::shared_ptr<PoolAnchor> pool, Task&& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (continuation) {
+        throw std::future_error(std::future_errc::future_already_retrieved);
+      }
+      if (!ready) {
+        continuation = std::move(task);
+        continuation_pool = std::move(pool);
+        return;
+      }
+    }
+    Dispatch(pool, std::move(task));
+  }
+
+  static void Dispatch(const std::shared_ptr<PoolAnchor>& pool, Task&& task) {
+    if (pool != nullptr) {
+      ScheduleContinuation(pool, std::move(task));
+    } else {
+      task();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable ready_condition;
+  bool ready = false;
+  std::optional<FutureValue<T>> value;
+  std::exception_ptr exception;
+  Task continuation;
+  std::shared_ptr<PoolAnchor> continuation_pool;
+  // Pool that Future::Then schedules on by default (nullptr: the completing thread)
+  std::shared_ptr<PoolAnchor> executor;
+};
+
+/// Gives the combinators access to a future's state
+struct FutureAccess {
+  template <typename T>
+  static std::shared_ptr<FutureState<T>> Take(Future<T>& future) {
+    if (future.state_ == nullptr) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    return std::move(future.state_);
+  }
+
+  template <typename T>
+  static void SetExecutor(Promise<T>& promise, std::shared_ptr<PoolAnchor> executor) {
+    promise.state_->executor = std::move(executor);
+  }
+};
+
+/// Result type of Future<T>::Then(f): f takes the value, or nothing for a void future
+template <typename F, typename T, bool = std::is_void<T>::value>
+struct ThenResult {
+  using type = std::decay_t<std::invoke_result_t<F, T>>;
+};
+
+template <typename F, typename T>
+struct ThenResult<F, T, true> {
+  using type = std::decay_t<std::invoke_result_t<F>>;
+};
+
+/**
+ * @brief Run a nullary invoker and publish its result through a Promise
+ * @param promise Promise receiving the return value or the thrown exception
+ * @param invoke Invoker returning R
+ */
+template <typename R, typename Invoke>
+void FulfillPromise(Promise<R>& promise, Invoke&& invoke) {
+  try {
+    if constexpr (std::is_void<R>::value) {
+      invoke();
+      promise.SetValue();
+    } else {
+      promise.SetValue(invoke());
+    }
+  } catch (...) {
+    promise.SetException(std::current_exception());
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Result of WhenAny: the index of the first future to complete and its value
+ * @tparam T Value type of the futures
+ */
+template <typename T>
+struct WhenAnyResult {
+  size_t index;
+  T value;
+};
+
+template <>
+struct WhenAnyResult<void> {
+  size_t index;
+};
+
+/**
+ * @brief Future with non-blocking continuations (see CallbackWorkerThread::EnqueueFuture)
+ * @tparam T Value type (may be void)
+ *
+ * Unlike std::future, work can be chained with Then() instead of parking a thread in Get().
+ * A future and its promise share one allocation. Futures are move-only and single-consumer:
+ * Get(), Then() and the combinators each consume the future (Valid() becomes false).
+ *
+ * Thread safety: a Future must not be used from several threads at once; it may complete
+ * concurrently with any member.
+ */
+template <typename T>
+class Future {
+ public:
+  Future() = default;
+  Future(Future&&) noexcept = default;
+  Future& operator=(Future&&) noexcept = default;
+
+  /// @return true if the future refers to a result (not default-constructed or consumed)
+  bool Valid() const { return state_ != nullptr; }
+
+  /// @return true if the result is available (Get() will not block)
+  bool IsReady() const {
+    std::lock_guard<std::mutex> lock(CheckedState().mutex);
+    return state_->ready;
+  }
+
+  /// Block until the result is available (must not be called from a worker of its pool)
+  void Wait() const {
+    detail::FutureState<T>& state = CheckedState();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.ready_condition.wait(lock, [&state] { return state.ready; });
+  }
+
+  /**
+   * @brief Block until the result is available or the timeout elapses
+   * @param timeout Maximum time to wait
+   * @return true if the result is available
+   */
+  template <typename Rep, typename Period>
+  bool WaitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+    detail::FutureState<T>& state = CheckedState();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    return state.ready_condition.wait_for(lock, timeout, [&state] { return state.ready; });
+  }
+
+  /**
+   * @brief Wait for and take the result
+   * @return The value
+   * @throws The exception the task threw, or std::future_error (broken_promise) if its
+   *         promise was destroyed unfulfilled
+   */
+  T Get() {
+    Wait();
+    std::shared_ptr<detail::FutureState<T>> state = std::move(state_);
+    if (state->exception != nullptr) {
+      std::rethrow_exception(state->exception);
+    }
+    if constexpr (!std::is_void<T>::value) {
+      return std::move(*state->value);
+    }
+  }
+
+  /**
+   * @brief Chain a function to run once this future has a value
+   * @param f Function taking the value (nothing for a void future)
+   * @return Future of f's result; if this future holds an exception, f is skipped and the
+   *         exception is passed on
+   *
+   * f is submitted to the pool that produced this future (CallbackWorkerThread::EnqueueFuture)
+   * when the value is set, so no thread waits in between. For a future of a standalone
+   * Promise, f runs on the thread that sets the value. If that pool has been stopped or
+   * destroyed, f is skipped and the returned future reports std::future_error
+   * (broken_promise).
+   */
+  template <typename F>
+  auto Then(F&& f) -> Future<typename detail::ThenResult<F, T>::type> {
+    std::shared_ptr<detail::PoolAnchor> executor = CheckedState().executor;
+    return ThenOn(std::move(executor), std::forward<F>(f));
+  }
+
+  /**
+   * @brief Chain a function to run on a given pool once this future has a value
+   * @param pool Pool running f
+   * @param f Function taking the value (nothing for a void future)
+   * @return Future of f's result (exceptions are passed on as for Then(f))
+   */
+  template <typename F>
+  auto Then(CallbackWorkerThread& pool, F&& f) -> Future<typename detail::ThenResult<F, T>::type> {
+    return ThenOn(detail::AnchorOf(pool), std::forward<F>(f));
+  }
+
+ private:
+  template <typename>
+  friend class Promise;
+  template <typename>
+  friend class Future;
+  friend struct detail::FutureAccess;
+
+  explicit Future(std::shared_ptr<detail::FutureState<T>> state) : state_(std::move(state)) {}
+
+  detail::FutureState<T>& CheckedState() const {
+    if (state_ == nullptr) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    return *state_;
+  }
+
+  template <typename F>
+  auto ThenOn(std::shared_ptr<detail::PoolAnchor> pool, F&& f)
+      -> Future<typename detail::ThenResult<F, T>::type>;
+
+  std::shared_ptr<detail::FutureState<T>> state_;
+};
+
+/**
+ * @brief Producer side of a Future
+ * @tparam T Value type (may be void)
+ *
+ * Destroying a promise without setting a result completes its future with
+ * std::future_error (broken_promise).
+ */
+template <typename T>
+class Promise {
+ public:
+  /**
+   * @brief Constructor
+   * @param executor Pool that the future's Then() schedules on, or nullptr to run
+   *        continuations on the thread that sets the result. The future may outlive it.
+   */
+  explicit Promise(CallbackWorkerThread* executor = nullptr)
+      : state_(MakeState()) {
+    if (executor != nullptr) {
+      state_->executor = detail::AnchorOf(*executor);
+    }
+  }
+
+  Promise(Promise&&) noexcept = default;
+
+  Promise& operator=(Promise&& other) noexcept {
+    if (this != &other) {
+      Abandon();
+      state_ = std::move(other.state_);
+      retrieved_ = other.retrieved_;
+    }
+    return *this;
+  }
+
+  ~Promise() { Abandon(); }
+
+  /**
+   * @brief Get the future (once)
+   * @throws std::future_error (future_already_retrieved) on a second call
+   */
+  Future<T> GetFuture() {
+    if (state_ == nullptr) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    if (retrieved_) {
+      throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+    retrieved_ = true;
+    return Future<T>(state_);
+  }
+
+  /**
+   * @brief Set the value
+   * @param value Value (omitted for a void promise)
+   * @throws std::future_error (promise_already_satisfied) if a result was already set
+   */
+  template <typename... V>
+  void SetValue(V&&... value) {
+    Satisfy([&] { state_->value.emplace(std::forward<V>(value)...); });
+  }
+
+  /**
+   * @brief Set an exception
+   * @param exception Exception rethrown by Future::Get
+   * @throws std::future_error (promise_already_satisfied) if a result was already set
+   */
+  void SetException(std::exception_ptr exception) {
+    Satisfy([&] { state_->exception = std::move(exception); });
+  }
+
+ private:
+  // The state is placed by the task allocator (see GetTaskAllocatorStats) unless over-aligned
+  static std::shared_ptr<detail::FutureState<T>> MakeState() {
+    if constexpr (detail::IsTaskAllocatable<detail::FutureState<T>>()) {
+      return std::allocate_shared<detail::FutureState<T>>(detail::TaskAllocator<char>());
+    } else {
+      return std::make_shared<detail::FutureState<T>>();
+    }
+  }
+
+  template <typename Store>
+  void Satisfy(Store&& store) {
+    if (state_ == nullptr) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    if (!state_->Complete(std::forward<Store>(store))) {
+      throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+  }
+
+  void Abandon() {
+    if (state_ != nullptr) {
+      state_->Complete([this] {
+        state_->exception =
+            std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+      });
+      state_.reset();
+    }
+  }
+
+  friend struct detail::FutureAccess;
+
+  std::shared_ptr<detail::FutureState<T>> state_;
+  bool retrieved_ = false;
+};
+
+template <typename T>
+template <typename F>
+auto Future<T>::ThenOn(std::shared_ptr<detail::PoolAnchor> pool, F&& f)
+    -> Future<typename detail::ThenResult<F, T>::type> {
+  using result_type = typename detail::ThenResult<F, T>::type;
+
+  std::shared_ptr<detail::FutureState<T>> state = detail::FutureAccess::Take(*this);
+  Promise<result_type> promise;
+  detail::FutureAccess::SetExecutor(promise, pool);
+  Future<result_type> result = promise.GetFuture();
+  detail::FutureState<T>* const raw = state.get();
+  raw->SetContinuation(std::move(pool), Task([state = std::move(state), promise = std::move(promise),
+                                   func = std::forward<F>(f)]() mutable {
+    if (state->exception != nullptr) {
+      promise.SetException(state->exception);
+      return;
+    }
+    detail::FulfillPromise(promise, [&]() -> decltype(auto) {
+      if constexpr (std::is_void<T>::value) {
+        return func();
+      } else {
+        return func(std::move(*state->value));
+      }
+    });
+  }));
+  return result;
+}
+
+/**
+ * @brief Future completing when all inputs have completed
+ * @param futures Input futures (consumed)
+ * @return Future of the values in input order (void for void inputs), or of the first
+ *         exception (in completion order) if any input failed
+ * @throws std::future_error (no_state) if an input is not valid
+ *
+ * Bookkeeping runs inline on the completing threads; the result's Then() schedules on the
+ * first input's pool.
+ */
+template <typename T>
+auto WhenAll(std::vector<Future<T>> futures)
+    -> Future<std::conditional_t<std::is_void<T>::value, void, std::vector<T>>> {
+  using result_type = std::conditional_t<std::is_void<T>::value, void, std::vector<T>>;
+
+  std::vector<std::shared_ptr<detail::FutureState<T>>> states;
+  states.reserve(futures.size());
+  for (Future<T>& future : futures) {
+    states.push_back(detail::FutureAccess::Take(future));
+  }
+
+  struct Aggregate {
+    Aggregate(std::shared_ptr<detail::PoolAnchor> executor, size_t count)
+        : remaining(count), values(count) {
+      detail::FutureAccess::SetExecutor(promise, std::move(executor));
+    }
+
+    Promise<result_type> promise;
+    std::atomic<size_t> remaining;
+    std::vector<std::optional<detail::FutureValue<T>>> values;
+    std::atomic<bool> failed{false};
+    std::exception_ptr exception;
+  };
+  auto aggregate = std::make_shared<Aggregate>(
+      states.empty() ? nullptr : states.front()->executor, states.size());
+  Future<result_type> result = aggregate->promise.GetFuture();
+  if (states.empty()) {
+    aggregate->promise.SetValue();
+    return result;
+  }
+
+  for (size_t i = 0; i < states.size(); ++i) {
+    detail::FutureState<T>* const raw = states[i].get();
+    raw->SetContinuation(nullptr, Task([aggregate, state = std::move(states[i]), i]() {
+      if (state->exception != nullptr) {
+        if (!aggregate->failed.exchange(true)) {
+          aggregate->exception = state->exception;
+        }
+      } else {
+        aggregate->values[i] = std::move(state->value);
+      }
+      if (aggregate->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+      }
+      if (aggregate->exception != nullptr) {
+        aggregate->promise.SetException(aggregate->exception);
+      } else if constexpr (std::is_void<T>::value) {
+        aggregate->promise.SetValue();
+      } else {
+        std::vector<T> values;
+        values.reserve(aggregate->values.size());
+        for (auto& value : aggregate->values) {
+          values.push_back(std::move(*value));
+        }
+        aggregate->promise.SetValue(std::move(values));
+      }
+    }));
+  }
+  return result;
+}
+
+/**
+ * @brief Future completing when the first input completes
+ * @param futures Input futures (consumed; must not be empty)
+ * @return Future of the first input's index and value, or of its exception if it failed
+ * @throws std::invalid_argument if futures is empty
+ * @throws std::future_error (no_state) if an input is not valid
+ *
+ * The other inputs still run to completion; their results are discarded.
+ */
+template <typename T>
+Future<WhenAnyResult<T>> WhenAny(std::vector<Future<T>> futures) {
+  if (futures.empty()) {
+    throw std::invalid_argument("WhenAny needs at least one future");
+  }
+  std::vector<std::shared_ptr<detail::FutureState<T>>> states;
+  states.reserve(futures.size());
+  for (Future<T>& future : futures) {
+    states.push_back(detail::FutureAccess::Take(future));
+  }
+
+  struct Race {
+    explicit Race(std::shared_ptr<detail::PoolAnchor> executor) {
+      detail::FutureAccess::SetExecutor(promise, std::move(executor));
+    }
+
+    Promise<WhenAnyResult<T>> promise;
+    std::atomic<bool> decided{false};
+  };
+  auto race = std::make_shared<Race>(states.front()->executor);
+  Future<WhenAnyResult<T>> result = race->promise.GetFuture();
+
+  for (size_t i = 0; i < states.size(); ++i) {
+    detail::FutureState<T>* const raw = states[i].get();
+    raw->SetContinuation(nullptr, Task([race, state = std::move(states[i]), i]() {
+      if (race->decided.exchange(true)) {
+        return;
+      }
+      if (state->exception != nullptr) {
+        race->promise.SetException(state->exception);
+      } else if constexpr (std::is_void<T>::value) {
+        race->promise.SetValue(WhenAnyResult<T>{i});
+      } else {
+        race->promise.SetValue(WhenAnyResult<T>{i, std::move(*state->value)});
+      }
+    }));
+  }
+  return result;
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_FUTURE_H_
@@ -0,0 +1,186 @@
+#ifndef CALLBACK_WORKER_THREAD_METRICS_H_
+#define CALLBACK_WORKER_THREAD_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace callback_worker_thread {
+
+/**
+ * @brief Bucket layout of LatencyHistogram
+ *
+ * HDR-style log-linear buckets: values below kSubBuckets get one bucket each, and every
+ * power-of-two range above is split into kSubBuckets equal sub-buckets, so a bucket's width
+ * is at most 1/kSubBuckets of its lower bound. 252 buckets cover the full uint64_t range.
+ */
+struct HistogramBuckets {
+  /// Sub-buckets per power of two (relative bucket width at most 25%)
+  static constexpr size_t kSubBucketBits = 2;
+  static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+  /// Total number of buckets
+  static constexpr size_t kCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  /// @return Index of the bucket holding value
+  static constexpr size_t Index(uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    size_t msb = 63;
+    while ((value >> msb) == 0) {
+      --msb;
+    }
+    const size_t shift = msb - kSubBucketBits;
+    const auto sub = static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+    return (shift + 1) * kSubBuckets + sub;
+  }
+
+  /// @return Smallest value that falls into bucket index
+  static constexpr uint64_t LowerBound(size_t index) {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const size_t shift = index / kSubBuckets - 1;
+    return (kSubBuckets + index % kSubBuckets) << shift;
+  }
+
+  /// @return Largest value that falls into bucket index
+  static constexpr uint64_t UpperBound(size_t index) {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const size_t shift = index / kSubBuckets - 1;
+    return LowerBound(index) + ((uint64_t{1} << shift) - 1);
+  }
+};
+
+/**
+ * @brief Merged histogram returned in a metrics snapshot (values in nanoseconds)
+ */
+struct HistogramSnapshot {
+  /// Per-bucket sample counts (see HistogramBuckets)
+  std::array<uint64_t, HistogramBuckets::kCount> buckets{};
+  /// Number of samples
+  uint64_t count = 0;
+  /// Sum of all samples
+  uint64_t sum = 0;
+  /// Largest sample
+  uint64_t max = 0;
+
+  /// @return Mean sample, or 0 if empty
+  double Mean() const { return count == 0 ? 0.0 : static_cast<double>(sum) / count; }
+
+  /**
+   * @brief Estimate a percentile
+   * @param quantile Quantile in [0, 1] (e.g. 0.99)
+   * @return Upper bound of the bucket holding the quantile (capped at max), or 0 if empty
+   */
+  uint64_t Percentile(double quantile) const;
+};
+
+/**
+ * @brief Log-bucketed histogram with a single writer
+ *
+ * Record is wait-free and uses only relaxed loads and stores, so it must only be called by
+ * one thread (the owning worker). MergeInto may run concurrently from any thread and sees a
+ * slightly stale but never torn view.
+ */
+class LatencyHistogram {
+ public:
+  /// Record one sample (owner thread only)
+  void Record(uint64_t value) noexcept {
+    Increment(buckets_[HistogramBuckets::Index(value)], 1);
+    Increment(count_, 1);
+    Increment(sum_, value);
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /// Add this histogram's samples to snapshot (any thread)
+  void MergeInto(HistogramSnapshot& snapshot) const noexcept;
+
+ private:
+  static void Increment(std::atomic<uint64_t>& counter, uint64_t delta) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, HistogramBuckets::kCount> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+/// Counters of one worker thread in a metrics snapshot
+struct WorkerMetrics {
+  uint64_t tasks_executed = 0;  ///< Tasks run to completion (including ones that threw)
+  uint64_t exceptions = 0;      ///< Exceptions escaping posted tasks
+  uint64_t busy_ns = 0;         ///< Time spent running tasks
+  uint64_t idle_ns = 0;         ///< Time spent waiting for tasks
+};
+
+/**
+ * @brief Point-in-time view of a pool's metrics (see CallbackWorkerThread::GetMetrics)
+ *
+ * Per-worker values are read without stopping the workers, so totals may be off by the tasks
+ * running at the time of the snapshot.
+ */
+struct MetricsSnapshot {
+  /// Whether collection was enabled when the snapshot was taken
+  bool enabled = false;
+  /// Per-worker counters, indexed by worker slot (max_thread_count slots for an elastic pool)
+  std::vector<WorkerMetrics> workers;
+  /// Sum of the per-worker counters
+  WorkerMetrics total;
+  /// Time from submission to the start of execution
+  HistogramSnapshot queue_wait;
+  /// Time spent executing
+  HistogramSnapshot execution;
+  /// Tasks queued at the time of the snapshot
+  size_t queue_size = 0;
+};
+
+// Non-template member implementation
+inline uint64_t HistogramSnapshot::Percentile(double quantile) const {
+  if (count == 0) {
+    return 0;
+  }
+  if (quantile < 0.0) {
+    quantile = 0.0;
+  } else if (quantile > 1.0) {
+    quantile = 1.0;
+  }
+
+  // Rank of the requested sample (1-based), then the bucket containing it
+  auto rank = static_cast<uint64_t>(quantile * static_cast<double>(count) + 0.5);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      const uint64_t upper = HistogramBuckets::UpperBound(i);
+      return upper < max ? upper : max;
+    }
+  }
+  return max;
+}
+
+inline void LatencyHistogram::MergeInto(HistogramSnapshot& snapshot) const noexcept {
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    snapshot.buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count += count_.load(std::memory_order_relaxed);
+  snapshot.sum += sum_.load(std::memory_order_relaxed);
+  const uint64_t max = max_.load(std::memory_order_relaxed);
+  if (max > snapshot.max) {
+    snapshot.max = max;
+  }
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_METRICS_H_
@@ -0,0 +1,169 @@
+#ifndef CALLBACK_WORKER_THREAD_MPMC_QUEUE_H_
+#define CALLBACK_WORKER_THREAD_MPMC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace callback_worker_thread {
+
+/// Assumed cache line size used to keep hot atomics on separate lines
+inline constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief Bounded lock-free multi-producer/multi-consumer queue
+ *
+ * Ring buffer in which every cell carries a sequence number that tells producers and consumers
+ * whether the cell is free or holds a value for the current lap (D. Vyukov's bounded MPMC
+ * queue). Push and pop each cost one CAS on the shared position plus one store on the cell,
+ * and producers never touch the consumer position (and vice versa).
+ *
+ * Thread safety: TryPush and TryPop may be called concurrently from any number of threads.
+ *
+ * @tparam T Element type (must be move constructible)
+ */
+template <typename T>
+class MpmcQueue {
+ public:
+  /**
+   * @brief Constructor
+   * @param capacity Maximum number of elements (rounded up to a power of two, at least 2)
+   * @throws std::invalid_argument if capacity is 0
+   */
+  explicit MpmcQueue(size_t capacity);
+
+  /**
+   * @brief Destructor
+   *
+   * Destroys any elements still in the queue. Must not race with TryPush or TryPop.
+   */
+  ~MpmcQueue();
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  /**
+   * @brief Push an element if there is room
+   * @param value Element to move into the queue (left untouched on failure)
+   * @return true if pushed, false if the queue was full
+   */
+  bool TryPush(T&& value);
+
+  /**
+   * @brief Pop the oldest element if there is one
+   * @param value Destination for the popped element
+   * @return true if an element was popped, false if the queue was empty
+   */
+  bool TryPop(T& value);
+
+  /**
+   * @brief Get capacity
+   * @return Maximum number of elements the queue can hold
+   */
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  T* ValuePtr(Cell& cell) { return std::launder(reinterpret_cast<T*>(&cell.storage)); }
+
+  std::unique_ptr<Cell[]> buffer_;
+  size_t mask_;
+  alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_;
+  alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_;
+};
+
+// Template function implementation
+template <typename T>
+MpmcQueue<T>::MpmcQueue(size_t capacity) : enqueue_pos_(0), dequeue_pos_(0) {
+  if (capacity == 0) {
+    throw std::invalid_argument("Queue capacity must be greater than 0");
+  }
+
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    rounded <<= 1;
+  }
+
+  buffer_.reset(new Cell[rounded]);
+  mask_ = rounded - 1;
+  for (size_t i = 0; i < rounded; ++i) {
+    buffer_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+MpmcQueue<T>::~MpmcQueue() {
+  T value;
+  while (TryPop(value)) {
+  }
+}
+
+template <typename T>
+bool MpmcQueue<T>::TryPush(T&& value) {
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Cell* cell;
+
+  while (true) {
+    cell = &buffer_[pos & mask_];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+    if (diff == 0) {
+      // Cell is free for this lap; claim it
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // Cell still holds the value from the previous lap: queue is full
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  new (&cell->storage) T(std::move(value));
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool MpmcQueue<T>::TryPop(T& value) {
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  Cell* cell;
+
+  while (true) {
+    cell = &buffer_[pos & mask_];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+    if (diff == 0) {
+      // Cell holds a value for this lap; claim it
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // Producer has not filled this cell yet: queue is empty
+      return false;
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  T* stored = ValuePtr(*cell);
+  value = std::move(*stored);
+  stored->~T();
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_MPMC_QUEUE_H_
@@ -0,0 +1,174 @@
+#ifndef CALLBACK_WORKER_THREAD_PARALLEL_H_
+#define CALLBACK_WORKER_THREAD_PARALLEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+
+namespace callback_worker_thread {
+
+namespace detail {
+
+/// Type-erased loop body: invoke(context, begin, end) processes offsets [begin, end)
+struct RangeBody {
+  void (*invoke)(void* context, size_t begin, size_t end);
+  void* context;
+};
+
+template <typename F>
+RangeBody MakeRangeBody(F& f) {
+  return RangeBody{[](void* context, size_t begin, size_t end) {
+                     (*static_cast<F*>(context))(begin, end);
+                   },
+                   &f};
+}
+
+/**
+ * @brief Run body over [0, count) on the pool and the calling thread (defined in parallel.cpp)
+ * @param pool Thread pool
+ * @param count Number of offsets
+ * @param grain Largest range run without splitting, or 0 to size it from the pool
+ * @param body Loop body
+ * @throws The first exception thrown by body
+ */
+void ParallelRange(CallbackWorkerThread& pool, size_t count, size_t grain, RangeBody body);
+
+/// Number of indices in [begin, end), computed unsigned so that the full signed range fits
+template <typename Index>
+size_t RangeLength(Index begin, Index end) {
+  using Unsigned = std::make_unsigned_t<Index>;
+  // Cast back before widening: narrow types are promoted to int for the subtraction
+  return static_cast<size_t>(
+      static_cast<Unsigned>(static_cast<Unsigned>(end) - static_cast<Unsigned>(begin)));
+}
+
+/// Index at offset from begin, formed in unsigned arithmetic like RangeLength
+template <typename Index>
+Index IndexAt(Index begin, size_t offset) {
+  using Unsigned = std::make_unsigned_t<Index>;
+  return static_cast<Index>(static_cast<Unsigned>(begin) + static_cast<Unsigned>(offset));
+}
+
+}  // namespace detail
+
+/**
+ * @brief Call body(i) for every i in [begin, end), in parallel on a pool
+ * @param pool Thread pool
+ * @param begin First index
+ * @param end One past the last index
+ * @param body Function taking an index
+ * @param grain Indices run as one chunk without further splitting; 0 (default) picks about
+ *        eight chunks per thread so that irregular iterations still balance
+ * @throws The first exception thrown by body (chunks not started yet are skipped)
+ *
+ * The range is split recursively in halves: each split submits the upper half as a task and
+ * keeps the lower half, so the caller starts working at once. When it runs out of work it
+ * takes back its own halves that no worker has picked up yet, and only waits for chunks that
+ * are already running. Calling ParallelFor from a worker of the same pool (nested loops) is
+ * therefore safe even with a single worker. Split tasks bypass the bounded queue; on a
+ * stopped pool the loop runs on the calling thread.
+ */
+template <typename Index, typename F>
+void ParallelFor(CallbackWorkerThread& pool, Index begin, Index end, F&& body,
+                 size_t grain = 0) {
+  static_assert(std::is_integral<Index>::value, "ParallelFor needs an integral index");
+  if (!(begin < end)) {
+    return;
+  }
+  auto run = [begin, &body](size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      body(detail::IndexAt(begin, i));
+    }
+  };
+  detail::ParallelRange(pool, detail::RangeLength(begin, end), grain,
+                        detail::MakeRangeBody(run));
+}
+
+/**
+ * @brief Map every index in [begin, end) and combine the results, in parallel on a pool
+ * @param pool Thread pool
+ * @param begin First index
+ * @param end One past the last index
+ * @param identity Identity element of reduce (the result for an empty range)
+ * @param map Function taking an index and returning a T
+ * @param reduce Associative function combining two T values
+ * @param grain As for ParallelFor
+ * @return reduce over map(begin) ... map(end - 1), combined in index order
+ * @throws The first exception thrown by map or reduce
+ *
+ * Each chunk folds its own partial result; partials are then combined in index order, so
+ * reduce needs to be associative but not commutative.
+ */
+template <typename Index, typename T, typename Map, typename Reduce>
+T ParallelReduce(CallbackWorkerThread& pool, Index begin, Index end, T identity, Map&& map,
+                 Reduce&& reduce, size_t grain = 0) {
+  static_assert(std::is_integral<Index>::value, "ParallelReduce needs an integral index");
+  if (!(begin < end)) {
+    return identity;
+  }
+  std::mutex mutex;
+  std::vector<std::pair<size_t, T>> partials;
+  auto run = [&](size_t first, size_t last) {
+    T partial = identity;
+    for (size_t i = first; i < last; ++i) {
+      partial = reduce(std::move(partial), map(detail::IndexAt(begin, i)));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    partials.emplace_back(first, std::move(partial));
+  };
+  detail::ParallelRange(pool, detail::RangeLength(begin, end), grain,
+                        detail::MakeRangeBody(run));
+
+  std::sort(partials.begin(), partials.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  T result = std::move(identity);
+  for (auto& partial : partials) {
+    result = reduce(std::move(result), std::move(partial.second));
+  }
+  return result;
+}
+
+/**
+ * @brief Parallel std::transform over random-access iterators
+ * @param pool Thread pool
+ * @param first Beginning of the input
+ * @param last End of the input
+ * @param out Beginning of the output (may equal first)
+ * @param op Function mapping an input element to an output element
+ * @param grain As for ParallelFor
+ * @return Iterator past the last element written
+ * @throws The first exception thrown by op
+ */
+template <typename InputIt, typename OutputIt, typename F>
+OutputIt ParallelTransform(CallbackWorkerThread& pool, InputIt first, InputIt last,
+                           OutputIt out, F&& op, size_t grain = 0) {
+  static_assert(
+      std::is_base_of<std::random_access_iterator_tag,
+                      typename std::iterator_traits<InputIt>::iterator_category>::value &&
+          std::is_base_of<std::random_access_iterator_tag,
+                          typename std::iterator_traits<OutputIt>::iterator_category>::value,
+      "ParallelTransform needs random-access iterators");
+  const auto count = static_cast<size_t>(std::distance(first, last));
+  if (count == 0) {
+    return out;
+  }
+  auto run = [first, out, &op](size_t begin, size_t end) {
+    using InputDiff = typename std::iterator_traits<InputIt>::difference_type;
+    using OutputDiff = typename std::iterator_traits<OutputIt>::difference_type;
+    for (size_t i = begin; i < end; ++i) {
+      out[static_cast<OutputDiff>(i)] = op(first[static_cast<InputDiff>(i)]);
+    }
+  };
+  detail::ParallelRange(pool, count, grain, detail::MakeRangeBody(run));
+  return out + static_cast<typename std::iterator_traits<OutputIt>::difference_type>(count);
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_PARALLEL_H_
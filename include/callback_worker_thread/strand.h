@@ -0,0 +1,201 @@
+#ifndef CALLBACK_WORKER_THREAD_STRAND_H_
+#define CALLBACK_WORKER_THREAD_STRAND_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+#include "callback_worker_thread/task.h"
+
+namespace callback_worker_thread {
+
+namespace detail {
+
+/// Queue and scheduling state of a strand (defined in the source file)
+struct StrandState;
+
+}  // namespace detail
+
+/**
+ * @brief Serial executor layered over a CallbackWorkerThread
+ *
+ * Tasks posted to one strand run one at a time, in submission order, on whichever pool
+ * worker is free; different strands run in parallel. No thread is dedicated to a strand: a
+ * strand with work has exactly one drain task in the pool, which runs the tasks queued so far
+ * and re-posts itself if more arrived, so other strands get their turn in between.
+ *
+ * Submitting costs one uncontended mutex acquisition and, when the strand was idle, one pool
+ * submission. Queued tasks are kept in reused vectors, so a busy strand does not allocate per
+ * task beyond the task's own captures. Strand queues are unbounded: the drain task bypasses
+ * CallbackWorkerThreadOptions::max_queue_size.
+ *
+ * Copies refer to the same strand. Tasks still queued when the last copy is destroyed run
+ * normally. The pool must outlive every strand with queued tasks; once it is stopped,
+ * submission throws std::runtime_error and tasks that cannot be scheduled are discarded.
+ *
+ * Thread safety: all members may be called concurrently.
+ */
+class Strand {
+ public:
+  /**
+   * @brief Constructor
+   * @param pool Thread pool that runs the strand's tasks
+   */
+  explicit Strand(CallbackWorkerThread& pool);
+
+  /**
+   * @brief Enqueue generic callback function
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future for retrieving execution result
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  auto Enqueue(F&& f, Args&&... args)
+      -> std::future<typename std::invoke_result<F, Args...>::type>;
+
+  /**
+   * @brief Post generic callback function (fire-and-forget)
+   * @tparam F Function type
+   * @tparam Args Argument types
+   * @param f Function to execute (its return value is discarded)
+   * @param args Function arguments
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * Exceptions thrown by the callable are passed to the pool's exception handler.
+   */
+  template<typename F, typename... Args>
+  void Post(F&& f, Args&&... args);
+
+  /// @return true if called from a task running on this strand
+  bool RunningInThisThread() const;
+
+ private:
+  // Queue a task and schedule the drain task if the strand was idle
+  void Submit(Task&& task);
+
+  // Drain task: runs the tasks queued so far in the pool, then re-posts itself if more arrived
+  static void Drain(const std::shared_ptr<detail::StrandState>& state);
+
+  std::shared_ptr<detail::StrandState> state_;
+};
+
+/**
+ * @brief Maps keys to a fixed set of strands
+ * @tparam Key Key type (e.g. a connection id)
+ * @tparam Hash Hash function for Key
+ *
+ * Tasks with the same key always go to the same strand, so they run in submission order and
+ * never overlap; different keys usually run in parallel. Keys that hash to the same strand
+ * are serialized with each other, so use a few times more strands than workers.
+ *
+ * Thread safety: all members may be called concurrently.
+ */
+template <typename Key, typename Hash = std::hash<Key>>
+class KeyedStrandDispatcher {
+ public:
+  /**
+   * @brief Constructor
+   * @param pool Thread pool that runs the tasks
+   * @param strand_count Number of strands (1 or more)
+   * @param hash Hash function
+   * @throws std::invalid_argument if strand_count is 0
+   */
+  KeyedStrandDispatcher(CallbackWorkerThread& pool, size_t strand_count, Hash hash = Hash())
+      : hash_(std::move(hash)) {
+    if (strand_count == 0) {
+      throw std::invalid_argument("Strand count must be greater than 0");
+    }
+    strands_.reserve(strand_count);
+    for (size_t i = 0; i < strand_count; ++i) {
+      strands_.emplace_back(pool);
+    }
+  }
+
+  /**
+   * @brief Get the strand serving a key
+   * @param key Key
+   * @return Strand (valid while the dispatcher lives)
+   */
+  Strand& StrandFor(const Key& key) {
+    // std::hash of integers is often the identity; mix so that strided keys spread out
+    uint64_t h = static_cast<uint64_t>(hash_(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return strands_[static_cast<size_t>(h % strands_.size())];
+  }
+
+  /**
+   * @brief Enqueue generic callback function on the key's strand
+   * @param key Key
+   * @param f Function to execute
+   * @param args Function arguments
+   * @return Future for retrieving execution result
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  auto Enqueue(const Key& key, F&& f, Args&&... args)
+      -> std::future<typename std::invoke_result<F, Args...>::type> {
+    return StrandFor(key).Enqueue(std::forward<F>(f), std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Post generic callback function on the key's strand (fire-and-forget)
+   * @param key Key
+   * @param f Function to execute (its return value is discarded)
+   * @param args Function arguments
+   * @throws std::runtime_error if the thread pool is stopped
+   */
+  template<typename F, typename... Args>
+  void Post(const Key& key, F&& f, Args&&... args) {
+    StrandFor(key).Post(std::forward<F>(f), std::forward<Args>(args)...);
+  }
+
+  /// @return Number of strands
+  size_t strand_count() const { return strands_.size(); }
+
+ private:
+  Hash hash_;
+  std::vector<Strand> strands_;
+};
+
+// Template function implementation
+template<typename F, typename... Args>
+auto Strand::Enqueue(F&& f, Args&&... args)
+    -> std::future<typename std::invoke_result<F, Args...>::type> {
+  using return_type = typename std::invoke_result<F, Args...>::type;
+
+  auto promise = detail::MakeTaskPromise<return_type>();
+  std::future<return_type> res = promise.get_future();
+  Submit([promise = std::move(promise), func = std::forward<F>(f),
+          bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    detail::FulfillPromise(promise, [&]() { return std::apply(func, bound_args); });
+  });
+  return res;
+}
+
+template<typename F, typename... Args>
+void Strand::Post(F&& f, Args&&... args) {
+  if constexpr (sizeof...(Args) == 0) {
+    Submit(Task(std::forward<F>(f)));
+  } else {
+    Submit([func = std::forward<F>(f),
+            bound_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+      std::apply(func, bound_args);
+    });
+  }
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_STRAND_H_
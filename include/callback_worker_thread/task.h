@@ -0,0 +1,184 @@
+#ifndef CALLBACK_WORKER_THREAD_TASK_H_
+#define CALLBACK_WORKER_THREAD_TASK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "callback_worker_thread/task_allocator.h"
+
+namespace callback_worker_thread {
+
+/**
+ * @brief Move-only type-erased task (callable with signature void())
+ *
+ * Unlike std::function, Task accepts move-only callables and stores callables of up to
+ * kInlineSize bytes inside the object itself, so queueing a small lambda does not touch the
+ * heap. Larger callables (or ones whose move constructor may throw) are placed in a block of
+ * the task allocator (see GetTaskAllocatorStats), so they do not reach malloc either once the
+ * thread's slabs are warm.
+ *
+ * Thread safety: a Task object must not be accessed concurrently.
+ */
+class Task {
+ public:
+  /// Size of the inline buffer for small callables
+  static constexpr size_t kInlineSize = 64;
+
+  /// Construct an empty task
+  Task() noexcept : vtable_(nullptr), timestamp_(0) {}
+
+  /**
+   * @brief Construct from a callable
+   * @tparam F Callable type invocable as void()
+   * @param f Callable to store (moved or copied in)
+   * @throws std::bad_alloc if a large callable cannot be allocated
+   */
+  template <typename F,
+            typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Task>::value>>
+  Task(F&& f);  // NOLINT(google-explicit-constructor)
+
+  Task(Task&& other) noexcept;
+  Task& operator=(Task&& other) noexcept;
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() { Reset(); }
+
+  /**
+   * @brief Invoke the stored callable
+   *
+   * Exceptions thrown by the callable propagate to the caller. Must not be called on an
+   * empty task.
+   */
+  void operator()() { vtable_->invoke(storage_); }
+
+  /// @return true if the task holds a callable
+  explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+  /**
+   * @brief Opaque timestamp carried along with the callable
+   *
+   * Occupies what would otherwise be padding, so it does not grow the object. The owning queue
+   * decides what it means (CallbackWorkerThread stores the submission time when metrics are
+   * enabled); 0 means unset.
+   */
+  uint64_t timestamp() const noexcept { return timestamp_; }
+  void set_timestamp(uint64_t timestamp) noexcept { timestamp_ = timestamp; }
+
+  /**
+   * @brief Whether a callable of type F would be stored without a heap allocation
+   * @tparam F Callable type
+   */
+  template <typename F>
+  static constexpr bool IsStoredInline() {
+    return sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible<F>::value;
+  }
+
+ private:
+  struct VTable {
+    void (*invoke)(void* storage);
+    // Move-construct into dst from src and destroy src
+    void (*relocate)(void* dst, void* src) noexcept;
+    void (*destroy)(void* storage) noexcept;
+  };
+
+  template <typename F>
+  struct InlineOps {
+    static F* Get(void* storage) { return std::launder(reinterpret_cast<F*>(storage)); }
+    static void Invoke(void* storage) { (*Get(storage))(); }
+    static void Relocate(void* dst, void* src) noexcept {
+      new (dst) F(std::move(*Get(src)));
+      Get(src)->~F();
+    }
+    static void Destroy(void* storage) noexcept { Get(storage)->~F(); }
+    static constexpr VTable kVTable = {&Invoke, &Relocate, &Destroy};
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F*& Get(void* storage) { return *std::launder(reinterpret_cast<F**>(storage)); }
+    static void Invoke(void* storage) { (*Get(storage))(); }
+    static void Relocate(void* dst, void* src) noexcept { new (dst) F*(Get(src)); }
+    static void Destroy(void* storage) noexcept {
+      F* callable = Get(storage);
+      callable->~F();
+      Deallocate(callable);
+    }
+    static constexpr VTable kVTable = {&Invoke, &Relocate, &Destroy};
+
+    static void* Allocate() {
+      if constexpr (alignof(F) <= alignof(std::max_align_t)) {
+        return detail::TaskAllocate(sizeof(F));
+      } else {
+        return ::operator new(sizeof(F), std::align_val_t(alignof(F)));
+      }
+    }
+    static void Deallocate(void* block) noexcept {
+      if constexpr (alignof(F) <= alignof(std::max_align_t)) {
+        detail::TaskDeallocate(block);
+      } else {
+        ::operator delete(block, std::align_val_t(alignof(F)));
+      }
+    }
+  };
+
+  void Reset() noexcept {
+    if (vtable_ != nullptr) {
+      vtable_->destroy(storage_);
+      vtable_ = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+  const VTable* vtable_;
+  uint64_t timestamp_;
+};
+
+// Template function implementation
+template <typename F, typename>
+Task::Task(F&& f) : timestamp_(0) {
+  using Callable = std::decay_t<F>;
+  if constexpr (IsStoredInline<Callable>()) {
+    new (storage_) Callable(std::forward<F>(f));
+    vtable_ = &InlineOps<Callable>::kVTable;
+  } else {
+    void* block = HeapOps<Callable>::Allocate();
+    try {
+      new (storage_) Callable*(::new (block) Callable(std::forward<F>(f)));
+    } catch (...) {
+      HeapOps<Callable>::Deallocate(block);
+      throw;
+    }
+    vtable_ = &HeapOps<Callable>::kVTable;
+  }
+}
+
+inline Task::Task(Task&& other) noexcept
+    : vtable_(other.vtable_), timestamp_(other.timestamp_) {
+  if (vtable_ != nullptr) {
+    vtable_->relocate(storage_, other.storage_);
+    other.vtable_ = nullptr;
+  }
+}
+
+inline Task& Task::operator=(Task&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    timestamp_ = other.timestamp_;
+    if (other.vtable_ != nullptr) {
+      other.vtable_->relocate(storage_, other.storage_);
+      vtable_ = other.vtable_;
+      other.vtable_ = nullptr;
+    }
+  }
+  return *this;
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_TASK_H_
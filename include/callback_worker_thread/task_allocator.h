@@ -0,0 +1,126 @@
+#ifndef CALLBACK_WORKER_THREAD_TASK_ALLOCATOR_H_
+#define CALLBACK_WORKER_THREAD_TASK_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace callback_worker_thread {
+
+/**
+ * @brief Counters of the task allocator (see GetTaskAllocatorStats)
+ *
+ * Only the paths that reach the system allocator or cross threads are counted, so the fast
+ * path stays free of shared writes. In a steady state slab_allocations and large_allocations
+ * stop growing: every block is recycled from the per-thread caches.
+ */
+struct TaskAllocatorStats {
+  /// Slabs obtained from the system allocator since start
+  uint64_t slab_allocations = 0;
+  /// Blocks served by operator new since start: requests above kMaxTaskBlockSize, and requests
+  /// made while a thread is shutting down
+  uint64_t large_allocations = 0;
+  /// Remote-free lists handed back to their owning thread since start
+  uint64_t remote_free_batches = 0;
+  /// Bytes currently held in slabs (free or in use). Slabs are released only once their thread
+  /// has exited and all their blocks are freed, so this tracks each thread's peak usage
+  size_t reserved_bytes = 0;
+  /// Per-thread caches alive, including those of exited threads whose blocks are still in use
+  size_t thread_caches = 0;
+};
+
+/// Largest request served from a slab; larger ones go to operator new
+inline constexpr size_t kMaxTaskBlockSize = 1008;
+
+/**
+ * @brief Snapshot the task allocator counters
+ * @return Counters summed over all threads (all zero if built without the allocator)
+ */
+TaskAllocatorStats GetTaskAllocatorStats();
+
+namespace detail {
+
+#if defined(CALLBACK_WORKER_THREAD_NO_TASK_ALLOCATOR)
+
+inline void* TaskAllocate(size_t size) { return ::operator new(size); }
+inline void TaskDeallocate(void* block) noexcept { ::operator delete(block); }
+
+#else
+
+/**
+ * @brief Allocate a block for task state (defined in task_allocator.cpp)
+ * @param size Size in bytes
+ * @return Block aligned to alignof(std::max_align_t)
+ * @throws std::bad_alloc on failure
+ *
+ * Blocks come from size-class slabs owned by the calling thread, so allocating takes no lock
+ * and touches no shared cache line. A block may be freed on any thread: a foreign thread
+ * pushes it onto the owner's remote-free list, which the owner takes back in one batch the
+ * next time its local free list runs dry. Only the owner counts the blocks in use; it
+ * publishes the count when the thread exits, and the cache outlives its thread until every
+ * block handed out from it has been freed. Slabs are not trimmed while their thread runs: a
+ * burst leaves its free blocks cached for reuse rather than returning them to the system.
+ */
+void* TaskAllocate(size_t size);
+
+/**
+ * @brief Free a block returned by TaskAllocate, on any thread
+ * @param block Block to free (nullptr is ignored)
+ */
+void TaskDeallocate(void* block) noexcept;
+
+#endif
+
+/// @return Whether objects of type T (or void) fit the alignment of task allocator blocks
+template <typename T>
+constexpr bool IsTaskAllocatable() {
+  if constexpr (std::is_void<T>::value) {
+    return true;
+  } else {
+    return alignof(T) <= alignof(std::max_align_t);
+  }
+}
+
+/**
+ * @brief Stateless standard allocator over TaskAllocate/TaskDeallocate
+ *
+ * Lets library types such as std::promise and std::allocate_shared put their shared state in
+ * the task allocator.
+ */
+template <typename T>
+class TaskAllocator {
+ public:
+  using value_type = T;
+
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "TaskAllocator does not support over-aligned types");
+
+  TaskAllocator() noexcept = default;
+  template <typename U>
+  TaskAllocator(const TaskAllocator<U>&) noexcept {}  // NOLINT(google-explicit-constructor)
+
+  T* allocate(size_t count) {
+    if (count > static_cast<size_t>(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(TaskAllocate(count * sizeof(T)));
+  }
+
+  void deallocate(T* block, size_t) noexcept { TaskDeallocate(block); }
+
+  template <typename U>
+  bool operator==(const TaskAllocator<U>&) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const TaskAllocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+}  // namespace detail
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_TASK_ALLOCATOR_H_
@@ -0,0 +1,102 @@
+#ifndef CALLBACK_WORKER_THREAD_TASK_GRAPH_H_
+#define CALLBACK_WORKER_THREAD_TASK_GRAPH_H_
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+
+namespace callback_worker_thread {
+
+/**
+ * @brief Directed acyclic graph of tasks, run on a CallbackWorkerThread
+ *
+ * Declare nodes with Emplace() and dependencies with Precede(), then Run() the graph. A node
+ * becomes runnable when all of its predecessors have finished: each run keeps an atomic
+ * counter of unfinished predecessors per node, and the worker that finishes a node releases
+ * its successors. One released successor continues on the same worker without going through
+ * the queue; the others are submitted as one batch. No worker ever blocks waiting for another
+ * node, so graphs of any depth run on a pool of any size.
+ *
+ * The graph is reusable: every Run() starts from the declared structure, and several runs may
+ * be in progress at once (node functions then run concurrently with themselves). The graph
+ * must outlive its runs and must not be modified while a run is in progress.
+ *
+ * Thread safety: not thread-safe; call Emplace(), Precede() and Run() from one thread at a time
+ * (the runs themselves proceed concurrently).
+ */
+class TaskGraph {
+ public:
+  /// Node identifier returned by Emplace()
+  using NodeId = size_t;
+
+  TaskGraph() = default;
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  /**
+   * @brief Add a node
+   * @param work Function run once per Run() (its return value is discarded)
+   * @return Identifier of the new node
+   */
+  template<typename F>
+  NodeId Emplace(F&& work) {
+    nodes_.push_back(Node{std::function<void()>(std::forward<F>(work)), {}, 0});
+    validated_ = false;
+    return nodes_.size() - 1;
+  }
+
+  /**
+   * @brief Add a dependency: after starts only when before has finished
+   * @param before Predecessor node
+   * @param after Successor node
+   * @throws std::out_of_range if either node does not exist
+   * @throws std::invalid_argument if before == after
+   */
+  void Precede(NodeId before, NodeId after);
+
+  /**
+   * @brief Run the graph
+   * @param pool Thread pool running the nodes
+   * @return Future that becomes ready when every node has finished. If a node throws, nodes
+   *         not started yet are skipped and the future holds the first exception.
+   * @throws std::invalid_argument if the graph has a cycle
+   * @throws std::runtime_error if the thread pool is stopped
+   *
+   * The source nodes are submitted as one batch (subject to the pool's bounded queue policy);
+   * nodes released later bypass the bound, since the run was already admitted. Waiting on the
+   * future from a worker of the same pool blocks that worker; chain work as graph nodes
+   * instead.
+   */
+  std::future<void> Run(CallbackWorkerThread& pool);
+
+  /// @return Number of nodes
+  size_t size() const { return nodes_.size(); }
+
+  /// @return true if the graph has no node
+  bool empty() const { return nodes_.empty(); }
+
+ private:
+  friend struct detail::GraphRun;
+
+  struct Node {
+    std::function<void()> work;
+    std::vector<NodeId> successors;
+    size_t predecessor_count;
+  };
+
+  // Throw std::invalid_argument if the graph has a cycle (cached until the graph changes)
+  void Validate();
+
+  std::vector<Node> nodes_;
+  std::vector<NodeId> sources_;
+  bool validated_ = false;
+};
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_TASK_GRAPH_H_
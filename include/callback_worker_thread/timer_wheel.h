@@ -0,0 +1,256 @@
+#ifndef CALLBACK_WORKER_THREAD_TIMER_WHEEL_H_
+#define CALLBACK_WORKER_THREAD_TIMER_WHEEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace callback_worker_thread {
+
+/**
+ * @brief Hierarchical timing wheel (Varghese & Lauck)
+ *
+ * kLevels wheels of kSlots slots each: level l holds entries expiring between kSlots^l and
+ * kSlots^(l+1) ticks from now, and its slots are cascaded into the lower levels as time
+ * reaches them. Insert and Remove are O(1); Advance costs O(1) per expired or cascaded entry
+ * plus O(kLevels) per visited slot, and skips empty slots using per-level occupancy bitmaps,
+ * so long idle periods cost nothing. Entries further out than kSlots^kLevels ticks (about 2^36)
+ * are parked in the farthest slot and re-cascaded until they are in range.
+ *
+ * The wheel does not own its entries: callers embed Entry in their own objects and keep them
+ * alive while they are linked.
+ *
+ * Thread safety: not thread-safe; callers serialize all access.
+ */
+class TimerWheel {
+ public:
+  static constexpr size_t kSlotBits = 6;
+  static constexpr size_t kSlots = size_t{1} << kSlotBits;
+  static constexpr size_t kLevels = 6;
+  /// Returned by NextEventTick when the wheel is empty
+  static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+  /// Intrusive list node; embed in (or derive from) the timer object
+  struct Entry {
+    Entry* prev = nullptr;
+    Entry* next = nullptr;
+    uint64_t expiry = 0;
+    uint8_t level = 0;
+    uint8_t slot = 0;
+    bool linked = false;
+  };
+
+  /**
+   * @brief Constructor
+   * @param start_tick Current time in ticks
+   */
+  explicit TimerWheel(uint64_t start_tick) : current_(start_tick) {}
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /**
+   * @brief Link an entry (O(1))
+   * @param entry Unlinked entry
+   * @param expiry_tick Tick at which the entry expires; ticks not after the current one expire
+   *        on the next tick
+   */
+  void Insert(Entry* entry, uint64_t expiry_tick);
+
+  /**
+   * @brief Unlink an entry without expiring it (O(1))
+   * @param entry Linked entry
+   */
+  void Remove(Entry* entry);
+
+  /**
+   * @brief Move time forward, unlinking expired entries
+   * @param now_tick Current time in ticks (earlier values are ignored)
+   * @param on_expired Called with each expired entry, in expiry order, after it is unlinked;
+   *        it may re-insert the entry
+   */
+  template <typename F>
+  void Advance(uint64_t now_tick, F&& on_expired);
+
+  /**
+   * @brief Unlink every entry
+   * @param on_entry Called with each entry after it is unlinked
+   */
+  template <typename F>
+  void Clear(F&& on_entry);
+
+  /**
+   * @brief Get the next tick at which Advance has work to do (an expiry or a cascade)
+   * @return Tick after the current one, or kNever if the wheel is empty
+   */
+  uint64_t NextEventTick() const;
+
+  /// @return Number of linked entries
+  size_t size() const { return size_; }
+
+  /// @return Time of the last Advance, in ticks
+  uint64_t current_tick() const { return current_; }
+
+ private:
+  static constexpr uint64_t Span(size_t level) { return uint64_t{1} << (kSlotBits * level); }
+
+  void Link(Entry* entry, size_t level, size_t slot);
+  // Unlink and hand every entry of a slot to f
+  template <typename F>
+  void TakeSlot(size_t level, size_t slot, F&& f);
+
+  uint64_t current_;
+  size_t size_ = 0;
+  Entry* heads_[kLevels][kSlots] = {};
+  uint64_t occupied_[kLevels] = {};
+};
+
+// Template and inline member implementation
+inline void TimerWheel::Insert(Entry* entry, uint64_t expiry_tick) {
+  entry->expiry = expiry_tick;
+  // Already due: fire on the next tick
+  const uint64_t target = expiry_tick > current_ ? expiry_tick : current_ + 1;
+  const uint64_t delta = target - current_;
+
+  size_t level = 0;
+  while (level + 1 < kLevels && delta >= Span(level + 1)) {
+    ++level;
+  }
+  // Beyond the top level's range: park in its farthest slot, re-cascaded when reached
+  const uint64_t position =
+      delta < Span(kLevels) ? target : current_ + Span(kLevels) - 1;
+  Link(entry, level, static_cast<size_t>((position >> (kSlotBits * level)) & (kSlots - 1)));
+  ++size_;
+}
+
+inline void TimerWheel::Remove(Entry* entry) {
+  if (entry->prev != nullptr) {
+    entry->prev->next = entry->next;
+  } else {
+    heads_[entry->level][entry->slot] = entry->next;
+    if (entry->next == nullptr) {
+      occupied_[entry->level] &= ~(uint64_t{1} << entry->slot);
+    }
+  }
+  if (entry->next != nullptr) {
+    entry->next->prev = entry->prev;
+  }
+  entry->prev = nullptr;
+  entry->next = nullptr;
+  entry->linked = false;
+  --size_;
+}
+
+inline void TimerWheel::Link(Entry* entry, size_t level, size_t slot) {
+  Entry*& head = heads_[level][slot];
+  entry->prev = nullptr;
+  entry->next = head;
+  if (head != nullptr) {
+    head->prev = entry;
+  }
+  head = entry;
+  entry->level = static_cast<uint8_t>(level);
+  entry->slot = static_cast<uint8_t>(slot);
+  entry->linked = true;
+  occupied_[level] |= uint64_t{1} << slot;
+}
+
+template <typename F>
+void TimerWheel::TakeSlot(size_t level, size_t slot, F&& f) {
+  Entry* entry = heads_[level][slot];
+  heads_[level][slot] = nullptr;
+  occupied_[level] &= ~(uint64_t{1} << slot);
+  while (entry != nullptr) {
+    Entry* next = entry->next;
+    entry->prev = nullptr;
+    entry->next = nullptr;
+    entry->linked = false;
+    --size_;
+    f(entry);
+    entry = next;
+  }
+}
+
+inline uint64_t TimerWheel::NextEventTick() const {
+  uint64_t next = kNever;
+  for (size_t level = 0; level < kLevels; ++level) {
+    const uint64_t bits = occupied_[level];
+    if (bits == 0) {
+      continue;
+    }
+    // Level slots are visited at multiples of Span(level); find the next occupied one,
+    // searching all kSlots positions starting after the current one
+    const uint64_t index = current_ >> (kSlotBits * level);
+    const auto start = static_cast<unsigned>((index + 1) & (kSlots - 1));
+    const uint64_t rotated = start == 0 ? bits : (bits >> start) | (bits << (kSlots - start));
+    unsigned distance = 0;
+    while (((rotated >> distance) & 1) == 0) {
+      ++distance;
+    }
+    const uint64_t tick = (index + 1 + distance) << (kSlotBits * level);
+    if (tick < next) {
+      next = tick;
+    }
+  }
+  return next;
+}
+
+template <typename F>
+void TimerWheel::Advance(uint64_t now_tick, F&& on_expired) {
+  while (current_ < now_tick) {
+    const uint64_t tick = NextEventTick();
+    if (tick > now_tick) {
+      // Nothing happens in between: every linked entry keeps its slot
+      current_ = now_tick;
+      return;
+    }
+    current_ = tick;
+
+    // Cascade the higher levels whose slot boundary this is, top down so that entries can fall
+    // through several levels in one step. Entries due now join the expired list instead.
+    Entry* expired = nullptr;
+    Entry** tail = &expired;
+    auto expire = [&tail](Entry* entry) {
+      *tail = entry;
+      tail = &entry->next;
+    };
+    for (size_t level = kLevels - 1; level > 0; --level) {
+      if ((tick & (Span(level) - 1)) == 0) {
+        const auto slot = static_cast<size_t>((tick >> (kSlotBits * level)) & (kSlots - 1));
+        TakeSlot(level, slot, [this, tick, &expire](Entry* entry) {
+          if (entry->expiry <= tick) {
+            expire(entry);
+          } else {
+            Insert(entry, entry->expiry);
+          }
+        });
+      }
+    }
+    TakeSlot(0, static_cast<size_t>(tick & (kSlots - 1)), expire);
+
+    // The callback may re-insert entries, so detach each one before handing it out
+    while (expired != nullptr) {
+      Entry* entry = expired;
+      expired = entry->next;
+      entry->next = nullptr;
+      on_expired(entry);
+    }
+  }
+}
+
+template <typename F>
+void TimerWheel::Clear(F&& on_entry) {
+  for (size_t level = 0; level < kLevels; ++level) {
+    while (occupied_[level] != 0) {
+      size_t slot = 0;
+      while (((occupied_[level] >> slot) & 1) == 0) {
+        ++slot;
+      }
+      TakeSlot(level, slot, on_entry);
+    }
+  }
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_TIMER_WHEEL_H_
@@ -0,0 +1,195 @@
+#ifndef CALLBACK_WORKER_THREAD_WORK_STEALING_DEQUE_H_
+#define CALLBACK_WORKER_THREAD_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "callback_worker_thread/mpmc_queue.h"
+
+namespace callback_worker_thread {
+
+/**
+ * @brief Chase-Lev work-stealing deque
+ *
+ * The owning thread pushes and pops at the bottom (LIFO, so recently spawned work stays hot in
+ * its cache) while any other thread may steal from the top (FIFO). The owner's fast path is
+ * free of read-modify-write operations except when it races a thief for the last element.
+ * The backing array grows on demand; retired arrays are kept until the deque is destroyed so
+ * that concurrent thieves never read freed memory.
+ *
+ * Memory orderings follow N. M. Le et al., "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (PPoPP 2013).
+ *
+ * Thread safety: Push and Pop must only be called by the owning thread; Steal and Size may be
+ * called from any thread.
+ *
+ * @tparam T Element type (must be trivially copyable, typically a pointer)
+ */
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "WorkStealingDeque elements must be trivially copyable");
+
+ public:
+  /**
+   * @brief Constructor
+   * @param initial_capacity Initial array size (rounded up to a power of two)
+   */
+  explicit WorkStealingDeque(size_t initial_capacity = 256);
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  /**
+   * @brief Push an element at the bottom (owner only)
+   * @param value Element to push
+   */
+  void Push(T value);
+
+  /**
+   * @brief Pop the most recently pushed element (owner only)
+   * @param value Destination for the popped element
+   * @return true if an element was popped
+   */
+  bool Pop(T& value);
+
+  /**
+   * @brief Steal the oldest element (any thread)
+   * @param value Destination for the stolen element
+   * @return true if an element was stolen; false if the deque was empty or another thread won
+   *         the race for the element
+   */
+  bool Steal(T& value);
+
+  /**
+   * @brief Get approximate number of elements
+   * @return Element count snapshot
+   */
+  size_t Size() const;
+
+ private:
+  struct Array {
+    explicit Array(size_t size) : capacity(size), mask(size - 1), slots(new std::atomic<T>[size]) {}
+
+    T Get(int64_t index) const {
+      return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t index, T value) {
+      slots[static_cast<size_t>(index) & mask].store(value, std::memory_order_relaxed);
+    }
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+  Array* Grow(Array* array, int64_t top, int64_t bottom);
+
+  alignas(kCacheLineSize) std::atomic<int64_t> top_;
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_;
+  std::atomic<Array*> array_;
+  // Owner-only; holds the live array and every array it replaced
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+// Template function implementation
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t initial_capacity) : top_(0), bottom_(0) {
+  size_t rounded = 2;
+  while (rounded < initial_capacity) {
+    rounded <<= 1;
+  }
+  arrays_.push_back(std::make_unique<Array>(rounded));
+  array_.store(arrays_.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+void WorkStealingDeque<T>::Push(T value) {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  int64_t top = top_.load(std::memory_order_acquire);
+  Array* array = array_.load(std::memory_order_relaxed);
+
+  if (bottom - top > static_cast<int64_t>(array->capacity) - 1) {
+    array = Grow(array, top, bottom);
+  }
+
+  array->Put(bottom, value);
+  // Release store (rather than the paper's release fence + relaxed store) so that thread
+  // sanitizers can see the publication; it compiles to the same code on x86
+  bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+template <typename T>
+bool WorkStealingDeque<T>::Pop(T& value) {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Array* array = array_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // Empty
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  value = array->Get(bottom);
+  if (top == bottom) {
+    // Last element: race thieves for it
+    bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+template <typename T>
+bool WorkStealingDeque<T>::Steal(T& value) {
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+  if (top >= bottom) {
+    return false;
+  }
+
+  Array* array = array_.load(std::memory_order_acquire);
+  T candidate = array->Get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return false;
+  }
+  value = candidate;
+  return true;
+}
+
+template <typename T>
+size_t WorkStealingDeque<T>::Size() const {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  int64_t top = top_.load(std::memory_order_relaxed);
+  return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Array* WorkStealingDeque<T>::Grow(Array* array,
+                                                                  int64_t top,
+                                                                  int64_t bottom) {
+  auto grown = std::make_unique<Array>(array->capacity * 2);
+  for (int64_t i = top; i < bottom; ++i) {
+    grown->Put(i, array->Get(i));
+  }
+
+  Array* result = grown.get();
+  arrays_.push_back(std::move(grown));
+  array_.store(result, std::memory_order_release);
+  return result;
+}
+
+}  // namespace callback_worker_thread
+
+#endif  // CALLBACK_WORKER_THREAD_WORK_STEALING_DEQUE_H_
@@ -1,31 +1,300 @@
 #include "callback_worker_thread/callback_worker_thread.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <system_error>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
 
 namespace callback_worker_thread {
 
-CallbackWorkerThread::CallbackWorkerThread(size_t thread_count) 
-    : stop_(false) {
-  if (thread_count == 0) {
+namespace detail {
+
+struct TimerEntry : TimerWheel::Entry {
+  Task task;
+  // steady_clock time (ns) of the current deadline
+  uint64_t deadline_ns = 0;
+  // Period of a periodic task, 0 for a one-shot task
+  uint64_t interval_ns = 0;
+  // Set by Cancel (and Stop) so that a periodic run in progress does not re-arm
+  bool cancelled = false;
+  // Keeps the entry alive while it is armed or a periodic run is pending; handles only hold
+  // weak references
+  std::shared_ptr<TimerEntry> self;
+};
+
+}  // namespace detail
+
+struct CallbackWorkerThread::WorkerContext {
+  WorkerContext(CallbackWorkerThread* owner, size_t worker_index)
+      : pool(owner), index(worker_index), steal_seed(worker_index * 2654435761u + 1) {}
+
+  ~WorkerContext() {
+    // Workers drain their deques before exiting; this only matters if a thread never started
+    Task* task = nullptr;
+    while (local_tasks.Pop(task)) {
+      TakeLocalTask(task);
+    }
+  }
+
+  // Owned tasks live in task allocator blocks, so a worker pushing and popping its own deque
+  // reuses blocks from its thread cache; a stolen task's block goes back as a remote free
+  static Task* NewLocalTask(Task&& task) {
+    static_assert(detail::IsTaskAllocatable<Task>(), "Task must fit task allocator blocks");
+    return ::new (detail::TaskAllocate(sizeof(Task))) Task(std::move(task));
+  }
+
+  static Task TakeLocalTask(Task* node) {
+    Task task = std::move(*node);
+    node->~Task();
+    detail::TaskDeallocate(node);
+    return task;
+  }
+
+  CallbackWorkerThread* const pool;
+  const size_t index;
+  // Tasks taken from the queue in one acquisition (dequeue_batch_size slots)
+  std::unique_ptr<Task[]> batch;
+  // Work-stealing mode only; owned tasks are allocated (NewLocalTask) so they fit in an atomic
+  // slot
+  WorkStealingDeque<Task*> local_tasks;
+  // xorshift state for picking steal victims
+  uint64_t steal_seed;
+  // Set while a thread owns this slot; cleared by a retiring worker as it exits
+  std::atomic<bool> running{false};
+  // Shared queue served first (the worker's NUMA node with numa_local_queues)
+  size_t node = 0;
+  // CPUs the thread is pinned to (empty: not pinned)
+  std::vector<int> cpus;
+
+  // Written only by this worker; on their own cache lines so that workers never share one
+  struct alignas(kCacheLineSize) Metrics {
+    std::atomic<uint64_t> tasks_executed{0};
+    std::atomic<uint64_t> exceptions{0};
+    std::atomic<uint64_t> busy_ns{0};
+    std::atomic<uint64_t> idle_ns{0};
+    LatencyHistogram queue_wait;
+    LatencyHistogram execution;
+  } metrics;
+};
+
+thread_local CallbackWorkerThread::WorkerContext* CallbackWorkerThread::current_worker_ = nullptr;
+
+namespace {
+
+// Build with ENABLE_METRICS=OFF (defines CALLBACK_WORKER_THREAD_NO_METRICS) to compile
+// metrics collection out entirely
+#ifdef CALLBACK_WORKER_THREAD_NO_METRICS
+constexpr bool kMetricsCompiledIn = false;
+#else
+constexpr bool kMetricsCompiledIn = true;
+#endif
+
+// Monotonic clock in nanoseconds (never 0 in practice, so 0 can mean "no timestamp")
+inline uint64_t NowNs() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+// next_timer_ns_ value meaning "no timer armed"
+constexpr uint64_t kNoTimer = std::numeric_limits<uint64_t>::max();
+
+// Size of tag_states_ at which expired cancellation groups are first pruned
+constexpr size_t kMinTagPruneThreshold = 64;
+
+// Bounds of the slices a WaitHelping caller blocks on its future while no task is queued
+constexpr std::chrono::microseconds kMinHelpWaitSlice{50};
+constexpr std::chrono::microseconds kMaxHelpWaitSlice{1000};
+
+// Add to a counter that only the calling thread writes
+inline void AddOwned(std::atomic<uint64_t>& counter, uint64_t delta) {
+  counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// Tell the CPU we are in a spin-wait loop (saves power, frees the sibling hyperthread)
+inline void CpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+CallbackWorkerThreadOptions OptionsWithThreadCount(size_t thread_count) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = thread_count;
+  return options;
+}
+
+// Elastic bounds with 0 meaning "same as thread_count"
+size_t MinThreads(const CallbackWorkerThreadOptions& options) {
+  return options.min_thread_count == 0 ? options.thread_count : options.min_thread_count;
+}
+
+size_t MaxThreads(const CallbackWorkerThreadOptions& options) {
+  return options.max_thread_count == 0 ? options.thread_count : options.max_thread_count;
+}
+
+// Topology limited to the CPUs workers may use; only probed when placement is requested
+CpuTopology PlacementTopology(const CallbackWorkerThreadOptions& options) {
+  if (options.placement == WorkerPlacement::kNone && !options.numa_local_queues) {
+    return CpuTopology::FromNodes({options.cpu_set});
+  }
+  return CpuTopology::Detect().Restrict(options.cpu_set);
+}
+
+}  // namespace
+
+CallbackWorkerThread::CallbackWorkerThread(size_t thread_count)
+    : CallbackWorkerThread(OptionsWithThreadCount(thread_count)) {}
+
+CallbackWorkerThread::CallbackWorkerThread(const CallbackWorkerThreadOptions& options)
+    : queue_type_(options.queue_type),
+      work_stealing_(options.work_stealing),
+      max_dequeue_batch_(options.dequeue_batch_size),
+      adaptive_dequeue_batch_(options.adaptive_dequeue_batch),
+      wait_strategy_(options.wait_strategy),
+      spin_iterations_(options.spin_iterations),
+      yield_iterations_(options.yield_iterations),
+      min_threads_(MinThreads(options)),
+      max_threads_(MaxThreads(options)),
+      elastic_(min_threads_ != max_threads_),
+      keep_alive_(options.keep_alive),
+      grow_queue_depth_(options.grow_queue_depth),
+      grow_wait_threshold_ns_(elastic_ ? static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(options.grow_wait_threshold)
+              .count()) : 0),
+      active_workers_(options.thread_count),
+      retire_requests_(0),
+      topology_(PlacementTopology(options)),
+      placement_(options.placement),
+      numa_local_queues_(options.numa_local_queues),
+      shared_queue_count_(numa_local_queues_ ? topology_.nodes.size() : 1),
+      shared_queues_(new SharedQueue[shared_queue_count_]),
+      lock_free_queue_size_(options.lock_free_queue_size),
+      starvation_limit_(options.starvation_limit),
+      dequeue_counter_(0),
+      max_queue_size_(options.max_queue_size),
+      overflow_policy_(options.overflow_policy),
+      drop_handler_(options.drop_handler),
+      pin_forced_(max_queue_size_ > 0 && overflow_policy_ == OverflowPolicy::kDropOldest),
+      queued_count_(0),
+      sleeping_workers_(0),
+      waiting_producers_(0),
+      pinned_count_(0),
+      in_flight_count_(0),
+      idle_waiters_(0),
+      stop_(false),
+      metrics_enabled_(kMetricsCompiledIn && options.enable_metrics),
+      timer_tick_ns_(static_cast<uint64_t>(std::max<int64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(options.timer_tick).count(), 0))),
+      timer_wheel_(timer_tick_ns_ == 0 ? 0 : NowNs() / timer_tick_ns_),
+      next_timer_ns_(kNoTimer),
+      timer_leader_(false),
+      tag_prune_threshold_(kMinTagPruneThreshold),
+      exception_handler_(options.exception_handler),
+      anchor_(std::make_shared<detail::PoolAnchor>(this)) {
+  if (options.thread_count == 0) {
     throw std::invalid_argument("Thread count must be greater than 0");
   }
+  if (min_threads_ > options.thread_count || options.thread_count > max_threads_) {
+    throw std::invalid_argument(
+        "Thread count must be between the minimum and maximum thread counts");
+  }
+  if (options.dequeue_batch_size == 0) {
+    throw std::invalid_argument("Dequeue batch size must be greater than 0");
+  }
+  if (timer_tick_ns_ == 0) {
+    throw std::invalid_argument("Timer tick must be greater than 0");
+  }
+  if (queue_type_ == QueueType::kLockFree && max_queue_size_ > lock_free_queue_size_) {
+    throw std::invalid_argument("Maximum queue size must not exceed the lock-free queue size");
+  }
+  if (numa_local_queues_ && placement_ == WorkerPlacement::kNone) {
+    throw std::invalid_argument("NUMA-local queues require a worker placement");
+  }
+  for (int cpu : options.cpu_set) {
+    if (cpu < 0) {
+      throw std::invalid_argument("CPU ids must not be negative");
+    }
+  }
+
+  for (size_t i = 0; i < shared_queue_count_; ++i) {
+    for (auto& ring : shared_queues_[i].rings) {
+      ring.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  if (queue_type_ == QueueType::kLockFree) {
+    // Most tasks use the default priority; create its ring now so bad sizes fail early. Other
+    // rings are created by their first producer, which runs on the ring's node, so first-touch
+    // allocation puts them in node-local memory.
+    LockFreeLevel(shared_queues_[0], static_cast<size_t>(TaskPriority::kNormal), true);
+  }
 
-  // Launch worker threads
-  workers_.reserve(thread_count);
-  for (size_t i = 0; i < thread_count; ++i) {
-    workers_.emplace_back(&CallbackWorkerThread::WorkerThreadMain, this);
+  // Allocate every slot an elastic pool may use, then launch the initial workers
+  const size_t node_count = topology_.nodes.size();
+  worker_contexts_.reserve(max_threads_);
+  for (size_t i = 0; i < max_threads_; ++i) {
+    worker_contexts_.push_back(std::make_unique<WorkerContext>(this, i));
+    WorkerContext& context = *worker_contexts_.back();
+    context.batch.reset(new Task[max_dequeue_batch_]);
+
+    // Slot i goes to node i % node_count, so any number of workers spreads evenly
+    const size_t node = i % node_count;
+    const std::vector<int>& node_cpus = topology_.nodes[node];
+    context.node = numa_local_queues_ ? node : 0;
+    switch (placement_) {
+      case WorkerPlacement::kNone:
+        context.cpus = options.cpu_set;
+        break;
+      case WorkerPlacement::kCpu:
+        context.cpus = {node_cpus[(i / node_count) % node_cpus.size()]};
+        break;
+      case WorkerPlacement::kNumaNode:
+        context.cpus = node_cpus;
+        break;
+    }
+  }
+
+  workers_.resize(max_threads_);
+  for (size_t i = 0; i < options.thread_count; ++i) {
+    StartWorker();
   }
 }
 
 CallbackWorkerThread::~CallbackWorkerThread() {
   Stop();
   
-  // Wait for all worker threads to finish
+  // Wait for all worker threads to finish (including retired ones that were never joined)
+  std::lock_guard<std::mutex> lock(resize_mutex_);
   for (auto& worker : workers_) {
     if (worker.joinable()) {
       worker.join();
     }
   }
+  // Timers a worker re-armed while the pool was stopping
+  DiscardTimers();
+
+  // Futures outliving the pool drop their continuations from now on; wait out submissions
+  // that read the pool before it was cleared (they fail fast since the pool is stopped)
+  anchor_->pool.store(nullptr);
+  while (anchor_->submitters.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  for (size_t i = 0; i < shared_queue_count_; ++i) {
+    for (auto& ring : shared_queues_[i].rings) {
+      delete ring.load(std::memory_order_relaxed);
+    }
+  }
 }
 
 std::future<void> CallbackWorkerThread::EnqueueDefault(
@@ -33,18 +302,217 @@ std::future<void> CallbackWorkerThread::EnqueueDefault(
     int arg1,
     double arg2,
     const std::string& arg3) {
-  return Enqueue([callback, arg1, arg2, arg3]() {
+  return Enqueue([callback = std::move(callback), arg1, arg2, arg3]() {
+    callback(arg1, arg2, arg3);
+  });
+}
+
+std::future<void> CallbackWorkerThread::EnqueueDefault(
+    DefaultCallback callback,
+    int arg1,
+    double arg2,
+    std::string&& arg3) {
+  return Enqueue([callback = std::move(callback), arg1, arg2, arg3 = std::move(arg3)]() {
+    callback(arg1, arg2, arg3);
+  });
+}
+
+void CallbackWorkerThread::PostDefault(DefaultCallback callback,
+                                       int arg1,
+                                       double arg2,
+                                       const std::string& arg3) {
+  Post([callback = std::move(callback), arg1, arg2, arg3]() {
+    callback(arg1, arg2, arg3);
+  });
+}
+
+void CallbackWorkerThread::PostDefault(DefaultCallback callback,
+                                       int arg1,
+                                       double arg2,
+                                       std::string&& arg3) {
+  Post([callback = std::move(callback), arg1, arg2, arg3 = std::move(arg3)]() {
     callback(arg1, arg2, arg3);
   });
 }
 
+void CallbackWorkerThread::SetExceptionHandler(ExceptionHandler handler) {
+  std::lock_guard<std::mutex> lock(exception_handler_mutex_);
+  exception_handler_ = std::move(handler);
+}
+
+void CallbackWorkerThread::HandleTaskException(std::exception_ptr exception) {
+  // Call a copy outside the lock so the handler may itself call SetExceptionHandler
+  ExceptionHandler handler;
+  {
+    std::lock_guard<std::mutex> lock(exception_handler_mutex_);
+    handler = exception_handler_;
+  }
+  if (!handler) {
+    return;
+  }
+
+  try {
+    handler(exception);
+  } catch (...) {
+    // A failing handler must not take the worker thread down
+  }
+}
+
 size_t CallbackWorkerThread::GetThreadCount() const {
-  return workers_.size();
+  return active_workers_.load(std::memory_order_relaxed);
+}
+
+void CallbackWorkerThread::Resize(size_t thread_count) {
+  if (thread_count < min_threads_ || thread_count > max_threads_) {
+    throw std::invalid_argument(
+        "Thread count must be between the minimum and maximum thread counts");
+  }
+
+  std::lock_guard<std::mutex> lock(resize_mutex_);
+  if (stop_) {
+    throw std::runtime_error("Cannot resize: thread pool is stopped");
+  }
+
+  // Grow: take back pending retirements first, then start threads. Idle workers may retire
+  // concurrently, so re-read the count on every iteration.
+  size_t active = active_workers_.load();
+  while (active < thread_count) {
+    size_t requests = retire_requests_.load();
+    if (requests > 0) {
+      if (retire_requests_.compare_exchange_weak(requests, requests - 1)) {
+        active_workers_.fetch_add(1);
+      }
+    } else {
+      active_workers_.fetch_add(1);
+      if (!StartWorker()) {
+        // Every free slot still holds a retiring thread; it is about to exit
+        active_workers_.fetch_sub(1);
+        std::this_thread::yield();
+      }
+    }
+    active = active_workers_.load();
+  }
+
+  // Shrink: uncount the excess now and let that many workers retire when they next look
+  while (active > thread_count) {
+    if (active_workers_.compare_exchange_weak(active, thread_count)) {
+      retire_requests_.fetch_add(active - thread_count);
+      // Parked workers treat a retire request as a wakeup (same handshake as WakeWorkers)
+      { std::lock_guard<std::mutex> queue_lock(queue_mutex_); }
+      condition_.notify_all();
+      break;
+    }
+  }
+}
+
+bool CallbackWorkerThread::StartWorker() {
+  for (size_t i = 0; i < worker_contexts_.size(); ++i) {
+    WorkerContext* context = worker_contexts_[i].get();
+    if (context->running.load(std::memory_order_acquire)) {
+      continue;
+    }
+
+    // A retired thread may still be on its way out of WorkerThreadMain
+    if (workers_[i].joinable()) {
+      workers_[i].join();
+    }
+    context->running.store(true, std::memory_order_relaxed);
+    try {
+      workers_[i] = std::thread(&CallbackWorkerThread::WorkerThreadMain, this, context);
+    } catch (...) {
+      context->running.store(false, std::memory_order_relaxed);
+      throw;
+    }
+    return true;
+  }
+  return false;
+}
+
+void CallbackWorkerThread::MaybeGrow() {
+  std::unique_lock<std::mutex> lock(resize_mutex_, std::try_to_lock);
+  if (!lock.owns_lock() || stop_) {
+    return;
+  }
+
+  // Keeping a worker that was about to retire is cheaper than starting a thread
+  size_t requests = retire_requests_.load();
+  while (requests > 0) {
+    if (retire_requests_.compare_exchange_weak(requests, requests - 1)) {
+      active_workers_.fetch_add(1);
+      return;
+    }
+  }
+
+  if (active_workers_.load() >= max_threads_) {
+    return;
+  }
+  // Count the worker before it starts so that it can never see itself as surplus
+  active_workers_.fetch_add(1);
+  try {
+    if (!StartWorker()) {
+      active_workers_.fetch_sub(1);
+    }
+  } catch (const std::system_error&) {
+    // Out of threads: the pool keeps working at its current size
+    active_workers_.fetch_sub(1);
+  }
+}
+
+bool CallbackWorkerThread::ShouldRetire(bool idle_timeout) {
+  size_t requests = retire_requests_.load();
+  while (requests > 0) {
+    if (retire_requests_.compare_exchange_weak(requests, requests - 1)) {
+      return true;
+    }
+  }
+  if (!idle_timeout) {
+    return false;
+  }
+
+  size_t active = active_workers_.load();
+  while (active > min_threads_) {
+    if (active_workers_.compare_exchange_weak(active, active - 1)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 size_t CallbackWorkerThread::GetQueueSize() const {
-  std::unique_lock<std::mutex> lock(queue_mutex_);
-  return tasks_.size();
+  return queued_count_.load(std::memory_order_relaxed);
+}
+
+size_t CallbackWorkerThread::GetIdleWorkerCount() const {
+  return sleeping_workers_.load(std::memory_order_relaxed);
+}
+
+MetricsSnapshot CallbackWorkerThread::GetMetrics() const {
+  MetricsSnapshot snapshot;
+  snapshot.enabled = metrics_enabled_.load(std::memory_order_relaxed);
+  snapshot.queue_size = GetQueueSize();
+  snapshot.workers.reserve(worker_contexts_.size());
+
+  for (const auto& context : worker_contexts_) {
+    const auto& metrics = context->metrics;
+    WorkerMetrics worker;
+    worker.tasks_executed = metrics.tasks_executed.load(std::memory_order_relaxed);
+    worker.exceptions = metrics.exceptions.load(std::memory_order_relaxed);
+    worker.busy_ns = metrics.busy_ns.load(std::memory_order_relaxed);
+    worker.idle_ns = metrics.idle_ns.load(std::memory_order_relaxed);
+    snapshot.workers.push_back(worker);
+
+    snapshot.total.tasks_executed += worker.tasks_executed;
+    snapshot.total.exceptions += worker.exceptions;
+    snapshot.total.busy_ns += worker.busy_ns;
+    snapshot.total.idle_ns += worker.idle_ns;
+    metrics.queue_wait.MergeInto(snapshot.queue_wait);
+    metrics.execution.MergeInto(snapshot.execution);
+  }
+  return snapshot;
+}
+
+void CallbackWorkerThread::SetMetricsEnabled(bool enabled) {
+  metrics_enabled_.store(kMetricsCompiledIn && enabled, std::memory_order_relaxed);
 }
 
 void CallbackWorkerThread::Stop() {
@@ -53,48 +521,898 @@ void CallbackWorkerThread::Stop() {
     stop_ = true;
   }
   condition_.notify_all();
+  space_condition_.notify_all();
+  DiscardTimers();
+}
+
+CancellationToken CallbackWorkerThread::GetTagToken(uint64_t tag) {
+  std::lock_guard<std::mutex> lock(tag_mutex_);
+  std::weak_ptr<detail::CancellationState>& slot = tag_states_[tag];
+  std::shared_ptr<detail::CancellationState> state = slot.lock();
+  if (state == nullptr) {
+    state = std::make_shared<detail::CancellationState>();
+    slot = state;
+
+    // Forget groups whose tasks are all gone; doubling the threshold keeps this amortized O(1)
+    if (tag_states_.size() >= tag_prune_threshold_) {
+      for (auto it = tag_states_.begin(); it != tag_states_.end();) {
+        it = it->second.expired() ? tag_states_.erase(it) : std::next(it);
+      }
+      tag_prune_threshold_ = std::max(kMinTagPruneThreshold, tag_states_.size() * 2);
+    }
+  }
+  return CancellationToken(std::move(state));
+}
+
+bool CallbackWorkerThread::CancelTag(uint64_t tag) {
+  std::shared_ptr<detail::CancellationState> state;
+  {
+    std::lock_guard<std::mutex> lock(tag_mutex_);
+    auto it = tag_states_.find(tag);
+    if (it == tag_states_.end()) {
+      return false;
+    }
+    state = it->second.lock();
+    tag_states_.erase(it);
+  }
+  if (state == nullptr) {
+    return false;
+  }
+  state->cancelled.store(true, std::memory_order_release);
+  return true;
+}
+
+bool TimerHandle::Cancel() {
+  const std::shared_ptr<detail::TimerEntry> entry = entry_.lock();
+  return entry != nullptr && pool_->CancelTimer(entry);
+}
+
+bool TimerHandle::IsActive() const {
+  const std::shared_ptr<detail::TimerEntry> entry = entry_.lock();
+  return entry != nullptr && pool_->TimerActive(entry);
+}
+
+TimerHandle CallbackWorkerThread::ScheduleTimer(Task&& task, uint64_t deadline_ns,
+                                                uint64_t interval_ns) {
+  auto entry = std::make_shared<detail::TimerEntry>();
+  entry->task = std::move(task);
+  entry->interval_ns = interval_ns;
+
+  bool earlier = false;
+  {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    if (stop_) {
+      throw std::runtime_error("Cannot schedule task: thread pool is stopped");
+    }
+    entry->self = entry;
+    earlier = ArmTimer(*entry, deadline_ns);
+  }
+  if (earlier) {
+    WakeTimerLeader();
+  }
+  return TimerHandle(this, entry);
+}
+
+bool CallbackWorkerThread::ArmTimer(detail::TimerEntry& entry, uint64_t deadline_ns) {
+  entry.deadline_ns = deadline_ns;
+  // Round up so that a timer never fires before its deadline
+  timer_wheel_.Insert(&entry, (deadline_ns + timer_tick_ns_ - 1) / timer_tick_ns_);
+  return UpdateNextTimer();
+}
+
+bool CallbackWorkerThread::UpdateNextTimer() {
+  const uint64_t tick = timer_wheel_.NextEventTick();
+  const uint64_t next = tick == TimerWheel::kNever ? kNoTimer : tick * timer_tick_ns_;
+  return next < next_timer_ns_.exchange(next);
+}
+
+void CallbackWorkerThread::WakeTimerLeader() {
+  if (sleeping_workers_.load() == 0) {
+    return;
+  }
+  // Same handshake as WakeWorkers: a parked worker re-checks next_timer_ns_ under the lock
+  { std::lock_guard<std::mutex> lock(queue_mutex_); }
+  condition_.notify_all();
+}
+
+bool CallbackWorkerThread::TimerDue() const {
+  const uint64_t next = next_timer_ns_.load(std::memory_order_relaxed);
+  return next != kNoTimer && NowNs() >= next;
+}
+
+void CallbackWorkerThread::PollTimers() {
+  std::vector<Task> due;
+  {
+    std::unique_lock<std::mutex> lock(timer_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      // Another worker is polling, or a timer is being scheduled and will be seen next time
+      return;
+    }
+    timer_wheel_.Advance(NowNs() / timer_tick_ns_, [this, &due](TimerWheel::Entry* expired) {
+      auto* entry = static_cast<detail::TimerEntry*>(expired);
+      if (entry->interval_ns == 0) {
+        due.push_back(std::move(entry->task));
+        entry->self.reset();
+      } else {
+        // The run re-arms the timer when it returns, so runs of one task never overlap
+        due.emplace_back([this, entry = entry->self]() { RunPeriodic(entry); });
+      }
+    });
+    UpdateNextTimer();
+  }
+  if (due.empty()) {
+    return;
+  }
+
+  try {
+    // Timers were admitted when scheduled, so a bounded queue does not hold them back
+    PushTasks(due.data(), due.size(), TaskPriority::kNormal, AdmitMode::kForce);
+  } catch (const std::runtime_error&) {
+    // Stopped while firing: the tasks are discarded like every other pending timer
+  }
+}
+
+void CallbackWorkerThread::RunPeriodic(const std::shared_ptr<detail::TimerEntry>& entry) {
+  {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    if (entry->cancelled) {
+      entry->self.reset();
+      return;
+    }
+  }
+
+  RunTask(entry->task);
+
+  bool earlier = false;
+  {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    if (entry->cancelled || stop_) {
+      entry->self.reset();
+      return;
+    }
+    // Fixed rate; after an overrun, skip to the next deadline still in the future
+    const uint64_t now = NowNs();
+    uint64_t next = entry->deadline_ns + entry->interval_ns;
+    if (next <= now) {
+      next += (now - next) / entry->interval_ns * entry->interval_ns + entry->interval_ns;
+    }
+    earlier = ArmTimer(*entry, next);
+  }
+  if (earlier) {
+    WakeTimerLeader();
+  }
+}
+
+bool CallbackWorkerThread::CancelTimer(const std::shared_ptr<detail::TimerEntry>& entry) {
+  // Destroyed after the lock is released, since its captures may run arbitrary code
+  Task discarded;
+  std::shared_ptr<detail::TimerEntry> self;
+  std::lock_guard<std::mutex> lock(timer_mutex_);
+  if (entry->cancelled) {
+    return false;
+  }
+
+  const bool linked = entry->linked;
+  if (linked) {
+    timer_wheel_.Remove(entry.get());
+    UpdateNextTimer();
+    discarded = std::move(entry->task);
+  } else if (entry->interval_ns == 0) {
+    // Already fired
+    return false;
+  }
+  entry->cancelled = true;
+  // A periodic run in progress still references the entry and releases it when it returns
+  self = std::move(entry->self);
+  return true;
+}
+
+bool CallbackWorkerThread::TimerActive(const std::shared_ptr<detail::TimerEntry>& entry) {
+  std::lock_guard<std::mutex> lock(timer_mutex_);
+  return !entry->cancelled && (entry->linked || entry->interval_ns != 0);
+}
+
+void CallbackWorkerThread::DiscardTimers() {
+  std::vector<Task> discarded;
+  std::vector<std::shared_ptr<detail::TimerEntry>> entries;
+  {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    timer_wheel_.Clear([&](TimerWheel::Entry* cleared) {
+      auto* entry = static_cast<detail::TimerEntry*>(cleared);
+      entry->cancelled = true;
+      discarded.push_back(std::move(entry->task));
+      entries.push_back(std::move(entry->self));
+    });
+    next_timer_ns_.store(kNoTimer);
+  }
+  // Destroying one-shot tasks breaks their promises; done outside the lock
 }
 
 void CallbackWorkerThread::WaitForCompletion() {
-  // Wait until all tasks are completed
+  WaitIdle();
+}
+
+void CallbackWorkerThread::WaitIdle() {
+  WaitIdleUntil(nullptr);
+}
+
+size_t CallbackWorkerThread::GetInFlightCount() const {
+  return in_flight_count_.load(std::memory_order_relaxed);
+}
+
+void CallbackWorkerThread::FinishTasks(size_t count) {
+  if (in_flight_count_.fetch_sub(count) != count || idle_waiters_.load() == 0) {
+    return;
+  }
+
+  // Same handshake as WakeWorkers: a waiter re-checks in_flight_count_ under the lock
+  { std::lock_guard<std::mutex> lock(queue_mutex_); }
+  idle_condition_.notify_all();
+}
+
+bool CallbackWorkerThread::WaitIdleUntil(const Deadline* deadline) {
+  WorkerContext* current = current_worker_;
+  if (current != nullptr && current->pool == this) {
+    throw std::logic_error("Cannot wait for idle from a worker of the same thread pool");
+  }
+
+  auto idle = [this] { return in_flight_count_.load() == 0; };
+  if (idle()) {
+    return true;
+  }
+
   std::unique_lock<std::mutex> lock(queue_mutex_);
-  condition_.wait(lock, [this] { 
-    return tasks_.empty() && stop_; 
-  });
+  idle_waiters_.fetch_add(1);
+  bool reached = true;
+  if (deadline != nullptr) {
+    reached = idle_condition_.wait_until(lock, *deadline, idle);
+  } else {
+    idle_condition_.wait(lock, idle);
+  }
+  idle_waiters_.fetch_sub(1);
+  return reached;
 }
 
-void CallbackWorkerThread::WorkerThreadMain() {
-  while (true) {
-    std::function<void()> task;
-    
-    {
+bool CallbackWorkerThread::HelpUntilReady(ReadyWait wait, const void* future,
+                                          const Deadline* deadline) {
+  // Nothing to help with: wait on the future itself, for increasingly long slices so that an
+  // idle helper costs little but still notices tasks queued later
+  std::chrono::microseconds slice = kMinHelpWaitSlice;
+  while (!wait(future, std::chrono::microseconds(0))) {
+    std::chrono::microseconds wait_slice = slice;
+    if (deadline != nullptr) {
+      const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+          *deadline - std::chrono::steady_clock::now());
+      if (remaining <= std::chrono::microseconds(0)) {
+        return false;
+      }
+      wait_slice = std::min(wait_slice, remaining);
+    }
+    if (TryRunQueuedTask()) {
+      slice = kMinHelpWaitSlice;
+      continue;
+    }
+    if (wait(future, wait_slice)) {
+      return true;
+    }
+    slice = std::min(slice * 2, kMaxHelpWaitSlice);
+  }
+  return true;
+}
+
+bool CallbackWorkerThread::TryRunQueuedTask() {
+  WorkerContext* current = current_worker_;
+  Task task;
+  const size_t count = current != nullptr && current->pool == this
+                           ? TryGetTasks(current, &task, 1)
+                           : TryPopSharedTasks(&task, 1, SubmitQueueIndex(current));
+  if (count == 0) {
+    return false;
+  }
+  RunTask(task);
+  task = Task();
+  FinishTasks(1);
+  return true;
+}
+
+bool CallbackWorkerThread::IsWorkerThread() const {
+  const WorkerContext* current = current_worker_;
+  return current != nullptr && current->pool == this;
+}
+
+bool CallbackWorkerThread::PushTask(Task&& task, TaskPriority priority, AdmitMode mode,
+                                    Deadline deadline) {
+  return PushTasks(&task, 1, priority, mode, deadline);
+}
+
+bool CallbackWorkerThread::PushTasks(Task* tasks, size_t count, TaskPriority priority,
+                                     AdmitMode mode, Deadline deadline) {
+  const auto level = static_cast<size_t>(priority);
+  if (level >= kTaskPriorityLevels) {
+    throw std::invalid_argument("Invalid task priority");
+  }
+  if (count == 0) {
+    return true;
+  }
+
+  // Local deques are LIFO and unprioritized, so only default-priority work may go there
+  WorkerContext* current = current_worker_;
+  const bool local = work_stealing_ && priority == TaskPriority::kNormal &&
+                     current != nullptr && current->pool == this;
+  SharedQueue& queue = shared_queues_[local ? 0 : SubmitQueueIndex(current)];
+  MpmcQueue<Task>* ring = nullptr;
+  if (!local && queue_type_ == QueueType::kLockFree) {
+    ring = LockFreeLevel(queue, level, true);
+  }
+
+  if ((kMetricsCompiledIn && metrics_enabled_.load(std::memory_order_relaxed)) ||
+      grow_wait_threshold_ns_ != 0) {
+    const uint64_t now = NowNs();
+    for (size_t i = 0; i < count; ++i) {
+      tasks[i].set_timestamp(now);
+    }
+  }
+
+  // Count the tasks before they become visible so that workers cannot exit while they are in
+  // flight; this is also where a bounded queue blocks, rejects or drops
+  if (!ReserveQueueSlots(count, mode, deadline)) {
+    if (mode != AdmitMode::kPolicy) {
+      return false;
+    }
+    // kCallerRuns: the queue is full, so the producer runs its tasks itself
+    for (size_t i = 0; i < count; ++i) {
+      RunTask(tasks[i]);
+      tasks[i] = Task();
+    }
+    return true;
+  }
+
+  size_t pushed = 0;
+  try {
+    if (local) {
+      for (; pushed < count; ++pushed) {
+        current->local_tasks.Push(WorkerContext::NewLocalTask(std::move(tasks[pushed])));
+      }
+    } else if (pin_forced_ && mode == AdmitMode::kForce) {
       std::unique_lock<std::mutex> lock(queue_mutex_);
-      
-      // Wait for a task or stop flag
-      condition_.wait(lock, [this] { 
-        return stop_ || !tasks_.empty(); 
-      });
-      
-      // Exit if stop flag is set and no tasks remain
-      if (stop_ && tasks_.empty()) {
-        return;
+      for (; pushed < count; ++pushed) {
+        queue.pinned[level].push_back(std::move(tasks[pushed]));
+      }
+      pinned_count_.fetch_add(count);
+    } else if (queue_type_ == QueueType::kLocked) {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      for (; pushed < count; ++pushed) {
+        queue.tasks[level].push_back(std::move(tasks[pushed]));
+      }
+    } else {
+      // The ring is bounded; wait for consumers to free a slot. A worker of this pool must not
+      // wait, since every worker could be doing the same with nobody left to consume: it runs
+      // the task itself instead, as with OverflowPolicy::kCallerRuns. Try submissions, which
+      // are single tasks, give up instead of waiting.
+      const bool from_worker = current != nullptr && current->pool == this;
+      for (; pushed < count; ++pushed) {
+        while (!ring->TryPush(std::move(tasks[pushed]))) {
+          if (mode == AdmitMode::kTry ||
+              (mode == AdmitMode::kDeadline && std::chrono::steady_clock::now() >= deadline)) {
+            ReleaseQueueSlots(count - pushed);
+            FinishTasks(count - pushed);
+            return false;
+          }
+          if (from_worker) {
+            ReleaseQueueSlots(1);
+            RunTask(tasks[pushed]);
+            tasks[pushed] = Task();
+            FinishTasks(1);
+            break;
+          }
+          if (stop_) {
+            throw std::runtime_error("Cannot enqueue task: thread pool is stopped");
+          }
+          std::this_thread::yield();
+        }
+      }
+    }
+  } catch (...) {
+    ReleaseQueueSlots(count - pushed);
+    FinishTasks(count - pushed);
+    throw;
+  }
+
+  WakeWorkers(count);
+  // Grow only when waking parked workers cannot help; the depth check keeps this off the fast
+  // path of a fixed-size pool entirely
+  if (elastic_ && sleeping_workers_.load(std::memory_order_relaxed) == 0 &&
+      queued_count_.load(std::memory_order_relaxed) > grow_queue_depth_ &&
+      active_workers_.load(std::memory_order_relaxed) < max_threads_) {
+    MaybeGrow();
+  }
+  return true;
+}
+
+MpmcQueue<Task>* CallbackWorkerThread::LockFreeLevel(SharedQueue& queue, size_t level,
+                                                     bool create) {
+  MpmcQueue<Task>* ring = queue.rings[level].load(std::memory_order_acquire);
+  if (ring != nullptr || !create) {
+    return ring;
+  }
+
+  // First use of this level: publish a new ring, or adopt the one a racing producer published
+  auto created = std::make_unique<MpmcQueue<Task>>(lock_free_queue_size_);
+  if (queue.rings[level].compare_exchange_strong(ring, created.get(),
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+    return created.release();
+  }
+  return ring;
+}
+
+size_t CallbackWorkerThread::SubmitQueueIndex(const WorkerContext* current) const {
+  if (!numa_local_queues_) {
+    return 0;
+  }
+  if (current != nullptr && current->pool == this) {
+    return current->node;
+  }
+  return topology_.NodeOfCpu(GetCurrentCpu());
+}
+
+bool CallbackWorkerThread::ReserveQueueSlots(size_t count, AdmitMode mode, Deadline deadline) {
+  WorkerContext* current = current_worker_;
+  const bool from_worker = current != nullptr && current->pool == this;
+
+  // A worker blocked on its own full queue could deadlock the pool, so it is admitted over the
+  // limit
+  if (max_queue_size_ == 0 || mode == AdmitMode::kForce ||
+      (from_worker && mode == AdmitMode::kPolicy && overflow_policy_ == OverflowPolicy::kBlock)) {
+    in_flight_count_.fetch_add(count);
+    queued_count_.fetch_add(count);
+  } else {
+    size_t queued = queued_count_.load();
+    while (true) {
+      // A batch larger than the limit is only admitted into an empty queue
+      if (queued == 0 || queued + count <= max_queue_size_) {
+        // Count in flight first so that in_flight_count_ >= queued_count_ always holds
+        in_flight_count_.fetch_add(count);
+        if (queued_count_.compare_exchange_weak(queued, queued + count)) {
+          break;
+        }
+        FinishTasks(count);
+        continue;
+      }
+
+      if (stop_) {
+        throw std::runtime_error("Cannot enqueue task: thread pool is stopped");
+      }
+      if (mode == AdmitMode::kTry) {
+        return false;
+      }
+      if (mode == AdmitMode::kPolicy && overflow_policy_ == OverflowPolicy::kReject) {
+        throw QueueFullError();
+      }
+      if (mode == AdmitMode::kPolicy && overflow_policy_ == OverflowPolicy::kCallerRuns) {
+        return false;
+      }
+      if (mode == AdmitMode::kPolicy && overflow_policy_ == OverflowPolicy::kDropOldest) {
+        // Nothing to drop means the queued tasks are pinned, sit in worker deques or are still
+        // being pushed. Waiting for them could deadlock (a worker may be the one that has to
+        // run them), so the task is admitted over the limit; it is droppable itself, which
+        // keeps the excess to the undroppable tasks.
+        if (!DropOldestTask()) {
+          in_flight_count_.fetch_add(count);
+          queued_count_.fetch_add(count);
+          break;
+        }
+      } else if (!WaitForQueueSpace(count, mode, deadline)) {
+        return false;
+      }
+      queued = queued_count_.load();
+    }
+  }
+
+  if (stop_) {
+    ReleaseQueueSlots(count);
+    FinishTasks(count);
+    throw std::runtime_error("Cannot enqueue task: thread pool is stopped");
+  }
+  return true;
+}
+
+void CallbackWorkerThread::ReleaseQueueSlots(size_t count) {
+  queued_count_.fetch_sub(count);
+  if (max_queue_size_ == 0 || waiting_producers_.load() == 0) {
+    return;
+  }
+
+  // Same handshake as WakeWorkers: a waiting producer re-checks queued_count_ under the lock
+  { std::lock_guard<std::mutex> lock(queue_mutex_); }
+  space_condition_.notify_all();
+}
+
+bool CallbackWorkerThread::WaitForQueueSpace(size_t count, AdmitMode mode, Deadline deadline) {
+  auto has_space_or_stop = [this, count] {
+    const size_t queued = queued_count_.load();
+    return stop_ || queued == 0 || queued + count <= max_queue_size_;
+  };
+
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  waiting_producers_.fetch_add(1);
+  bool ready = true;
+  if (mode == AdmitMode::kDeadline) {
+    ready = space_condition_.wait_until(lock, deadline, has_space_or_stop);
+  } else {
+    space_condition_.wait(lock, has_space_or_stop);
+  }
+  waiting_producers_.fetch_sub(1);
+  return ready;
+}
+
+bool CallbackWorkerThread::DropOldestTask() {
+  // With NUMA-local queues this is the oldest task of the first node that has one
+  Task dropped;
+  bool found = false;
+  if (queue_type_ == QueueType::kLocked) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    for (size_t level = kTaskPriorityLevels; level-- > 0 && !found;) {
+      for (size_t i = 0; i < shared_queue_count_ && !found; ++i) {
+        std::deque<Task>& queue = shared_queues_[i].tasks[level];
+        if (!queue.empty()) {
+          dropped = std::move(queue.front());
+          queue.pop_front();
+          found = true;
+        }
       }
-      
-      // Get task
-      task = std::move(tasks_.front());
-      tasks_.pop();
     }
-    
-    // Execute task
+  } else {
+    for (size_t level = kTaskPriorityLevels; level-- > 0 && !found;) {
+      for (size_t i = 0; i < shared_queue_count_ && !found; ++i) {
+        MpmcQueue<Task>* ring = LockFreeLevel(shared_queues_[i], level, false);
+        found = ring != nullptr && ring->TryPop(dropped);
+      }
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  ReleaseQueueSlots(1);
+  // Destroying the task breaks the promise of an Enqueue'd task, which is how its future
+  // learns about the drop
+  dropped = Task();
+  FinishTasks(1);
+  if (drop_handler_) {
     try {
-      task();
-    } catch (const std::exception&) {
-      // In a real application, implement proper error handling (e.g., logging)
-      // Here, we simply ignore exceptions
+      drop_handler_();
     } catch (...) {
-      // Ignore unknown exceptions as well
+      // A failing handler must not fail the producer's enqueue
+    }
+  }
+  return true;
+}
+
+void CallbackWorkerThread::WakeWorkers(size_t count) {
+  const size_t sleeping = sleeping_workers_.load();
+  if (sleeping == 0) {
+    return;
+  }
+
+  // A parked worker re-checks queued_count_ under queue_mutex_ before sleeping, so taking the
+  // lock here guarantees the notification cannot fall between its check and its wait.
+  { std::lock_guard<std::mutex> lock(queue_mutex_); }
+
+  // Wake exactly min(count, sleeping) workers
+  if (count >= sleeping) {
+    condition_.notify_all();
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      condition_.notify_one();
+    }
+  }
+}
+
+size_t CallbackWorkerThread::TryPopSharedTasks(Task* tasks, size_t max_count, size_t home) {
+  // Every starvation_limit_-th successful acquisition serves the lowest non-empty level first.
+  // Concurrent workers may read the same counter value; the limit is a rate, not a guarantee.
+  bool lowest_first = false;
+  if (starvation_limit_ > 0) {
+    lowest_first =
+        (dequeue_counter_.load(std::memory_order_relaxed) + 1) % starvation_limit_ == 0;
+  }
+
+  // Within a priority level, the home queue comes first and the other nodes' queues after it
+  auto queue_at = [this, home](size_t i) -> SharedQueue& {
+    return shared_queues_[(home + i) % shared_queue_count_];
+  };
+
+  size_t count = 0;
+  // Pinned tasks continue work that was admitted earlier, so they go first
+  if (pin_forced_ && pinned_count_.load() > 0) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    for (size_t level = 0; level < kTaskPriorityLevels; ++level) {
+      for (size_t i = 0; i < shared_queue_count_; ++i) {
+        std::deque<Task>& queue = queue_at(i).pinned[level];
+        while (count < max_count && !queue.empty()) {
+          tasks[count++] = std::move(queue.front());
+          queue.pop_front();
+        }
+      }
+    }
+    pinned_count_.fetch_sub(count);
+  }
+  if (count == max_count) {
+    // Nothing left to take
+  } else if (queue_type_ == QueueType::kLocked) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (lowest_first) {
+      for (size_t level = kTaskPriorityLevels; level-- > 0 && count == 0;) {
+        for (size_t i = 0; i < shared_queue_count_; ++i) {
+          std::deque<Task>& queue = queue_at(i).tasks[level];
+          if (!queue.empty()) {
+            tasks[count++] = std::move(queue.front());
+            queue.pop_front();
+            break;
+          }
+        }
+      }
+    }
+    for (size_t level = 0; level < kTaskPriorityLevels; ++level) {
+      for (size_t i = 0; i < shared_queue_count_; ++i) {
+        std::deque<Task>& queue = queue_at(i).tasks[level];
+        while (count < max_count && !queue.empty()) {
+          tasks[count++] = std::move(queue.front());
+          queue.pop_front();
+        }
+      }
+    }
+  } else {
+    if (lowest_first) {
+      for (size_t level = kTaskPriorityLevels; level-- > 0 && count == 0;) {
+        for (size_t i = 0; i < shared_queue_count_; ++i) {
+          MpmcQueue<Task>* ring = LockFreeLevel(queue_at(i), level, false);
+          if (ring != nullptr && ring->TryPop(tasks[count])) {
+            ++count;
+            break;
+          }
+        }
+      }
+    }
+    for (size_t level = 0; level < kTaskPriorityLevels; ++level) {
+      for (size_t i = 0; i < shared_queue_count_; ++i) {
+        MpmcQueue<Task>* ring = LockFreeLevel(queue_at(i), level, false);
+        while (ring != nullptr && count < max_count && ring->TryPop(tasks[count])) {
+          ++count;
+        }
+      }
+    }
+  }
+
+  if (count > 0) {
+    ReleaseQueueSlots(count);
+    if (starvation_limit_ > 0) {
+      dequeue_counter_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  return count;
+}
+
+size_t CallbackWorkerThread::TryGetTasks(WorkerContext* context, Task* tasks, size_t max_count) {
+  if (!work_stealing_) {
+    return TryPopSharedTasks(tasks, max_count, context->node);
+  }
+
+  // The own deque needs no lock, so batching it would only hide work from thieves
+  Task* owned = nullptr;
+  if (context->local_tasks.Pop(owned)) {
+    tasks[0] = WorkerContext::TakeLocalTask(owned);
+    ReleaseQueueSlots(1);
+    return 1;
+  }
+
+  size_t count = TryPopSharedTasks(tasks, max_count, context->node);
+  if (count > 0) {
+    return count;
+  }
+
+  // Steal from the other workers, starting at a random victim to spread contention
+  const size_t worker_count = worker_contexts_.size();
+  context->steal_seed ^= context->steal_seed << 13;
+  context->steal_seed ^= context->steal_seed >> 7;
+  context->steal_seed ^= context->steal_seed << 17;
+  const size_t start = static_cast<size_t>(context->steal_seed % worker_count);
+
+  for (size_t i = 0; i < worker_count; ++i) {
+    WorkerContext* victim = worker_contexts_[(start + i) % worker_count].get();
+    if (victim != context && victim->local_tasks.Steal(owned)) {
+      tasks[0] = WorkerContext::TakeLocalTask(owned);
+      ReleaseQueueSlots(1);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+bool CallbackWorkerThread::WaitForTask(bool* timed_out) {
+  // A retire request (elastic pools only) also ends the wait
+  auto work_or_stop = [this] {
+    return stop_.load(std::memory_order_relaxed) ||
+           queued_count_.load(std::memory_order_relaxed) > 0 ||
+           retire_requests_.load(std::memory_order_relaxed) > 0 || TimerDue();
+  };
+
+  // Poll before parking; only reads shared cache lines, so idle spinners do not slow producers
+  size_t spins = 0;
+  size_t yields = 0;
+  switch (wait_strategy_) {
+    case WaitStrategy::kBlock:
+      break;
+    case WaitStrategy::kSpinThenPark:
+      while (!work_or_stop() && spins++ < spin_iterations_) {
+        CpuRelax();
+      }
+      while (!work_or_stop() && yields++ < yield_iterations_) {
+        std::this_thread::yield();
+      }
+      break;
+    case WaitStrategy::kYield:
+      while (!work_or_stop()) {
+        std::this_thread::yield();
+      }
+      break;
+    case WaitStrategy::kBusySpin:
+      while (!work_or_stop()) {
+        CpuRelax();
+      }
+      break;
+  }
+
+  if (!work_or_stop()) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    sleeping_workers_.fetch_add(1);
+
+    // Wait for a task or stop flag; elastic pools give up after the keep-alive interval. While
+    // timers are armed, one parked worker (the timer leader) sleeps only until the next one is
+    // due, and wakes early if an earlier timer is armed; the others wake if it leaves.
+    auto woken = [this] {
+      return stop_ || queued_count_ > 0 || retire_requests_ > 0 ||
+             (!timer_leader_ && next_timer_ns_ != kNoTimer);
+    };
+    const uint64_t next_timer = next_timer_ns_.load();
+    if (next_timer != kNoTimer && !timer_leader_.exchange(true)) {
+      const auto due = std::chrono::steady_clock::time_point(
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::nanoseconds(next_timer)));
+      condition_.wait_until(lock, due, [this, next_timer] {
+        return stop_ || queued_count_ > 0 || retire_requests_ > 0 ||
+               next_timer_ns_ < next_timer;
+      });
+      timer_leader_ = false;
+      // This worker goes on to poll the wheel; hand leadership to a parked worker
+      condition_.notify_one();
+    } else if (timed_out != nullptr) {
+      *timed_out = !condition_.wait_for(lock, keep_alive_, woken);
+    } else {
+      condition_.wait(lock, woken);
+    }
+    sleeping_workers_.fetch_sub(1);
+  }
+
+  // Exit if stop flag is set and no tasks remain
+  return !(stop_ && queued_count_ == 0);
+}
+
+bool CallbackWorkerThread::RunTask(Task& task) {
+  // Enqueue'd tasks report exceptions through their futures, so only posted tasks get here
+  try {
+    task();
+    return true;
+  } catch (...) {
+    HandleTaskException(std::current_exception());
+    return false;
+  }
+}
+
+void CallbackWorkerThread::RunBatchMeasured(WorkerContext* context, Task* batch, size_t count) {
+  auto& metrics = context->metrics;
+
+  // One clock read per task: each task's end is the next task's start
+  uint64_t start = NowNs();
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t submitted = batch[i].timestamp();
+    if (submitted != 0 && submitted <= start) {
+      metrics.queue_wait.Record(start - submitted);
+    }
+
+    const bool completed = RunTask(batch[i]);
+    batch[i] = Task();
+
+    const uint64_t end = NowNs();
+    metrics.execution.Record(end - start);
+    AddOwned(metrics.busy_ns, end - start);
+    AddOwned(metrics.tasks_executed, 1);
+    if (!completed) {
+      AddOwned(metrics.exceptions, 1);
+    }
+    start = end;
+  }
+}
+
+void CallbackWorkerThread::WorkerThreadMain(WorkerContext* context) {
+  current_worker_ = context;
+  if (!context->cpus.empty()) {
+    // Best effort: a CPU outside the process's allowed set leaves the worker unpinned
+    SetCurrentThreadAffinity(context->cpus);
+  }
+
+  Task* const batch = context->batch.get();
+  size_t batch_limit = adaptive_dequeue_batch_ ? 1 : max_dequeue_batch_;
+
+  // Leave the slot for StartWorker to reuse. A wakeup meant for this worker may have been
+  // absorbed by it, so pass it on to a parked one.
+  auto retire = [this, context] {
+    WakeWorkers(queued_count_.load());
+    context->running.store(false, std::memory_order_release);
+  };
+
+  while (true) {
+    if (TimerDue()) {
+      PollTimers();
+    }
+    const size_t count = TryGetTasks(context, batch, batch_limit);
+
+    const bool measure = kMetricsCompiledIn && metrics_enabled_.load(std::memory_order_relaxed);
+
+    if (count == 0) {
+      const uint64_t idle_start = measure ? NowNs() : 0;
+      bool timed_out = false;
+      const bool keep_running = WaitForTask(elastic_ ? &timed_out : nullptr);
+      if (measure) {
+        AddOwned(context->metrics.idle_ns, NowNs() - idle_start);
+      }
+      if (!keep_running) {
+        return;
+      }
+      if (elastic_ && ShouldRetire(timed_out)) {
+        retire();
+        return;
+      }
+      continue;
+    }
+
+    if (grow_wait_threshold_ns_ != 0) {
+      // The oldest task of the batch tells how far behind the pool is
+      const uint64_t submitted = batch[0].timestamp();
+      if (submitted != 0 && NowNs() > submitted + grow_wait_threshold_ns_) {
+        MaybeGrow();
+      }
+    }
+
+    if (measure) {
+      RunBatchMeasured(context, batch, count);
+    } else {
+      // Run the batch back to back, releasing each task's captures as soon as it has run
+      for (size_t i = 0; i < count; ++i) {
+        RunTask(batch[i]);
+        batch[i] = Task();
+      }
+    }
+    FinishTasks(count);
+
+    // Tasks this worker spawned into its own deque must not be stranded there
+    if (elastic_ && retire_requests_.load(std::memory_order_relaxed) > 0 &&
+        context->local_tasks.Size() == 0 && ShouldRetire(false)) {
+      retire();
+      return;
+    }
+
+    if (adaptive_dequeue_batch_) {
+      // Grow while a backlog remains after a full batch; shrink when the queue runs short so
+      // that one worker does not sit on tasks other workers could be running
+      if (count == batch_limit && queued_count_.load(std::memory_order_relaxed) > 0) {
+        batch_limit = std::min(batch_limit * 2, max_dequeue_batch_);
+      } else if (count * 2 <= batch_limit) {
+        batch_limit = std::max<size_t>(batch_limit / 2, 1);
+      }
     }
   }
 }
 
-}  // namespace callback_worker_thread 
\ No newline at end of file
+}  // namespace callback_worker_thread
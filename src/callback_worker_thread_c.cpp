@@ -1,9 +1,13 @@
 #include "callback_worker_thread/callback_worker_thread_c.h"
 #include "callback_worker_thread/callback_worker_thread.h"
 
+#include <chrono>
 #include <cstring>
+#include <future>
+#include <memory>
 #include <new>
 #include <stdexcept>
+#include <utility>
 
 using namespace callback_worker_thread;
 
@@ -13,12 +17,153 @@ struct CallbackWorkerThreadC {
   
   explicit CallbackWorkerThreadC(size_t thread_count) 
       : worker(new(std::nothrow) CallbackWorkerThread(thread_count)) {}
+
+  explicit CallbackWorkerThreadC(const CallbackWorkerThreadOptions& options)
+      : worker(new(std::nothrow) CallbackWorkerThread(options)) {}
   
   ~CallbackWorkerThreadC() {
     delete worker;
   }
 };
 
+// Completion handle for a task enqueued through one of the *_async functions
+struct CallbackWorkerTaskHandle {
+  std::future<void> future;
+  // Pool the task was enqueued on; waits help it instead of blocking (see WaitHelping)
+  CallbackWorkerThread* pool = nullptr;
+  // Token of a cancellable task; an unrun task whose token is cancelled reports CANCELLED
+  CancellationToken token;
+  // Set once the future has been consumed; outcome then replaces it
+  bool resolved = false;
+  CallbackWorkerResult outcome = CALLBACK_WORKER_SUCCESS;
+};
+
+// Handle to a callback scheduled through callback_worker_enqueue_after/schedule_periodic
+struct CallbackWorkerTimer {
+  TimerHandle timer;
+};
+
+// Cancellation source handed out by callback_worker_cancel_source_create
+struct CallbackWorkerCancelSource {
+  CancellationSource source;
+};
+
+namespace {
+
+// Buffer handed over by the caller, released with the caller's free function
+class OwnedBuffer {
+ public:
+  OwnedBuffer(char* data, BufferFreeFunc free_func) : data_(data), free_func_(free_func) {}
+  OwnedBuffer(OwnedBuffer&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)), free_func_(other.free_func_) {}
+  OwnedBuffer(const OwnedBuffer&) = delete;
+  OwnedBuffer& operator=(const OwnedBuffer&) = delete;
+  OwnedBuffer& operator=(OwnedBuffer&&) = delete;
+
+  ~OwnedBuffer() {
+    if (data_ != nullptr && free_func_ != nullptr) {
+      free_func_(data_);
+    }
+  }
+
+  const char* get() const { return data_; }
+
+ private:
+  char* data_;
+  BufferFreeFunc free_func_;
+};
+
+// Copy a string into a task allocator block, which the worker frees without a malloc lock
+OwnedBuffer CopyString(const char* text) {
+  const size_t size = std::strlen(text) + 1;
+  auto* copy = static_cast<char*>(detail::TaskAllocate(size));
+  std::memcpy(copy, text, size);
+  return OwnedBuffer(copy, &detail::TaskDeallocate);
+}
+
+// Outcome of a completed task: success if its callback ran, CANCELLED or DROPPED if the task
+// was destroyed unrun
+CallbackWorkerResult TaskOutcome(CallbackWorkerTaskHandle* handle) {
+  if (!handle->resolved) {
+    try {
+      handle->future.get();
+      handle->outcome = CALLBACK_WORKER_SUCCESS;
+    } catch (const std::future_error&) {
+      handle->outcome = handle->token.IsCancellationRequested() ? CALLBACK_WORKER_ERROR_CANCELLED
+                                                                : CALLBACK_WORKER_ERROR_DROPPED;
+    } catch (...) {
+      handle->outcome = CALLBACK_WORKER_ERROR_UNKNOWN;
+    }
+    handle->resolved = true;
+  }
+  return handle->outcome;
+}
+
+// Enqueue a task without waiting for it and optionally hand out its completion handle
+template <typename F>
+CallbackWorkerResult EnqueueAsync(CallbackWorkerThreadC* worker,
+                                  F&& task,
+                                  CallbackWorkerTaskHandle** handle,
+                                  TaskPriority priority = TaskPriority::kNormal) {
+  try {
+    if (handle == nullptr) {
+      // Fire-and-forget: no future, and no allocation for small captures
+      worker->worker->Post(priority, std::forward<F>(task));
+      return CALLBACK_WORKER_SUCCESS;
+    }
+
+    // Allocate the handle first so that a failure cannot leave an untracked task behind
+    auto wrapper = std::make_unique<CallbackWorkerTaskHandle>();
+    wrapper->pool = worker->worker;
+    wrapper->future = worker->worker->Enqueue(priority, std::forward<F>(task));
+    *handle = wrapper.release();
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::runtime_error&) {
+    return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+// Enqueue a user_data callback that is skipped if token is cancelled before it starts
+CallbackWorkerResult EnqueueCancellableAsync(CallbackWorkerThreadC* worker,
+                                             const CancellationToken& token,
+                                             UserDataCallbackFunc callback,
+                                             void* user_data,
+                                             CallbackWorkerTaskHandle** handle) {
+  try {
+    if (handle == nullptr) {
+      worker->worker->Post(token, callback, user_data);
+      return CALLBACK_WORKER_SUCCESS;
+    }
+
+    auto wrapper = std::make_unique<CallbackWorkerTaskHandle>();
+    wrapper->pool = worker->worker;
+    wrapper->token = token;
+    wrapper->future = worker->worker->Enqueue(token, callback, user_data);
+    *handle = wrapper.release();
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::runtime_error&) {
+    return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+}  // namespace
+
 extern "C" {
 
 CallbackWorkerResult callback_worker_create(size_t thread_count, CallbackWorkerThreadC** worker) {
@@ -48,6 +193,104 @@ CallbackWorkerResult callback_worker_create(size_t thread_count, CallbackWorkerT
   }
 }
 
+CallbackWorkerResult callback_worker_create_bounded(size_t thread_count,
+                                                    size_t max_queue_size,
+                                                    CallbackWorkerOverflowPolicy policy,
+                                                    UserDataCallbackFunc drop_callback,
+                                                    void* drop_user_data,
+                                                    CallbackWorkerThreadC** worker) {
+  if (worker == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  if (thread_count == 0 || max_queue_size == 0) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  }
+
+  CallbackWorkerThreadOptions options;
+  options.thread_count = thread_count;
+  options.max_queue_size = max_queue_size;
+  switch (policy) {
+    case CALLBACK_WORKER_OVERFLOW_BLOCK:
+      options.overflow_policy = OverflowPolicy::kBlock;
+      break;
+    case CALLBACK_WORKER_OVERFLOW_REJECT:
+      options.overflow_policy = OverflowPolicy::kReject;
+      break;
+    case CALLBACK_WORKER_OVERFLOW_DROP_OLDEST:
+      options.overflow_policy = OverflowPolicy::kDropOldest;
+      break;
+    case CALLBACK_WORKER_OVERFLOW_CALLER_RUNS:
+      options.overflow_policy = OverflowPolicy::kCallerRuns;
+      break;
+    default:
+      return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  }
+
+  try {
+    if (drop_callback != nullptr) {
+      options.drop_handler = [drop_callback, drop_user_data]() {
+        drop_callback(drop_user_data);
+      };
+    }
+
+    auto* wrapper = new(std::nothrow) CallbackWorkerThreadC(options);
+    if (wrapper == nullptr || wrapper->worker == nullptr) {
+      delete wrapper;
+      return CALLBACK_WORKER_ERROR_MEMORY;
+    }
+
+    *worker = wrapper;
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::invalid_argument&) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_create_elastic(size_t min_threads,
+                                                    size_t max_threads,
+                                                    uint32_t keep_alive_ms,
+                                                    CallbackWorkerThreadC** worker) {
+  if (worker == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  if (min_threads == 0 || max_threads < min_threads) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  }
+
+  CallbackWorkerThreadOptions options;
+  options.thread_count = min_threads;
+  options.min_thread_count = min_threads;
+  options.max_thread_count = max_threads;
+  options.keep_alive = std::chrono::milliseconds(keep_alive_ms);
+
+  try {
+    auto* wrapper = new(std::nothrow) CallbackWorkerThreadC(options);
+    if (wrapper == nullptr || wrapper->worker == nullptr) {
+      delete wrapper;
+      return CALLBACK_WORKER_ERROR_MEMORY;
+    }
+
+    *worker = wrapper;
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::invalid_argument&) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
 CallbackWorkerResult callback_worker_destroy(CallbackWorkerThreadC* worker) {
   if (worker == nullptr) {
     return CALLBACK_WORKER_ERROR_NULL_POINTER;
@@ -77,17 +320,20 @@ CallbackWorkerResult callback_worker_enqueue_default(CallbackWorkerThreadC* work
   }
   
   try {
-    // Copy string for capture
-    std::string arg3_copy(arg3);
-    
-    auto future = worker->worker->Enqueue([callback, arg1, arg2, arg3_copy]() {
-      callback(arg1, arg2, arg3_copy.c_str());
+    // The call waits for the callback, so the caller's string outlives it: no copy needed
+    auto future = worker->worker->Enqueue([callback, arg1, arg2, arg3]() {
+      callback(arg1, arg2, arg3);
     });
     
-    // Discard future as we don't provide wait functionality in C interface
-    future.wait();
+    // Run queued tasks while waiting, so that a callback calling back in cannot deadlock
+    worker->worker->WaitHelping(future);
+    future.get();
     
     return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::future_error&) {
+    return CALLBACK_WORKER_ERROR_DROPPED;
   } catch (const std::runtime_error&) {
     return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
   } catch (const std::bad_alloc&) {
@@ -110,8 +356,13 @@ CallbackWorkerResult callback_worker_enqueue_no_arg(CallbackWorkerThreadC* worke
       callback();
     });
     
-    future.wait();
+    worker->worker->WaitHelping(future);
+    future.get();
     return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::future_error&) {
+    return CALLBACK_WORKER_ERROR_DROPPED;
   } catch (const std::runtime_error&) {
     return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
   } catch (const std::bad_alloc&) {
@@ -135,8 +386,13 @@ CallbackWorkerResult callback_worker_enqueue_int(CallbackWorkerThreadC* worker,
       callback(arg);
     });
     
-    future.wait();
+    worker->worker->WaitHelping(future);
+    future.get();
     return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::future_error&) {
+    return CALLBACK_WORKER_ERROR_DROPPED;
   } catch (const std::runtime_error&) {
     return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
   } catch (const std::bad_alloc&) {
@@ -162,8 +418,13 @@ CallbackWorkerResult callback_worker_enqueue_int_return_sync(CallbackWorkerThrea
       return callback(arg1, arg2);
     });
     
+    worker->worker->WaitHelping(future);
     *result = future.get();
     return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::future_error&) {
+    return CALLBACK_WORKER_ERROR_DROPPED;
   } catch (const std::runtime_error&) {
     return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
   } catch (const std::bad_alloc&) {
@@ -183,15 +444,18 @@ CallbackWorkerResult callback_worker_enqueue_string(CallbackWorkerThreadC* worke
   }
   
   try {
-    // Copy string for capture
-    std::string arg_copy(arg);
-    
-    auto future = worker->worker->Enqueue([callback, arg_copy]() {
-      callback(arg_copy.c_str());
+    // The call waits for the callback, so the caller's string outlives it: no copy needed
+    auto future = worker->worker->Enqueue([callback, arg]() {
+      callback(arg);
     });
     
-    future.wait();
+    worker->worker->WaitHelping(future);
+    future.get();
     return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::future_error&) {
+    return CALLBACK_WORKER_ERROR_DROPPED;
   } catch (const std::runtime_error&) {
     return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
   } catch (const std::bad_alloc&) {
@@ -203,6 +467,432 @@ CallbackWorkerResult callback_worker_enqueue_string(CallbackWorkerThreadC* worke
   }
 }
 
+CallbackWorkerResult callback_worker_enqueue_default_async(CallbackWorkerThreadC* worker,
+                                                            DefaultCallbackFunc callback,
+                                                            int arg1,
+                                                            double arg2,
+                                                            const char* arg3,
+                                                            CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || callback == nullptr || arg3 == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    // Copy string for capture; the caller's buffer may be gone by the time the task runs
+    OwnedBuffer arg3_copy = CopyString(arg3);
+
+    return EnqueueAsync(worker, [callback, arg1, arg2, arg3_copy = std::move(arg3_copy)]() {
+      callback(arg1, arg2, arg3_copy.get());
+    }, handle);
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_enqueue_no_arg_async(CallbackWorkerThreadC* worker,
+                                                           NoArgCallbackFunc callback,
+                                                           CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  return EnqueueAsync(worker, [callback]() {
+    callback();
+  }, handle);
+}
+
+CallbackWorkerResult callback_worker_enqueue_int_async(CallbackWorkerThreadC* worker,
+                                                        IntCallbackFunc callback,
+                                                        int arg,
+                                                        CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  return EnqueueAsync(worker, [callback, arg]() {
+    callback(arg);
+  }, handle);
+}
+
+CallbackWorkerResult callback_worker_enqueue_string_async(CallbackWorkerThreadC* worker,
+                                                           StringCallbackFunc callback,
+                                                           const char* arg,
+                                                           CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || callback == nullptr || arg == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    OwnedBuffer arg_copy = CopyString(arg);
+
+    return EnqueueAsync(worker, [callback, arg_copy = std::move(arg_copy)]() {
+      callback(arg_copy.get());
+    }, handle);
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_enqueue_string_owned(CallbackWorkerThreadC* worker,
+                                                           StringCallbackFunc callback,
+                                                           char* arg,
+                                                           BufferFreeFunc free_func,
+                                                           CallbackWorkerTaskHandle** handle) {
+  // Owned from here on, so that every failure below releases the buffer too
+  OwnedBuffer buffer(arg, free_func);
+  if (worker == nullptr || callback == nullptr || arg == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  return EnqueueAsync(worker, [callback, buffer = std::move(buffer)]() {
+    callback(buffer.get());
+  }, handle);
+}
+
+CallbackWorkerResult callback_worker_enqueue_batch(CallbackWorkerThreadC* worker,
+                                                    const CallbackWorkerBatchItem* items,
+                                                    size_t count,
+                                                    CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || (items == nullptr && count > 0)) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (items[i].callback == nullptr) {
+      return CALLBACK_WORKER_ERROR_NULL_POINTER;
+    }
+  }
+
+  auto run_item = [](const CallbackWorkerBatchItem& item) {
+    item.callback(item.user_data);
+  };
+
+  try {
+    if (handle == nullptr) {
+      worker->worker->PostBatch(run_item, items, items + count);
+      return CALLBACK_WORKER_SUCCESS;
+    }
+
+    auto wrapper = std::make_unique<CallbackWorkerTaskHandle>();
+    wrapper->pool = worker->worker;
+    wrapper->future = worker->worker->EnqueueBatchAll(run_item, items, items + count);
+    *handle = wrapper.release();
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const QueueFullError&) {
+    return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+  } catch (const std::runtime_error&) {
+    return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_enqueue_priority(CallbackWorkerThreadC* worker,
+                                                      CallbackWorkerPriority priority,
+                                                      UserDataCallbackFunc callback,
+                                                      void* user_data,
+                                                      CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  if (priority != CALLBACK_WORKER_PRIORITY_HIGH && priority != CALLBACK_WORKER_PRIORITY_NORMAL &&
+      priority != CALLBACK_WORKER_PRIORITY_LOW) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  }
+
+  // CallbackWorkerPriority values match TaskPriority
+  return EnqueueAsync(worker, [callback, user_data]() {
+    callback(user_data);
+  }, handle, static_cast<TaskPriority>(priority));
+}
+
+CallbackWorkerResult callback_worker_try_enqueue(CallbackWorkerThreadC* worker,
+                                                 UserDataCallbackFunc callback,
+                                                 void* user_data,
+                                                 CallbackWorkerTaskHandle** handle) {
+  return callback_worker_enqueue_timeout(worker, callback, user_data, 0, handle);
+}
+
+CallbackWorkerResult callback_worker_enqueue_timeout(CallbackWorkerThreadC* worker,
+                                                     UserDataCallbackFunc callback,
+                                                     void* user_data,
+                                                     uint32_t timeout_ms,
+                                                     CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  auto task = [callback, user_data]() {
+    callback(user_data);
+  };
+  const auto timeout = std::chrono::milliseconds(timeout_ms);
+
+  try {
+    if (handle == nullptr) {
+      bool posted = (timeout_ms == 0) ? worker->worker->TryPost(task)
+                                      : worker->worker->TryPostFor(timeout, task);
+      return posted ? CALLBACK_WORKER_SUCCESS : CALLBACK_WORKER_ERROR_QUEUE_FULL;
+    }
+
+    auto wrapper = std::make_unique<CallbackWorkerTaskHandle>();
+    wrapper->pool = worker->worker;
+    auto future = (timeout_ms == 0) ? worker->worker->TryEnqueue(task)
+                                    : worker->worker->TryEnqueueFor(timeout, task);
+    if (!future) {
+      return CALLBACK_WORKER_ERROR_QUEUE_FULL;
+    }
+    wrapper->future = std::move(*future);
+    *handle = wrapper.release();
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::runtime_error&) {
+    return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_task_poll(CallbackWorkerTaskHandle* handle, int* completed) {
+  if (handle == nullptr || completed == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    if (!handle->resolved &&
+        handle->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      *completed = 0;
+      return CALLBACK_WORKER_SUCCESS;
+    }
+    *completed = 1;
+    return TaskOutcome(handle);
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_task_wait(CallbackWorkerTaskHandle* handle) {
+  if (handle == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    // A ready future needs no pool, which may be gone already
+    if (!handle->resolved &&
+        handle->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      handle->pool->WaitHelping(handle->future);
+    }
+    return TaskOutcome(handle);
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_task_wait_timeout(CallbackWorkerTaskHandle* handle,
+                                                        uint32_t timeout_ms) {
+  if (handle == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    if (!handle->resolved &&
+        handle->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+        !handle->pool->WaitHelpingFor(handle->future, std::chrono::milliseconds(timeout_ms))) {
+      return CALLBACK_WORKER_ERROR_TIMEOUT;
+    }
+    return TaskOutcome(handle);
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_task_release(CallbackWorkerTaskHandle* handle) {
+  if (handle == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  delete handle;
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_cancel_source_create(CallbackWorkerCancelSource** source) {
+  if (source == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  *source = new (std::nothrow) CallbackWorkerCancelSource();
+  return *source != nullptr ? CALLBACK_WORKER_SUCCESS : CALLBACK_WORKER_ERROR_MEMORY;
+}
+
+CallbackWorkerResult callback_worker_cancel_source_cancel(CallbackWorkerCancelSource* source) {
+  if (source == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  source->source.RequestCancel();
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_cancel_source_is_cancelled(CallbackWorkerCancelSource* source,
+                                                                int* cancelled) {
+  if (source == nullptr || cancelled == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  *cancelled = source->source.IsCancellationRequested() ? 1 : 0;
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_cancel_source_release(CallbackWorkerCancelSource* source) {
+  if (source == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  delete source;
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_enqueue_cancellable(CallbackWorkerThreadC* worker,
+                                                         CallbackWorkerCancelSource* source,
+                                                         UserDataCallbackFunc callback,
+                                                         void* user_data,
+                                                         CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || source == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  return EnqueueCancellableAsync(worker, source->source.GetToken(), callback, user_data, handle);
+}
+
+CallbackWorkerResult callback_worker_enqueue_tagged(CallbackWorkerThreadC* worker,
+                                                    uint64_t tag,
+                                                    UserDataCallbackFunc callback,
+                                                    void* user_data,
+                                                    CallbackWorkerTaskHandle** handle) {
+  if (worker == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    return EnqueueCancellableAsync(worker, worker->worker->GetTagToken(tag), callback, user_data,
+                                   handle);
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  }
+}
+
+CallbackWorkerResult callback_worker_cancel_tag(CallbackWorkerThreadC* worker,
+                                                uint64_t tag,
+                                                int* cancelled) {
+  if (worker == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  const bool had_tasks = worker->worker->CancelTag(tag);
+  if (cancelled != nullptr) {
+    *cancelled = had_tasks ? 1 : 0;
+  }
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_enqueue_after(CallbackWorkerThreadC* worker,
+                                                   uint32_t delay_ms,
+                                                   UserDataCallbackFunc callback,
+                                                   void* user_data,
+                                                   CallbackWorkerTimer** timer) {
+  if (worker == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    auto wrapper = std::make_unique<CallbackWorkerTimer>();
+    wrapper->timer = worker->worker->EnqueueAfter(std::chrono::milliseconds(delay_ms),
+                                                  callback, user_data)
+                         .timer;
+    if (timer != nullptr) {
+      *timer = wrapper.release();
+    }
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::runtime_error&) {
+    return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_schedule_periodic(CallbackWorkerThreadC* worker,
+                                                       uint32_t interval_ms,
+                                                       UserDataCallbackFunc callback,
+                                                       void* user_data,
+                                                       CallbackWorkerTimer** timer) {
+  if (worker == nullptr || callback == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+  if (interval_ms == 0) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  }
+
+  try {
+    auto wrapper = std::make_unique<CallbackWorkerTimer>();
+    wrapper->timer = worker->worker->SchedulePeriodic(std::chrono::milliseconds(interval_ms),
+                                                      callback, user_data);
+    if (timer != nullptr) {
+      *timer = wrapper.release();
+    }
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::runtime_error&) {
+    return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_timer_cancel(CallbackWorkerTimer* timer, int* cancelled) {
+  if (timer == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  const bool prevented = timer->timer.Cancel();
+  if (cancelled != nullptr) {
+    *cancelled = prevented ? 1 : 0;
+  }
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_timer_release(CallbackWorkerTimer* timer) {
+  if (timer == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  delete timer;
+  return CALLBACK_WORKER_SUCCESS;
+}
+
 CallbackWorkerResult callback_worker_get_thread_count(CallbackWorkerThreadC* worker,
                                                        size_t* count) {
   if (worker == nullptr || count == nullptr) {
@@ -219,6 +909,25 @@ CallbackWorkerResult callback_worker_get_thread_count(CallbackWorkerThreadC* wor
   }
 }
 
+CallbackWorkerResult callback_worker_resize(CallbackWorkerThreadC* worker, size_t thread_count) {
+  if (worker == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    worker->worker->Resize(thread_count);
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::invalid_argument&) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  } catch (const std::runtime_error&) {
+    return CALLBACK_WORKER_ERROR_THREAD_STOPPED;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
 CallbackWorkerResult callback_worker_get_queue_size(CallbackWorkerThreadC* worker,
                                                      size_t* size) {
   if (worker == nullptr || size == nullptr) {
@@ -235,6 +944,89 @@ CallbackWorkerResult callback_worker_get_queue_size(CallbackWorkerThreadC* worke
   }
 }
 
+CallbackWorkerResult callback_worker_set_metrics_enabled(CallbackWorkerThreadC* worker,
+                                                         int enabled) {
+  if (worker == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  worker->worker->SetMetricsEnabled(enabled != 0);
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_get_worker_metrics(CallbackWorkerThreadC* worker,
+                                                        CallbackWorkerWorkerMetrics* metrics,
+                                                        size_t capacity,
+                                                        size_t* count) {
+  if (worker == nullptr || count == nullptr || (metrics == nullptr && capacity > 0)) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    const MetricsSnapshot snapshot = worker->worker->GetMetrics();
+    *count = snapshot.workers.size();
+    for (size_t i = 0; i < capacity && i < snapshot.workers.size(); ++i) {
+      const WorkerMetrics& source = snapshot.workers[i];
+      metrics[i].tasks_executed = source.tasks_executed;
+      metrics[i].exceptions = source.exceptions;
+      metrics[i].busy_ns = source.busy_ns;
+      metrics[i].idle_ns = source.idle_ns;
+    }
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_get_allocator_stats(CallbackWorkerAllocatorStats* stats) {
+  if (stats == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  const TaskAllocatorStats snapshot = GetTaskAllocatorStats();
+  stats->slab_allocations = snapshot.slab_allocations;
+  stats->large_allocations = snapshot.large_allocations;
+  stats->remote_free_batches = snapshot.remote_free_batches;
+  stats->reserved_bytes = snapshot.reserved_bytes;
+  stats->thread_caches = snapshot.thread_caches;
+  return CALLBACK_WORKER_SUCCESS;
+}
+
+CallbackWorkerResult callback_worker_get_metrics(CallbackWorkerThreadC* worker,
+                                                 CallbackWorkerMetrics* metrics) {
+  if (worker == nullptr || metrics == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    const MetricsSnapshot snapshot = worker->worker->GetMetrics();
+    metrics->enabled = snapshot.enabled ? 1 : 0;
+    metrics->thread_count = worker->worker->GetThreadCount();
+    metrics->queue_size = snapshot.queue_size;
+    metrics->tasks_executed = snapshot.total.tasks_executed;
+    metrics->exceptions = snapshot.total.exceptions;
+    metrics->busy_ns = snapshot.total.busy_ns;
+    metrics->idle_ns = snapshot.total.idle_ns;
+    metrics->queue_wait_p50_ns = snapshot.queue_wait.Percentile(0.50);
+    metrics->queue_wait_p99_ns = snapshot.queue_wait.Percentile(0.99);
+    metrics->queue_wait_max_ns = snapshot.queue_wait.max;
+    metrics->execution_p50_ns = snapshot.execution.Percentile(0.50);
+    metrics->execution_p99_ns = snapshot.execution.Percentile(0.99);
+    metrics->execution_max_ns = snapshot.execution.max;
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::bad_alloc&) {
+    return CALLBACK_WORKER_ERROR_MEMORY;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
 CallbackWorkerResult callback_worker_stop(CallbackWorkerThreadC* worker) {
   if (worker == nullptr) {
     return CALLBACK_WORKER_ERROR_NULL_POINTER;
@@ -265,6 +1057,42 @@ CallbackWorkerResult callback_worker_wait_completion(CallbackWorkerThreadC* work
   }
 }
 
+CallbackWorkerResult callback_worker_wait_idle(CallbackWorkerThreadC* worker) {
+  if (worker == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    worker->worker->WaitIdle();
+    return CALLBACK_WORKER_SUCCESS;
+  } catch (const std::logic_error&) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
+CallbackWorkerResult callback_worker_wait_idle_timeout(CallbackWorkerThreadC* worker,
+                                                       uint32_t timeout_ms) {
+  if (worker == nullptr) {
+    return CALLBACK_WORKER_ERROR_NULL_POINTER;
+  }
+
+  try {
+    return worker->worker->WaitIdleFor(std::chrono::milliseconds(timeout_ms))
+               ? CALLBACK_WORKER_SUCCESS
+               : CALLBACK_WORKER_ERROR_TIMEOUT;
+  } catch (const std::logic_error&) {
+    return CALLBACK_WORKER_ERROR_INVALID_PARAM;
+  } catch (const std::exception&) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  } catch (...) {
+    return CALLBACK_WORKER_ERROR_UNKNOWN;
+  }
+}
+
 const char* callback_worker_result_to_string(CallbackWorkerResult result) {
   switch (result) {
     case CALLBACK_WORKER_SUCCESS:
@@ -279,6 +1107,14 @@ const char* callback_worker_result_to_string(CallbackWorkerResult result) {
       return "Memory allocation error";
     case CALLBACK_WORKER_ERROR_UNKNOWN:
       return "Unknown error";
+    case CALLBACK_WORKER_ERROR_TIMEOUT:
+      return "Timed out";
+    case CALLBACK_WORKER_ERROR_QUEUE_FULL:
+      return "Queue is full";
+    case CALLBACK_WORKER_ERROR_DROPPED:
+      return "Task was dropped before it ran";
+    case CALLBACK_WORKER_ERROR_CANCELLED:
+      return "Task was cancelled before it ran";
     default:
       return "Undefined error";
   }
@@ -0,0 +1,179 @@
+#include "callback_worker_thread/cpu_topology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace callback_worker_thread {
+
+namespace {
+
+#if defined(__linux__)
+// Read a whole sysfs file; empty if it does not exist
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+#endif
+
+// Every CPU the machine reports, for platforms without topology information
+std::vector<int> AllCpus() {
+  const unsigned count = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<int> cpus(count);
+  for (unsigned i = 0; i < count; ++i) {
+    cpus[i] = static_cast<int>(i);
+  }
+  return cpus;
+}
+
+}  // namespace
+
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(),
+                               [](unsigned char c) { return std::isspace(c) != 0; }),
+                range.end());
+    if (range.empty()) {
+      continue;
+    }
+
+    char* end = nullptr;
+    const long first = std::strtol(range.c_str(), &end, 10);
+    long last = first;
+    if (*end == '-') {
+      const char* second = end + 1;
+      last = std::strtol(second, &end, 10);
+      if (end == second) {
+        continue;
+      }
+    }
+    if (*end != '\0' || first < 0 || last < first) {
+      continue;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+CpuTopology CpuTopology::FromNodes(std::vector<std::vector<int>> node_cpus) {
+  CpuTopology topology;
+  for (auto& cpus : node_cpus) {
+    if (cpus.empty()) {
+      continue;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    const size_t node = topology.nodes.size();
+    for (int cpu : cpus) {
+      if (cpu < 0) {
+        continue;
+      }
+      if (static_cast<size_t>(cpu) >= topology.node_of_cpu.size()) {
+        topology.node_of_cpu.resize(static_cast<size_t>(cpu) + 1, 0);
+      }
+      topology.node_of_cpu[static_cast<size_t>(cpu)] = node;
+    }
+    topology.nodes.push_back(std::move(cpus));
+  }
+  if (topology.nodes.empty()) {
+    return FromNodes({AllCpus()});
+  }
+  return topology;
+}
+
+CpuTopology CpuTopology::Detect() {
+  std::vector<std::vector<int>> node_cpus;
+#if defined(__linux__)
+  // Node ids may have gaps (e.g. memory-only nodes), so walk the "possible" list
+  const std::vector<int> node_ids =
+      ParseCpuList(ReadFile("/sys/devices/system/node/possible"));
+  for (int id : node_ids) {
+    node_cpus.push_back(ParseCpuList(
+        ReadFile("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist")));
+  }
+#endif
+  return FromNodes(std::move(node_cpus));
+}
+
+CpuTopology CpuTopology::Restrict(const std::vector<int>& cpus) const {
+  if (cpus.empty()) {
+    return *this;
+  }
+
+  std::vector<std::vector<int>> node_cpus(nodes.size());
+  bool any_known = false;
+  for (int cpu : cpus) {
+    if (cpu >= 0 && static_cast<size_t>(cpu) < node_of_cpu.size()) {
+      const size_t node = NodeOfCpu(cpu);
+      if (std::binary_search(nodes[node].begin(), nodes[node].end(), cpu)) {
+        node_cpus[node].push_back(cpu);
+        any_known = true;
+      }
+    }
+  }
+  if (!any_known) {
+    return FromNodes({cpus});
+  }
+  return FromNodes(std::move(node_cpus));
+}
+
+bool SetCurrentThreadAffinity(const std::vector<int>& cpus) {
+  if (cpus.empty()) {
+    return false;
+  }
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+      return false;
+    }
+    mask |= DWORD_PTR{1} << cpu;
+  }
+  return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+  return false;
+#endif
+}
+
+int GetCurrentCpu() {
+#if defined(__linux__)
+  return sched_getcpu();
+#elif defined(_WIN32)
+  return static_cast<int>(GetCurrentProcessorNumber());
+#else
+  return -1;
+#endif
+}
+
+}  // namespace callback_worker_thread
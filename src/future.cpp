@@ -0,0 +1,39 @@
+#include "callback_worker_thread/future.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+
+namespace callback_worker_thread {
+
+namespace detail {
+
+std::shared_ptr<PoolAnchor> AnchorOf(CallbackWorkerThread& pool) { return pool.anchor_; }
+
+void ScheduleContinuation(const std::shared_ptr<PoolAnchor>& anchor, Task&& task) {
+  // Destroyed after the submission is over, so that the continuations of a broken promise
+  // never run while the pool's destructor waits for submitters
+  Task discarded;
+  anchor->submitters.fetch_add(1);
+  CallbackWorkerThread* pool = anchor->pool.load();
+  if (pool == nullptr) {
+    discarded = std::move(task);
+  } else {
+    try {
+      pool->PushTask(std::move(task), TaskPriority::kNormal,
+                     CallbackWorkerThread::AdmitMode::kForce);
+    } catch (const std::runtime_error&) {
+      // Stopped pool: the continuation is destroyed unrun, which breaks its promise
+      discarded = std::move(task);
+    } catch (...) {
+      anchor->submitters.fetch_sub(1);
+      throw;
+    }
+  }
+  anchor->submitters.fetch_sub(1);
+}
+
+}  // namespace detail
+
+}  // namespace callback_worker_thread
@@ -0,0 +1,153 @@
+#include "callback_worker_thread/parallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+
+namespace callback_worker_thread {
+
+namespace detail {
+
+struct ParallelJob {
+  ParallelJob(CallbackWorkerThread& job_pool, size_t job_grain, RangeBody job_body)
+      : pool(job_pool), grain(job_grain), body(job_body) {}
+
+  // Upper half split off by Process; run by whoever claims it first (a worker or its owner)
+  struct Chunk {
+    Chunk(ParallelJob* chunk_job, size_t chunk_begin, size_t chunk_end)
+        : job(chunk_job), begin(chunk_begin), end(chunk_end) {}
+
+    ParallelJob* job;
+    size_t begin;
+    size_t end;
+    std::atomic<bool> claimed{false};
+  };
+
+  // Split [begin, end) down to the grain, run the lower part, then take back unclaimed halves
+  void Process(size_t begin, size_t end);
+
+  // Submit a chunk as a pool task; false if the pool is stopped
+  bool Spawn(const std::shared_ptr<Chunk>& chunk);
+
+  // Run the body on one chunk unless an earlier chunk failed
+  void Run(size_t begin, size_t end);
+
+  // Mark a claimed range as done
+  void Finish();
+
+  CallbackWorkerThread& pool;
+  const size_t grain;
+  const RangeBody body;
+  // Spawned chunks not finished yet, plus one for the caller's own range; it only reaches 0
+  // under mutex so that the waiting caller cannot return (destroying the job) early
+  std::atomic<size_t> outstanding{1};
+  std::mutex mutex;
+  std::condition_variable done;
+  // Set once the pool refuses a chunk; the rest of the loop runs unsplit
+  std::atomic<bool> stopped{false};
+  // Set by the first chunk that throws; later chunks are skipped
+  std::atomic<bool> failed{false};
+  std::exception_ptr exception;
+};
+
+namespace {
+
+// Halvings are bounded by the bits of size_t, so the pending halves fit on the stack
+constexpr size_t kMaxSplitDepth = 64;
+
+// Chunks per thread chosen by automatic grain sizing
+constexpr size_t kChunksPerThread = 8;
+
+}  // namespace
+
+void ParallelJob::Process(size_t begin, size_t end) {
+  std::shared_ptr<Chunk> spawned[kMaxSplitDepth];
+  size_t count = 0;
+  while (end - begin > grain && count < kMaxSplitDepth &&
+         !stopped.load(std::memory_order_relaxed)) {
+    const size_t middle = begin + (end - begin) / 2;
+    auto chunk = std::make_shared<Chunk>(this, middle, end);
+    if (!Spawn(chunk)) {
+      break;
+    }
+    spawned[count++] = std::move(chunk);
+    end = middle;
+  }
+  Run(begin, end);
+
+  // Newest halves first: they are the smallest and the least likely to have been taken
+  while (count > 0) {
+    const std::shared_ptr<Chunk>& chunk = spawned[--count];
+    if (!chunk->claimed.exchange(true, std::memory_order_acq_rel)) {
+      Process(chunk->begin, chunk->end);
+      Finish();
+    }
+  }
+}
+
+bool ParallelJob::Spawn(const std::shared_ptr<Chunk>& chunk) {
+  outstanding.fetch_add(1, std::memory_order_relaxed);
+  try {
+    // The chunk is shared so that a task whose chunk was taken back can still check the flag
+    // after the job is gone
+    pool.PushTask(Task([chunk]() {
+                    if (!chunk->claimed.exchange(true, std::memory_order_acq_rel)) {
+                      chunk->job->Process(chunk->begin, chunk->end);
+                      chunk->job->Finish();
+                    }
+                  }),
+                  TaskPriority::kNormal, CallbackWorkerThread::AdmitMode::kForce);
+  } catch (const std::runtime_error&) {
+    outstanding.fetch_sub(1, std::memory_order_relaxed);
+    stopped.store(true, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void ParallelJob::Run(size_t begin, size_t end) {
+  if (failed.load(std::memory_order_relaxed)) {
+    return;
+  }
+  try {
+    body.invoke(body.context, begin, end);
+  } catch (...) {
+    if (!failed.exchange(true)) {
+      exception = std::current_exception();
+    }
+  }
+}
+
+void ParallelJob::Finish() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    done.notify_all();
+  }
+}
+
+void ParallelRange(CallbackWorkerThread& pool, size_t count, size_t grain, RangeBody body) {
+  if (count == 0) {
+    return;
+  }
+  if (grain == 0) {
+    // The caller counts as a thread too
+    grain = std::max<size_t>(count / (kChunksPerThread * (pool.GetThreadCount() + 1)), 1);
+  }
+
+  ParallelJob job(pool, grain, body);
+  job.Process(0, count);
+  job.Finish();
+  {
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.done.wait(lock, [&job] { return job.outstanding.load(std::memory_order_acquire) == 0; });
+  }
+  if (job.exception != nullptr) {
+    std::rethrow_exception(job.exception);
+  }
+}
+
+}  // namespace detail
+
+}  // namespace callback_worker_thread
@@ -0,0 +1,100 @@
+#include "callback_worker_thread/strand.h"
+
+#include <mutex>
+#include <utility>
+
+namespace callback_worker_thread {
+
+namespace detail {
+
+struct StrandState {
+  explicit StrandState(CallbackWorkerThread& owner) : pool(owner) {}
+
+  CallbackWorkerThread& pool;
+  std::mutex mutex;
+  // Tasks submitted since the drain task last took the queue (guarded by mutex)
+  std::vector<Task> pending;
+  // Set while a drain task is queued or running (guarded by mutex)
+  bool scheduled = false;
+  // Tasks being run by the drain task; swapped with pending so both keep their capacity
+  std::vector<Task> running;
+};
+
+}  // namespace detail
+
+namespace {
+
+// Strand whose drain task the calling thread is running
+thread_local const detail::StrandState* current_strand = nullptr;
+
+}  // namespace
+
+void Strand::Drain(const std::shared_ptr<detail::StrandState>& state) {
+  const detail::StrandState* const outer = current_strand;
+  current_strand = state.get();
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->running.swap(state->pending);
+    }
+    for (Task& task : state->running) {
+      state->pool.RunTask(task);
+      task = Task();
+    }
+    state->running.clear();
+
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->pending.empty()) {
+        state->scheduled = false;
+        break;
+      }
+    }
+    // More arrived: re-post rather than loop, so one busy strand cannot monopolize a worker
+    try {
+      state->pool.PushTask([state]() { Drain(state); }, TaskPriority::kNormal,
+                           CallbackWorkerThread::AdmitMode::kForce);
+      break;
+    } catch (const std::runtime_error&) {
+      // Stopping: finish the strand's work on this worker instead
+    }
+  }
+  current_strand = outer;
+}
+
+Strand::Strand(CallbackWorkerThread& pool)
+    : state_(std::make_shared<detail::StrandState>(pool)) {}
+
+bool Strand::RunningInThisThread() const {
+  return current_strand == state_.get();
+}
+
+void Strand::Submit(Task&& task) {
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->pending.push_back(std::move(task));
+    schedule = !state_->scheduled;
+    state_->scheduled = true;
+  }
+  if (!schedule) {
+    return;
+  }
+
+  try {
+    // A bounded queue never rejects the drain task: it carries tasks already accepted
+    state_->pool.PushTask([state = state_]() { Drain(state); }, TaskPriority::kNormal,
+                          CallbackWorkerThread::AdmitMode::kForce);
+  } catch (...) {
+    // The pool is stopped; nothing queued on this strand can run any more
+    std::vector<Task> discarded;
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      state_->scheduled = false;
+      discarded.swap(state_->pending);
+    }
+    throw;
+  }
+}
+
+}  // namespace callback_worker_thread
@@ -0,0 +1,255 @@
+#include "callback_worker_thread/task_allocator.h"
+
+#include <atomic>
+#include <cstddef>
+
+#include "callback_worker_thread/mpmc_queue.h"
+
+namespace callback_worker_thread {
+
+#if defined(CALLBACK_WORKER_THREAD_NO_TASK_ALLOCATOR)
+
+TaskAllocatorStats GetTaskAllocatorStats() { return TaskAllocatorStats(); }
+
+#else
+
+namespace {
+
+// Block sizes including the header, smallest first
+constexpr size_t kSizeClasses[] = {64, 128, 256, 512, 1024};
+constexpr size_t kSizeClassCount = sizeof(kSizeClasses) / sizeof(kSizeClasses[0]);
+
+// Bytes requested from the system per slab; every slab serves a single size class
+constexpr size_t kSlabSize = 16 * 1024;
+
+struct ThreadCache;
+
+// Precedes every block; written once when a slab is carved (or on a large allocation)
+struct alignas(std::max_align_t) BlockHeader {
+  ThreadCache* owner;  // nullptr for blocks from operator new
+  size_t size_class;
+};
+
+static_assert(kSizeClasses[kSizeClassCount - 1] - sizeof(BlockHeader) == kMaxTaskBlockSize,
+              "kMaxTaskBlockSize must match the largest size class");
+
+// Link stored in the payload of a free block
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+// Chains the slabs of a cache so that they can be released with it
+struct alignas(std::max_align_t) SlabHeader {
+  SlabHeader* next;
+};
+
+struct ThreadCache {
+  // Owner thread only
+  FreeBlock* free_lists[kSizeClassCount] = {};
+  SlabHeader* slabs = nullptr;
+  // Blocks handed out and not back in a local free list yet; published when the thread exits
+  size_t outstanding = 0;
+
+  // Blocks freed by other threads, taken back by the owner in one exchange; kRetired once the
+  // owner thread has exited
+  alignas(kCacheLineSize) std::atomic<FreeBlock*> remote_free{nullptr};
+  // Blocks still in use after the owner exited, less those freed since (modulo 2^N: frees may
+  // arrive before the owner publishes its count). Only touched after retirement, on its own
+  // line so that remote frees before then stay off it. The cache is released when it reaches 0.
+  alignas(kCacheLineSize) std::atomic<size_t> orphaned{0};
+};
+
+// remote_free value of a retired cache
+FreeBlock retired_marker;
+FreeBlock* const kRetired = &retired_marker;
+
+std::atomic<uint64_t> slab_allocations{0};
+std::atomic<uint64_t> large_allocations{0};
+std::atomic<uint64_t> remote_free_batches{0};
+std::atomic<size_t> reserved_bytes{0};
+std::atomic<size_t> thread_caches{0};
+
+// Kept trivially destructible so that it can still be read while the thread exits
+thread_local ThreadCache* current_cache = nullptr;
+thread_local bool cache_retired = false;
+
+void DestroyCache(ThreadCache* cache) noexcept {
+  SlabHeader* slab = cache->slabs;
+  while (slab != nullptr) {
+    SlabHeader* next = slab->next;
+    ::operator delete(slab);
+    reserved_bytes.fetch_sub(kSlabSize, std::memory_order_relaxed);
+    slab = next;
+  }
+  delete cache;
+  thread_caches.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t CountBlocks(const FreeBlock* block) {
+  size_t count = 0;
+  for (; block != nullptr; block = block->next) {
+    ++count;
+  }
+  return count;
+}
+
+// Closes the remote-free list on thread exit and hands the count of blocks still in use to
+// their freers; the cache is released once they are all back
+void RetireCache(ThreadCache* cache) noexcept {
+  FreeBlock* returned = cache->remote_free.exchange(kRetired, std::memory_order_acq_rel);
+  const size_t in_use = cache->outstanding - CountBlocks(returned);
+  if (cache->orphaned.fetch_add(in_use, std::memory_order_acq_rel) + in_use == 0) {
+    DestroyCache(cache);
+  }
+}
+
+struct CacheRetirer {
+  ~CacheRetirer() {
+    cache_retired = true;
+    if (current_cache != nullptr) {
+      ThreadCache* cache = current_cache;
+      current_cache = nullptr;
+      RetireCache(cache);
+    }
+  }
+};
+
+thread_local CacheRetirer cache_retirer;
+
+ThreadCache* GetThreadCache() {
+  if (current_cache == nullptr && !cache_retired) {
+    // Touching the retirer registers its destructor for this thread
+    static_cast<void>(&cache_retirer);
+    current_cache = new ThreadCache();
+    thread_caches.fetch_add(1, std::memory_order_relaxed);
+  }
+  return current_cache;
+}
+
+size_t SizeClassOf(size_t size) {
+  const size_t total = size + sizeof(BlockHeader);
+  size_t size_class = 0;
+  while (kSizeClasses[size_class] < total) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+void* AllocateLarge(size_t size) {
+  void* raw = ::operator new(sizeof(BlockHeader) + size);
+  large_allocations.fetch_add(1, std::memory_order_relaxed);
+  return ::new (raw) BlockHeader{nullptr, 0} + 1;
+}
+
+// Move the blocks other threads have freed into the local free lists
+void TakeRemoteFrees(ThreadCache* cache) {
+  FreeBlock* block = cache->remote_free.exchange(nullptr, std::memory_order_acquire);
+  if (block == nullptr) {
+    return;
+  }
+  while (block != nullptr) {
+    FreeBlock* next = block->next;
+    const size_t size_class = (reinterpret_cast<BlockHeader*>(block) - 1)->size_class;
+    block->next = cache->free_lists[size_class];
+    cache->free_lists[size_class] = block;
+    --cache->outstanding;
+    block = next;
+  }
+  remote_free_batches.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Carve a new slab into free blocks of one size class
+void RefillFromSlab(ThreadCache* cache, size_t size_class) {
+  auto* slab = static_cast<SlabHeader*>(::operator new(kSlabSize));
+  slab->next = cache->slabs;
+  cache->slabs = slab;
+  slab_allocations.fetch_add(1, std::memory_order_relaxed);
+  reserved_bytes.fetch_add(kSlabSize, std::memory_order_relaxed);
+
+  const size_t block_size = kSizeClasses[size_class];
+  unsigned char* cursor = reinterpret_cast<unsigned char*>(slab + 1);
+  unsigned char* const end = reinterpret_cast<unsigned char*>(slab) + kSlabSize;
+  FreeBlock* head = cache->free_lists[size_class];
+  for (; cursor + block_size <= end; cursor += block_size) {
+    auto* header = ::new (cursor) BlockHeader{cache, size_class};
+    auto* block = ::new (header + 1) FreeBlock{head};
+    head = block;
+  }
+  cache->free_lists[size_class] = head;
+}
+
+}  // namespace
+
+namespace detail {
+
+void* TaskAllocate(size_t size) {
+  if (size > kMaxTaskBlockSize) {
+    return AllocateLarge(size);
+  }
+  ThreadCache* cache = GetThreadCache();
+  if (cache == nullptr) {
+    // The thread is exiting and its cache is gone
+    return AllocateLarge(size);
+  }
+
+  const size_t size_class = SizeClassOf(size);
+  if (cache->free_lists[size_class] == nullptr) {
+    TakeRemoteFrees(cache);
+    if (cache->free_lists[size_class] == nullptr) {
+      RefillFromSlab(cache, size_class);
+    }
+  }
+  FreeBlock* block = cache->free_lists[size_class];
+  cache->free_lists[size_class] = block->next;
+  ++cache->outstanding;
+  return block;
+}
+
+void TaskDeallocate(void* block) noexcept {
+  if (block == nullptr) {
+    return;
+  }
+  BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+  ThreadCache* owner = header->owner;
+  if (owner == nullptr) {
+    ::operator delete(header);
+    return;
+  }
+
+  auto* free_block = ::new (block) FreeBlock{nullptr};
+  if (owner == current_cache) {
+    free_block->next = owner->free_lists[header->size_class];
+    owner->free_lists[header->size_class] = free_block;
+    --owner->outstanding;
+    return;
+  }
+
+  FreeBlock* head = owner->remote_free.load(std::memory_order_relaxed);
+  do {
+    if (head == kRetired) {
+      // The owner has exited; the last block back releases its slabs
+      if (owner->orphaned.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        DestroyCache(owner);
+      }
+      return;
+    }
+    free_block->next = head;
+  } while (!owner->remote_free.compare_exchange_weak(head, free_block, std::memory_order_release,
+                                                     std::memory_order_acquire));
+}
+
+}  // namespace detail
+
+TaskAllocatorStats GetTaskAllocatorStats() {
+  TaskAllocatorStats stats;
+  stats.slab_allocations = slab_allocations.load(std::memory_order_relaxed);
+  stats.large_allocations = large_allocations.load(std::memory_order_relaxed);
+  stats.remote_free_batches = remote_free_batches.load(std::memory_order_relaxed);
+  stats.reserved_bytes = reserved_bytes.load(std::memory_order_relaxed);
+  stats.thread_caches = thread_caches.load(std::memory_order_relaxed);
+  return stats;
+}
+
+#endif
+
+}  // namespace callback_worker_thread
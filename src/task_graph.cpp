@@ -0,0 +1,188 @@
+#include "callback_worker_thread/task_graph.h"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace callback_worker_thread {
+
+namespace detail {
+
+struct GraphRun {
+  GraphRun(const TaskGraph& run_graph, CallbackWorkerThread& run_pool)
+      : graph(run_graph),
+        pool(run_pool),
+        pending(new std::atomic<size_t>[run_graph.nodes_.size()]),
+        remaining(run_graph.nodes_.size()) {
+    for (size_t i = 0; i < graph.nodes_.size(); ++i) {
+      pending[i].store(graph.nodes_[i].predecessor_count, std::memory_order_relaxed);
+    }
+  }
+
+  // Run a node, then keep running one released successor on this thread
+  static void Execute(const std::shared_ptr<GraphRun>& run, TaskGraph::NodeId node);
+
+  // Finish a node: release its successors and complete the run after the last node
+  TaskGraph::NodeId Release(const std::shared_ptr<GraphRun>& run, TaskGraph::NodeId node);
+
+  // Submit released nodes to the pool as one batch
+  void Submit(const std::shared_ptr<GraphRun>& run, const TaskGraph::NodeId* nodes,
+              size_t count);
+
+  const TaskGraph& graph;
+  CallbackWorkerThread& pool;
+  // Unfinished predecessors of each node
+  std::unique_ptr<std::atomic<size_t>[]> pending;
+  // Nodes that have not finished (or been skipped)
+  std::atomic<size_t> remaining;
+  // Set by the first node that throws; later nodes are skipped
+  std::atomic<bool> failed{false};
+  std::exception_ptr exception;
+  std::promise<void> done;
+};
+
+namespace {
+
+// No node id
+constexpr TaskGraph::NodeId kNoNode = static_cast<TaskGraph::NodeId>(-1);
+
+// Released successors buffered before they are submitted as one batch
+constexpr size_t kReleaseBatch = 16;
+
+Task NodeTask(const std::shared_ptr<GraphRun>& run, TaskGraph::NodeId node) {
+  return Task([run, node]() { GraphRun::Execute(run, node); });
+}
+
+}  // namespace
+
+void GraphRun::Execute(const std::shared_ptr<GraphRun>& run, TaskGraph::NodeId node) {
+  while (node != kNoNode) {
+    if (!run->failed.load(std::memory_order_relaxed)) {
+      try {
+        run->graph.nodes_[node].work();
+      } catch (...) {
+        if (!run->failed.exchange(true)) {
+          run->exception = std::current_exception();
+        }
+      }
+    }
+    node = run->Release(run, node);
+  }
+}
+
+TaskGraph::NodeId GraphRun::Release(const std::shared_ptr<GraphRun>& run,
+                                    TaskGraph::NodeId node) {
+  TaskGraph::NodeId next = kNoNode;
+  TaskGraph::NodeId released[kReleaseBatch];
+  size_t count = 0;
+  for (TaskGraph::NodeId successor : graph.nodes_[node].successors) {
+    if (pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      continue;
+    }
+    if (next == kNoNode) {
+      next = successor;
+      continue;
+    }
+    released[count++] = successor;
+    if (count == kReleaseBatch) {
+      Submit(run, released, count);
+      count = 0;
+    }
+  }
+  Submit(run, released, count);
+
+  // The acq_rel decrement orders every node's effects before the future becomes ready
+  if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    if (exception != nullptr) {
+      done.set_exception(exception);
+    } else {
+      done.set_value();
+    }
+  }
+  return next;
+}
+
+void GraphRun::Submit(const std::shared_ptr<GraphRun>& run, const TaskGraph::NodeId* nodes,
+                      size_t count) {
+  if (count == 0) {
+    return;
+  }
+  Task tasks[kReleaseBatch];
+  for (size_t i = 0; i < count; ++i) {
+    tasks[i] = NodeTask(run, nodes[i]);
+  }
+  try {
+    pool.PushTasks(tasks, count, TaskPriority::kNormal, CallbackWorkerThread::AdmitMode::kForce);
+  } catch (const std::runtime_error&) {
+    // The pool is stopping: run the nodes here so that the run still completes
+    for (size_t i = 0; i < count; ++i) {
+      tasks[i]();
+    }
+  }
+}
+
+}  // namespace detail
+
+void TaskGraph::Precede(NodeId before, NodeId after) {
+  if (before >= nodes_.size() || after >= nodes_.size()) {
+    throw std::out_of_range("Task graph node does not exist");
+  }
+  if (before == after) {
+    throw std::invalid_argument("A task graph node cannot precede itself");
+  }
+  nodes_[before].successors.push_back(after);
+  ++nodes_[after].predecessor_count;
+  validated_ = false;
+}
+
+void TaskGraph::Validate() {
+  if (validated_) {
+    return;
+  }
+
+  // Kahn's algorithm: every node is reached from the sources iff there is no cycle
+  std::vector<size_t> pending(nodes_.size());
+  std::vector<NodeId> ready;
+  sources_.clear();
+  for (NodeId i = 0; i < nodes_.size(); ++i) {
+    pending[i] = nodes_[i].predecessor_count;
+    if (pending[i] == 0) {
+      sources_.push_back(i);
+    }
+  }
+  ready = sources_;
+  size_t visited = 0;
+  while (!ready.empty()) {
+    const NodeId node = ready.back();
+    ready.pop_back();
+    ++visited;
+    for (NodeId successor : nodes_[node].successors) {
+      if (--pending[successor] == 0) {
+        ready.push_back(successor);
+      }
+    }
+  }
+  if (visited != nodes_.size()) {
+    throw std::invalid_argument("Task graph contains a cycle");
+  }
+  validated_ = true;
+}
+
+std::future<void> TaskGraph::Run(CallbackWorkerThread& pool) {
+  Validate();
+  auto run = std::make_shared<detail::GraphRun>(*this, pool);
+  std::future<void> future = run->done.get_future();
+  if (nodes_.empty()) {
+    run->done.set_value();
+    return future;
+  }
+
+  std::vector<Task> tasks;
+  tasks.reserve(sources_.size());
+  for (NodeId source : sources_) {
+    tasks.push_back(detail::NodeTask(run, source));
+  }
+  pool.PushTasks(tasks.data(), tasks.size());
+  return future;
+}
+
+}  // namespace callback_worker_thread
@@ -66,6 +66,22 @@ TEST_F(CallbackWorkerThreadTest, EnqueueDefaultCallback) {
   EXPECT_EQ(expected_arg3, received_arg3);
 }
 
+TEST_F(CallbackWorkerThreadTest, EnqueueDefaultMovesStringArgument) {
+  CallbackWorkerThread worker;
+
+  // Long enough to live on the heap, so a move keeps the same buffer
+  std::string payload(1024, 'x');
+  const char* original = payload.data();
+  const char* received = nullptr;
+
+  auto future = worker.EnqueueDefault(
+      [&received](int, double, const std::string& arg3) { received = arg3.data(); }, 1, 2.0,
+      std::move(payload));
+  future.get();
+
+  EXPECT_EQ(original, received);
+}
+
 TEST_F(CallbackWorkerThreadTest, EnqueueGenericCallback) {
   CallbackWorkerThread worker;
   
@@ -228,4 +244,1061 @@ TEST_F(CallbackWorkerThreadTest, ThreadSafety) {
   EXPECT_EQ(num_threads * tasks_per_thread, total_executed.load());
 }
 
-}  // namespace 
\ No newline at end of file
+TEST_F(CallbackWorkerThreadTest, ConstructorWithOptions) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 3;
+  options.queue_type = QueueType::kLockFree;
+  CallbackWorkerThread worker(options);
+  EXPECT_EQ(3u, worker.GetThreadCount());
+
+  options.thread_count = 0;
+  EXPECT_THROW(CallbackWorkerThread{options}, std::invalid_argument);
+}
+
+TEST_F(CallbackWorkerThreadTest, LockFreeQueueExecutesAllTasks) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 4;
+  options.queue_type = QueueType::kLockFree;
+  // Small ring so producers also exercise the full-queue path
+  options.lock_free_queue_size = 16;
+  CallbackWorkerThread worker(options);
+
+  const int num_threads = 4;
+  const int tasks_per_thread = 500;
+  std::atomic<int> total_executed(0);
+  std::vector<std::thread> producer_threads;
+  std::vector<std::future<int>> futures[num_threads];
+
+  for (int t = 0; t < num_threads; ++t) {
+    producer_threads.emplace_back([&, t]() {
+      for (int i = 0; i < tasks_per_thread; ++i) {
+        futures[t].push_back(worker.Enqueue([&total_executed](int value) {
+          total_executed++;
+          return value;
+        }, i));
+      }
+    });
+  }
+
+  for (auto& thread : producer_threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < num_threads; ++t) {
+    for (int i = 0; i < tasks_per_thread; ++i) {
+      EXPECT_EQ(i, futures[t][i].get());
+    }
+  }
+
+  EXPECT_EQ(num_threads * tasks_per_thread, total_executed.load());
+  EXPECT_EQ(0u, worker.GetQueueSize());
+}
+
+TEST_F(CallbackWorkerThreadTest, LockFreeQueueFullRingDoesNotBlockWorkers) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 1;
+  options.queue_type = QueueType::kLockFree;
+  options.lock_free_queue_size = 4;
+  CallbackWorkerThread worker(options);
+
+  // The only worker fans out more tasks than the ring holds; it must not wait for itself
+  std::atomic<int> executed(0);
+  auto fan_out = worker.Enqueue([&worker, &executed]() {
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 10; ++i) {
+      futures.push_back(worker.Enqueue([&executed]() { executed++; }));
+    }
+    return futures;
+  });
+  ASSERT_EQ(std::future_status::ready, fan_out.wait_for(std::chrono::seconds(10)));
+
+  for (auto& future : fan_out.get()) {
+    future.get();
+  }
+  EXPECT_EQ(10, executed.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, LockFreeQueueStop) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 2;
+  options.queue_type = QueueType::kLockFree;
+  CallbackWorkerThread worker(options);
+
+  std::atomic<int> completed(0);
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 10; ++i) {
+    futures.push_back(worker.Enqueue([&completed]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      completed++;
+    }));
+  }
+
+  worker.Stop();
+  EXPECT_THROW(worker.Enqueue([](){}), std::runtime_error);
+
+  // Tasks accepted before Stop() still run
+  for (auto& future : futures) {
+    future.get();
+  }
+  EXPECT_EQ(10, completed.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, WorkStealingRecursiveFanOut) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 4;
+  options.work_stealing = true;
+  CallbackWorkerThread worker(options);
+
+  // Each task spawns two children from inside the pool until the depth limit is reached
+  const int depth = 10;
+  std::atomic<int> executed(0);
+  std::function<void(int)> spawn = [&](int level) {
+    executed++;
+    if (level < depth) {
+      worker.Enqueue(spawn, level + 1);
+      worker.Enqueue(spawn, level + 1);
+    }
+  };
+
+  worker.Enqueue(spawn, 0).get();
+
+  const int expected = (1 << (depth + 1)) - 1;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (executed.load() < expected && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(expected, executed.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, WorkStealingWithExternalProducers) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 3;
+  options.work_stealing = true;
+  options.queue_type = QueueType::kLockFree;
+  CallbackWorkerThread worker(options);
+
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 1000; ++i) {
+    futures.push_back(worker.Enqueue([](int value) { return value * 2; }, i));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i * 2, futures[i].get());
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, EnqueueMoveOnlyCallable) {
+  CallbackWorkerThread worker;
+
+  auto payload = std::make_unique<int>(21);
+  auto future = worker.Enqueue([payload = std::move(payload)](int factor) {
+    return *payload * factor;
+  }, 2);
+
+  EXPECT_EQ(42, future.get());
+}
+
+TEST_F(CallbackWorkerThreadTest, EnqueuePropagatesExceptionThroughFuture) {
+  CallbackWorkerThread worker;
+
+  auto future = worker.Enqueue([]() -> int {
+    throw std::runtime_error("Test exception");
+  });
+
+  EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(CallbackWorkerThreadTest, PostExecutesWithoutFuture) {
+  std::atomic<int> sum(0);
+  {
+    CallbackWorkerThread worker(2);
+    for (int i = 1; i <= 100; ++i) {
+      worker.Post([&sum](int value) { sum += value; }, i);
+    }
+    worker.PostDefault([&sum](int arg1, double arg2, const std::string& arg3) {
+      sum += arg1 + static_cast<int>(arg2) + static_cast<int>(arg3.size());
+    }, 1, 2.0, "abc");
+    // Destruction runs the remaining tasks before joining the workers
+  }
+
+  EXPECT_EQ(5050 + 6, sum.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, PostRoutesExceptionsToHandler) {
+  std::promise<std::string> received;
+
+  CallbackWorkerThreadOptions options;
+  options.exception_handler = [&received](std::exception_ptr exception) {
+    try {
+      std::rethrow_exception(exception);
+    } catch (const std::exception& e) {
+      received.set_value(e.what());
+    }
+  };
+  CallbackWorkerThread worker(options);
+
+  worker.Post([]() { throw std::runtime_error("posted failure"); });
+  EXPECT_EQ("posted failure", received.get_future().get());
+
+  // Replacing the handler at runtime; a throwing handler must not kill the worker
+  worker.SetExceptionHandler([](std::exception_ptr) { throw std::logic_error("handler"); });
+  worker.Post([]() { throw 1; });
+  EXPECT_EQ(7, worker.Enqueue([]() { return 7; }).get());
+
+  worker.Stop();
+  EXPECT_THROW(worker.Post([]() {}), std::runtime_error);
+}
+
+TEST_F(CallbackWorkerThreadTest, EnqueueBatchOfCallables) {
+  CallbackWorkerThread worker(3);
+
+  std::vector<std::function<int()>> callables;
+  for (int i = 0; i < 50; ++i) {
+    callables.push_back([i]() { return i * i; });
+  }
+
+  auto futures = worker.EnqueueBatch(callables.begin(), callables.end());
+  ASSERT_EQ(callables.size(), futures.size());
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(i * i, futures[i].get());
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, EnqueueBatchWithArgumentRange) {
+  CallbackWorkerThread worker(2);
+
+  std::vector<std::string> words = {"a", "bb", "ccc"};
+  auto futures = worker.EnqueueBatch([](const std::string& word) { return word.size(); },
+                                     words.begin(), words.end());
+
+  ASSERT_EQ(3u, futures.size());
+  EXPECT_EQ(1u, futures[0].get());
+  EXPECT_EQ(2u, futures[1].get());
+  EXPECT_EQ(3u, futures[2].get());
+}
+
+TEST_F(CallbackWorkerThreadTest, EnqueueBatchAllAggregatesCompletion) {
+  CallbackWorkerThread worker(4);
+
+  std::atomic<int> sum(0);
+  std::vector<int> values(100);
+  for (int i = 0; i < 100; ++i) {
+    values[i] = i + 1;
+  }
+
+  worker.EnqueueBatchAll([&sum](int value) { sum += value; }, values.begin(), values.end())
+      .get();
+  EXPECT_EQ(5050, sum.load());
+
+  // The aggregate future carries the first exception
+  std::vector<std::function<void()>> callables = {
+    []() {},
+    []() { throw std::runtime_error("batch failure"); },
+  };
+  auto failed = worker.EnqueueBatchAll(callables.begin(), callables.end());
+  EXPECT_THROW(failed.get(), std::runtime_error);
+
+  // Empty batches complete immediately
+  std::vector<std::function<void()>> empty;
+  auto ready = worker.EnqueueBatchAll(empty.begin(), empty.end());
+  EXPECT_EQ(std::future_status::ready, ready.wait_for(std::chrono::seconds(0)));
+}
+
+TEST_F(CallbackWorkerThreadTest, PostBatchAndStoppedPool) {
+  std::atomic<int> count(0);
+  {
+    CallbackWorkerThread worker(2);
+    std::vector<int> values(64, 1);
+    worker.PostBatch([&count](int value) { count += value; }, values.begin(), values.end());
+
+    worker.Stop();
+    std::vector<std::function<void()>> callables(3, []() {});
+    EXPECT_THROW(worker.EnqueueBatch(callables.begin(), callables.end()), std::runtime_error);
+    EXPECT_THROW(worker.PostBatch(callables.begin(), callables.end()), std::runtime_error);
+  }
+  EXPECT_EQ(64, count.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, BatchedDequeuePreservesFifoOrder) {
+  CallbackWorkerThreadOptions options;
+  options.dequeue_batch_size = 8;
+  CallbackWorkerThread worker(options);
+
+  // With a single worker, batching must not reorder tasks
+  std::vector<int> order;
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(worker.Enqueue([&order, i]() { order.push_back(i); }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+
+  ASSERT_EQ(100u, order.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, order[i]);
+  }
+
+  options.dequeue_batch_size = 0;
+  EXPECT_THROW(CallbackWorkerThread{options}, std::invalid_argument);
+}
+
+TEST_F(CallbackWorkerThreadTest, AdaptiveBatchedDequeueExecutesAllTasks) {
+  for (QueueType queue_type : {QueueType::kLocked, QueueType::kLockFree}) {
+    CallbackWorkerThreadOptions options;
+    options.thread_count = 4;
+    options.queue_type = queue_type;
+    options.dequeue_batch_size = 32;
+    options.adaptive_dequeue_batch = true;
+
+    std::atomic<int> executed(0);
+    {
+      CallbackWorkerThread worker(options);
+      std::vector<std::thread> producers;
+      for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&worker, &executed]() {
+          for (int i = 0; i < 2000; ++i) {
+            worker.Post([&executed]() { executed++; });
+          }
+        });
+      }
+      for (auto& producer : producers) {
+        producer.join();
+      }
+    }
+    EXPECT_EQ(8000, executed.load());
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, WaitStrategiesExecuteTasksAndStop) {
+  for (WaitStrategy strategy : {WaitStrategy::kBlock, WaitStrategy::kSpinThenPark,
+                                WaitStrategy::kYield, WaitStrategy::kBusySpin}) {
+    CallbackWorkerThreadOptions options;
+    options.thread_count = 2;
+    options.wait_strategy = strategy;
+    options.spin_iterations = 100;
+    options.yield_iterations = 5;
+    CallbackWorkerThread worker(options);
+
+    for (int round = 0; round < 3; ++round) {
+      // Let the workers go idle between rounds so every phase of the strategy is exercised
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      std::vector<std::future<int>> futures;
+      for (int i = 0; i < 20; ++i) {
+        futures.push_back(worker.Enqueue([i]() { return i + 1; }));
+      }
+      for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i + 1, futures[i].get());
+      }
+    }
+
+    if (strategy == WaitStrategy::kYield || strategy == WaitStrategy::kBusySpin) {
+      // Polling workers never park, so producers never need to wake anyone
+      EXPECT_EQ(0u, worker.GetIdleWorkerCount());
+    }
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, IdleWorkerCountReflectsParkedWorkers) {
+  CallbackWorkerThread worker(3);
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (worker.GetIdleWorkerCount() < 3 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(3u, worker.GetIdleWorkerCount());
+}
+
+TEST_F(CallbackWorkerThreadTest, PriorityLevelsRunHighestFirst) {
+  for (QueueType queue_type : {QueueType::kLocked, QueueType::kLockFree}) {
+    CallbackWorkerThreadOptions options;
+    options.queue_type = queue_type;
+    CallbackWorkerThread worker(options);
+
+    // Hold the only worker so that every task below is queued before any of them runs
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> blocked;
+    worker.Post([released, &blocked]() {
+      blocked.set_value();
+      released.wait();
+    });
+    blocked.get_future().wait();
+
+    std::vector<std::string> order;
+    worker.Post(TaskPriority::kLow, [&order]() { order.push_back("low"); });
+    worker.Post([&order]() { order.push_back("normal"); });
+    auto high = worker.Enqueue(TaskPriority::kHigh, [&order]() {
+      order.push_back("high");
+      return 1;
+    });
+    auto last = worker.Enqueue(TaskPriority::kLow, []() {});
+    release.set_value();
+
+    EXPECT_EQ(1, high.get());
+    last.get();
+    EXPECT_EQ((std::vector<std::string>{"high", "normal", "low"}), order);
+    EXPECT_THROW(worker.Post(static_cast<TaskPriority>(7), []() {}), std::invalid_argument);
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, StarvationLimitServesLowPriority) {
+  CallbackWorkerThreadOptions options;
+  options.starvation_limit = 3;
+  CallbackWorkerThread worker(options);
+
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<void> blocked;
+  worker.Post([released, &blocked]() {
+    blocked.set_value();
+    released.wait();
+  });
+  blocked.get_future().wait();
+
+  std::vector<int> order;
+  worker.Post(TaskPriority::kLow, [&order]() { order.push_back(-1); });
+  for (int i = 0; i < 5; ++i) {
+    worker.Post(TaskPriority::kHigh, [&order, i]() { order.push_back(i); });
+  }
+  auto done = worker.Enqueue(TaskPriority::kHigh, [&order]() { order.push_back(5); });
+  release.set_value();
+  done.get();
+
+  // The blocking task was dequeue #1, so dequeue #3 must take the low priority task even
+  // though high priority work is still queued
+  EXPECT_EQ((std::vector<int>{0, -1, 1, 2, 3, 4, 5}), order);
+}
+
+// Occupies a pool's only worker until Release() is called
+class WorkerBlocker {
+ public:
+  explicit WorkerBlocker(CallbackWorkerThread& worker) : released_(release_.get_future().share()) {
+    std::promise<void> blocked;
+    std::future<void> started = blocked.get_future();
+    worker.Post([released = released_, blocked = std::move(blocked)]() mutable {
+      blocked.set_value();
+      released.wait();
+    });
+    started.wait();
+  }
+
+  void Release() { release_.set_value(); }
+
+ private:
+  std::promise<void> release_;
+  std::shared_future<void> released_;
+};
+
+TEST_F(CallbackWorkerThreadTest, BoundedQueueTryEnqueueAndTimeout) {
+  for (QueueType queue_type : {QueueType::kLocked, QueueType::kLockFree}) {
+    CallbackWorkerThreadOptions options;
+    options.queue_type = queue_type;
+    options.max_queue_size = 2;
+    CallbackWorkerThread worker(options);
+    WorkerBlocker blocker(worker);
+
+    std::atomic<int> executed(0);
+    EXPECT_TRUE(worker.TryPost([&executed]() { executed++; }));
+    auto queued = worker.TryEnqueue([&executed]() { executed++; });
+    ASSERT_TRUE(queued.has_value());
+
+    EXPECT_FALSE(worker.TryEnqueue([]() { return 1; }).has_value());
+    EXPECT_FALSE(worker.TryPost([&executed]() { executed++; }));
+    EXPECT_FALSE(worker.TryEnqueueFor(std::chrono::milliseconds(10), []() {}).has_value());
+    EXPECT_FALSE(worker.TryPostFor(std::chrono::milliseconds(10), []() {}));
+    EXPECT_EQ(2u, worker.GetQueueSize());
+
+    // A waiting producer gets in as soon as a worker frees a slot
+    std::thread releaser([&blocker]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      blocker.Release();
+    });
+    auto late = worker.TryEnqueueFor(std::chrono::seconds(5), [](int x) { return x * 2; }, 21);
+    releaser.join();
+    ASSERT_TRUE(late.has_value());
+    EXPECT_EQ(42, late->get());
+    queued->get();
+    EXPECT_EQ(2, executed.load());
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, LockFreeTryPostFailsOnFullRing) {
+  CallbackWorkerThreadOptions options;
+  options.queue_type = QueueType::kLockFree;
+  options.lock_free_queue_size = 4;
+  CallbackWorkerThread worker(options);
+  WorkerBlocker blocker(worker);
+
+  // Try submissions never wait for the ring, even on an unbounded pool
+  int accepted = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 8; ++i) {
+    accepted += worker.TryPost([]() {}) ? 1 : 0;
+  }
+  EXPECT_EQ(4, accepted);
+  EXPECT_FALSE(worker.TryPostFor(std::chrono::milliseconds(10), []() {}));
+  EXPECT_FALSE(worker.TryEnqueueFor(std::chrono::milliseconds(10), []() {}).has_value());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  EXPECT_EQ(4u, worker.GetQueueSize());
+  blocker.Release();
+  worker.WaitIdle();
+
+  // A limit the ring cannot hold would make policy-admitted producers wait on the ring
+  options.max_queue_size = 16;
+  EXPECT_THROW(CallbackWorkerThread bad(options), std::invalid_argument);
+}
+
+TEST_F(CallbackWorkerThreadTest, BoundedQueueBlockAndRejectPolicies) {
+  CallbackWorkerThreadOptions options;
+  options.max_queue_size = 1;
+  {
+    CallbackWorkerThread worker(options);
+    WorkerBlocker blocker(worker);
+    worker.Post([]() {});
+
+    std::atomic<bool> posted(false);
+    std::thread producer([&worker, &posted]() {
+      worker.Post([]() {});
+      posted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(posted.load());
+    blocker.Release();
+    producer.join();
+    EXPECT_TRUE(posted.load());
+  }
+
+  options.overflow_policy = OverflowPolicy::kReject;
+  CallbackWorkerThread worker(options);
+  WorkerBlocker blocker(worker);
+  worker.Post([]() {});
+  EXPECT_THROW(worker.Post([]() {}), QueueFullError);
+  EXPECT_THROW(worker.Enqueue([]() {}), QueueFullError);
+  blocker.Release();
+}
+
+TEST_F(CallbackWorkerThreadTest, BoundedQueueDropOldest) {
+  for (QueueType queue_type : {QueueType::kLocked, QueueType::kLockFree}) {
+    std::atomic<int> dropped(0);
+    CallbackWorkerThreadOptions options;
+    options.queue_type = queue_type;
+    options.max_queue_size = 2;
+    options.overflow_policy = OverflowPolicy::kDropOldest;
+    options.drop_handler = [&dropped]() { dropped++; };
+    CallbackWorkerThread worker(options);
+    WorkerBlocker blocker(worker);
+
+    // The oldest task of the lowest non-empty level goes first
+    auto oldest_low = worker.Enqueue(TaskPriority::kLow, []() { return 1; });
+    auto normal = worker.Enqueue([]() { return 2; });
+    auto newest = worker.Enqueue([]() { return 3; });
+    EXPECT_EQ(1, dropped.load());
+    auto next = worker.Enqueue([]() { return 4; });
+    EXPECT_EQ(2, dropped.load());
+    blocker.Release();
+
+    EXPECT_THROW(oldest_low.get(), std::future_error);
+    EXPECT_THROW(normal.get(), std::future_error);
+    EXPECT_EQ(3, newest.get());
+    EXPECT_EQ(4, next.get());
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, BoundedQueueAdmitsTasksFromWorkers) {
+  CallbackWorkerThreadOptions options;
+  options.max_queue_size = 1;
+  CallbackWorkerThread worker(options);
+
+  // A worker blocking on its own full queue would deadlock, so it is admitted over the limit
+  std::atomic<int> executed(0);
+  auto outer = worker.Enqueue([&worker, &executed]() {
+    for (int i = 0; i < 10; ++i) {
+      worker.Post([&executed]() { executed++; });
+    }
+  });
+  outer.get();
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (executed.load() < 10 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(10, executed.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, BoundedQueueDropOldestAdmitsWorkersWithNothingToDrop) {
+  // A worker's own posts sit in its deque, out of reach of DropOldestTask; the worker must not
+  // wait for them to become droppable
+  CallbackWorkerThreadOptions options;
+  options.max_queue_size = 1;
+  options.overflow_policy = OverflowPolicy::kDropOldest;
+  options.work_stealing = true;
+  CallbackWorkerThread worker(options);
+
+  std::atomic<int> executed(0);
+  auto outer = worker.Enqueue([&worker, &executed]() {
+    worker.Post([&executed]() { executed++; });
+    worker.Post([&executed]() { executed++; });
+  });
+  ASSERT_EQ(std::future_status::ready, outer.wait_for(std::chrono::seconds(10)));
+  outer.get();
+  worker.WaitIdle();
+  EXPECT_EQ(2, executed.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, WaitIdleWaitsForRunningAndNestedTasks) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 4;
+  options.work_stealing = true;
+  CallbackWorkerThread worker(options);
+
+  for (int round = 0; round < 3; ++round) {
+    std::atomic<int> finished(0);
+    for (int i = 0; i < 20; ++i) {
+      worker.Post([&worker, &finished]() {
+        // Subtasks are submitted before the parent finishes, so they are waited for too
+        worker.Post([&finished]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          finished++;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        finished++;
+      });
+    }
+
+    // The pool stays usable between rounds; no Stop() needed
+    worker.WaitIdle();
+    EXPECT_EQ(40, finished.load());
+    EXPECT_EQ(0u, worker.GetInFlightCount());
+  }
+
+  std::atomic<int> finished(0);
+  worker.Post([&finished]() { finished++; });
+  worker.WaitForCompletion();
+  EXPECT_EQ(1, finished.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, WaitIdleForTimesOutWhileTaskRuns) {
+  CallbackWorkerThread worker(1);
+  WorkerBlocker blocker(worker);
+  worker.Post([]() {});
+
+  EXPECT_EQ(2u, worker.GetInFlightCount());
+  EXPECT_FALSE(worker.WaitIdleFor(std::chrono::milliseconds(10)));
+  blocker.Release();
+  EXPECT_TRUE(worker.WaitIdleFor(std::chrono::seconds(5)));
+  EXPECT_EQ(0u, worker.GetInFlightCount());
+
+  // Waiting from inside the pool would wait for itself
+  auto inner = worker.Enqueue([&worker]() { worker.WaitIdle(); });
+  EXPECT_THROW(inner.get(), std::logic_error);
+}
+
+// Poll until predicate holds or a generous deadline passes
+template <typename Predicate>
+bool Eventually(Predicate predicate) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+TEST_F(CallbackWorkerThreadTest, ElasticPoolValidatesBounds) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 2;
+  options.min_thread_count = 3;
+  EXPECT_THROW(CallbackWorkerThread{options}, std::invalid_argument);
+  options.min_thread_count = 1;
+  options.max_thread_count = 1;
+  EXPECT_THROW(CallbackWorkerThread{options}, std::invalid_argument);
+
+  // A fixed pool can only be "resized" to its own size
+  CallbackWorkerThread fixed(2);
+  EXPECT_NO_THROW(fixed.Resize(2));
+  EXPECT_THROW(fixed.Resize(3), std::invalid_argument);
+
+  options.max_thread_count = 4;
+  CallbackWorkerThread elastic(options);
+  EXPECT_EQ(2u, elastic.GetThreadCount());
+  EXPECT_THROW(elastic.Resize(0), std::invalid_argument);
+  EXPECT_THROW(elastic.Resize(5), std::invalid_argument);
+  elastic.Stop();
+  EXPECT_THROW(elastic.Resize(3), std::runtime_error);
+}
+
+TEST_F(CallbackWorkerThreadTest, ElasticPoolGrowsUnderLoadAndRetiresIdleWorkers) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 1;
+  options.min_thread_count = 1;
+  options.max_thread_count = 4;
+  options.keep_alive = std::chrono::milliseconds(20);
+  CallbackWorkerThread worker(options);
+
+  // Each task blocks until all four run at once, which needs four threads. Submitting the next
+  // task only once the previous one runs means no worker is parked when it is queued.
+  std::atomic<int> started(0);
+  std::atomic<bool> release(false);
+  for (int i = 1; i <= 4; ++i) {
+    worker.Post([&started, &release]() {
+      started++;
+      while (!release) {
+        std::this_thread::yield();
+      }
+    });
+    ASSERT_TRUE(Eventually([&] { return started.load() == i; }));
+  }
+  EXPECT_EQ(4u, worker.GetThreadCount());
+  release = true;
+  worker.WaitIdle();
+
+  // Idle workers above the minimum retire after the keep-alive interval
+  EXPECT_TRUE(Eventually([&] { return worker.GetThreadCount() == 1; }));
+  auto result = worker.Enqueue([]() { return 42; });
+  EXPECT_EQ(42, result.get());
+}
+
+TEST_F(CallbackWorkerThreadTest, ResizeGrowsAndShrinksPool) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 1;
+  options.min_thread_count = 1;
+  options.max_thread_count = 4;
+  options.keep_alive = std::chrono::hours(1);
+  options.work_stealing = true;
+  CallbackWorkerThread worker(options);
+
+  for (int round = 0; round < 3; ++round) {
+    worker.Resize(4);
+    EXPECT_EQ(4u, worker.GetThreadCount());
+
+    // All four workers must be running for the tasks to finish
+    std::atomic<int> arrived(0);
+    for (int i = 0; i < 4; ++i) {
+      worker.Post([&arrived]() {
+        arrived++;
+        while (arrived < 4) {
+          std::this_thread::yield();
+        }
+      });
+    }
+    EXPECT_TRUE(worker.WaitIdleFor(std::chrono::seconds(5)));
+
+    worker.Resize(2);
+    EXPECT_EQ(2u, worker.GetThreadCount());
+    std::atomic<int> finished(0);
+    for (int i = 0; i < 100; ++i) {
+      worker.Post([&finished]() { finished++; });
+    }
+    worker.WaitIdle();
+    EXPECT_EQ(100, finished.load());
+
+    worker.Resize(1);
+    EXPECT_EQ(1u, worker.GetThreadCount());
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, CpuPlacementPinsWorkers) {
+  const int cpu = GetCurrentCpu();
+  if (cpu < 0) {
+    GTEST_SKIP() << "Current CPU is not available on this platform";
+  }
+
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 2;
+  options.cpu_set = {cpu};
+  options.placement = WorkerPlacement::kCpu;
+  CallbackWorkerThread worker(options);
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(cpu, worker.Enqueue([]() { return GetCurrentCpu(); }).get());
+  }
+
+  options.placement = WorkerPlacement::kNone;
+  options.numa_local_queues = true;
+  EXPECT_THROW(CallbackWorkerThread{options}, std::invalid_argument);
+  options.cpu_set = {-1};
+  EXPECT_THROW(CallbackWorkerThread{options}, std::invalid_argument);
+}
+
+TEST_F(CallbackWorkerThreadTest, NumaLocalQueuesKeepPriorityOrder) {
+  for (QueueType type : {QueueType::kLocked, QueueType::kLockFree}) {
+    CallbackWorkerThreadOptions options;
+    options.thread_count = 1;
+    options.queue_type = type;
+    options.placement = WorkerPlacement::kNumaNode;
+    options.numa_local_queues = true;
+    CallbackWorkerThread worker(options);
+
+    std::vector<int> order;
+    {
+      WorkerBlocker blocker(worker);
+      worker.Post(TaskPriority::kLow, [&order]() { order.push_back(2); });
+      worker.Post([&order]() { order.push_back(1); });
+      // Submitted from inside the pool, so it lands on the worker's node
+      worker.Post(TaskPriority::kHigh, [&worker, &order]() {
+        order.push_back(0);
+        worker.Post(TaskPriority::kHigh, [&order]() { order.push_back(3); });
+      });
+      blocker.Release();
+    }
+    worker.WaitIdle();
+    EXPECT_EQ((std::vector<int>{0, 3, 1, 2}), order);
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, EnqueueAfterAndAtRunOnceDue) {
+  CallbackWorkerThreadOptions options;
+  options.timer_tick = std::chrono::microseconds(0);
+  EXPECT_THROW(CallbackWorkerThread{options}, std::invalid_argument);
+
+  CallbackWorkerThread worker(2);
+  const auto start = std::chrono::steady_clock::now();
+  auto later = worker.EnqueueAfter(
+      std::chrono::milliseconds(30),
+      [](int x) { return std::make_pair(x, std::chrono::steady_clock::now()); }, 7);
+  auto sooner = worker.EnqueueAt(start + std::chrono::milliseconds(10),
+                                 []() { return std::chrono::steady_clock::now(); });
+  auto past = worker.EnqueueAt(start - std::chrono::seconds(1), []() { return 1; });
+
+  EXPECT_EQ(1, past.future.get());
+  EXPECT_GE(sooner.future.get() - start, std::chrono::milliseconds(10));
+  const auto result = later.future.get();
+  EXPECT_EQ(7, result.first);
+  EXPECT_GE(result.second - start, std::chrono::milliseconds(30));
+  EXPECT_FALSE(later.timer.IsActive());
+  EXPECT_FALSE(later.timer.Cancel());
+}
+
+TEST_F(CallbackWorkerThreadTest, CancelledTimerBreaksPromise) {
+  CallbackWorkerThread worker;
+  auto scheduled = worker.EnqueueAfter(std::chrono::seconds(60), []() { return 1; });
+  EXPECT_TRUE(scheduled.timer.IsActive());
+  EXPECT_TRUE(scheduled.timer.Cancel());
+  EXPECT_FALSE(scheduled.timer.IsActive());
+  EXPECT_FALSE(scheduled.timer.Cancel());
+  try {
+    scheduled.future.get();
+    FAIL() << "Cancelled task must not run";
+  } catch (const std::future_error& e) {
+    EXPECT_EQ(std::future_errc::broken_promise, e.code());
+  }
+
+  // An idle pool still serves the remaining timers
+  auto other = worker.EnqueueAfter(std::chrono::milliseconds(5), []() { return 2; });
+  EXPECT_EQ(2, other.future.get());
+  EXPECT_FALSE(TimerHandle().Cancel());
+}
+
+TEST_F(CallbackWorkerThreadTest, SchedulePeriodicRunsUntilCancelled) {
+  CallbackWorkerThread worker(2);
+  EXPECT_THROW(worker.SchedulePeriodic(std::chrono::milliseconds(0), []() {}),
+               std::invalid_argument);
+
+  std::atomic<int> runs{0};
+  std::atomic<int> errors{0};
+  worker.SetExceptionHandler([&errors](std::exception_ptr) { errors.fetch_add(1); });
+  TimerHandle timer = worker.SchedulePeriodic(std::chrono::milliseconds(2), [&runs]() {
+    if (runs.fetch_add(1) == 1) {
+      throw std::runtime_error("periodic failure");
+    }
+  });
+  ASSERT_TRUE(Eventually([&] { return runs.load() >= 5; }));
+  EXPECT_TRUE(timer.IsActive());
+  EXPECT_TRUE(timer.Cancel());
+  EXPECT_FALSE(timer.Cancel());
+
+  // A run in progress when Cancel returned may still finish, but no new one starts
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const int stopped_at = runs.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(stopped_at, runs.load());
+  EXPECT_EQ(1, errors.load());
+}
+
+TEST_F(CallbackWorkerThreadTest, StopDiscardsPendingTimers) {
+  CallbackWorkerThread worker;
+  auto scheduled = worker.EnqueueAfter(std::chrono::seconds(60), []() {});
+  TimerHandle periodic = worker.SchedulePeriodic(std::chrono::seconds(60), []() {});
+
+  worker.Stop();
+  EXPECT_FALSE(scheduled.timer.IsActive());
+  EXPECT_FALSE(periodic.IsActive());
+  EXPECT_THROW(scheduled.future.get(), std::future_error);
+  EXPECT_THROW(worker.EnqueueAfter(std::chrono::milliseconds(1), []() {}),
+               std::runtime_error);
+}
+
+TEST_F(CallbackWorkerThreadTest, CancelledTasksAreSkipped) {
+  CallbackWorkerThread worker;
+  std::atomic<int> ran{0};
+  CancellationSource source;
+  CancellableTask<int> task;
+  {
+    WorkerBlocker blocker(worker);
+    task = worker.EnqueueCancellable([&ran]() { return ran.fetch_add(1); });
+    worker.Post(source.GetToken(), [&ran]() { ran.fetch_add(1); });
+    auto kept = worker.Enqueue(CancellationToken(), [](int x) { return x; }, 5);
+
+    EXPECT_TRUE(task.cancellation.RequestCancel());
+    EXPECT_FALSE(task.cancellation.RequestCancel());
+    EXPECT_TRUE(source.RequestCancel());
+    blocker.Release();
+    EXPECT_EQ(5, kept.get());
+  }
+  worker.WaitIdle();
+
+  EXPECT_EQ(0, ran.load());
+  try {
+    task.future.get();
+    FAIL() << "Cancelled task must not run";
+  } catch (const std::future_error& e) {
+    EXPECT_EQ(std::future_errc::broken_promise, e.code());
+  }
+  EXPECT_FALSE(CancellationToken().CanBeCancelled());
+}
+
+TEST_F(CallbackWorkerThreadTest, RunningTaskPollsCancellationToken) {
+  CallbackWorkerThread worker;
+  CancellationSource source;
+  std::promise<void> started;
+  auto started_future = started.get_future();
+  auto future = worker.Enqueue(source.GetToken(),
+                               [&started](const CancellationToken& token, int step) {
+                                 started.set_value();
+                                 int iterations = 0;
+                                 while (!token.IsCancellationRequested()) {
+                                   iterations += step;
+                                   std::this_thread::yield();
+                                 }
+                                 return iterations;
+                               },
+                               1);
+  started_future.wait();
+  source.RequestCancel();
+  EXPECT_GE(future.get(), 0);
+}
+
+TEST_F(CallbackWorkerThreadTest, CancelTagCancelsOnlyThatGroup) {
+  CallbackWorkerThread worker;
+  std::atomic<int> group_one{0};
+  std::atomic<int> group_two{0};
+  {
+    WorkerBlocker blocker(worker);
+    for (int i = 0; i < 3; ++i) {
+      worker.Post(worker.GetTagToken(1), [&group_one]() { group_one.fetch_add(1); });
+    }
+    worker.Post(worker.GetTagToken(2), [&group_two]() { group_two.fetch_add(1); });
+    EXPECT_TRUE(worker.CancelTag(1));
+    EXPECT_FALSE(worker.CancelTag(1));
+    EXPECT_FALSE(worker.CancelTag(3));
+
+    // Tasks tagged after the cancellation form a new group
+    worker.Post(worker.GetTagToken(1), [&group_one]() { group_one.fetch_add(10); });
+    blocker.Release();
+  }
+  worker.WaitIdle();
+  EXPECT_EQ(10, group_one.load());
+  EXPECT_EQ(1, group_two.load());
+
+  // Groups without live tokens are forgotten
+  for (uint64_t tag = 100; tag < 1100; ++tag) {
+    worker.GetTagToken(tag);
+  }
+  EXPECT_FALSE(worker.CancelTag(100));
+}
+
+TEST_F(CallbackWorkerThreadTest, NestedWaitHelpingDoesNotDeadlock) {
+  // Every worker waits for a task it enqueued; plain get() would deadlock both pools
+  for (size_t threads : {size_t{1}, size_t{4}}) {
+    CallbackWorkerThread worker(threads);
+    std::vector<std::future<int>> outer;
+    for (size_t i = 0; i < threads * 2; ++i) {
+      outer.push_back(worker.Enqueue([&worker, i]() {
+        auto inner = worker.Enqueue([i]() { return static_cast<int>(i); });
+        worker.WaitHelping(inner);
+        return inner.get() + 1;
+      }));
+    }
+    for (size_t i = 0; i < outer.size(); ++i) {
+      EXPECT_EQ(static_cast<int>(i) + 1, outer[i].get());
+    }
+  }
+}
+
+TEST_F(CallbackWorkerThreadTest, WaitHelpingRunsQueuedTasksOnCaller) {
+  CallbackWorkerThread worker(1);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  worker.Post([opened]() { opened.wait(); });
+  while (worker.GetQueueSize() != 0) {
+    std::this_thread::yield();
+  }
+
+  // The only worker is blocked, so the caller has to run the queued tasks itself
+  const std::thread::id caller = std::this_thread::get_id();
+  std::vector<std::future<std::thread::id>> futures;
+  for (int i = 0; i < 10; ++i) {
+    futures.push_back(worker.Enqueue([]() { return std::this_thread::get_id(); }));
+  }
+  worker.WaitHelping(futures.back());
+  for (auto& future : futures) {
+    EXPECT_EQ(caller, future.get());
+  }
+
+  Future<int> native = worker.EnqueueFuture([]() { return 5; });
+  worker.WaitHelping(native);
+  EXPECT_EQ(5, native.Get());
+
+  std::future<void> invalid;
+  EXPECT_THROW(worker.WaitHelping(invalid), std::future_error);
+
+  // The timed wait helps the same way, and gives up on a future nothing will complete
+  auto helped = worker.Enqueue([]() { return std::this_thread::get_id(); });
+  EXPECT_TRUE(worker.WaitHelpingFor(helped, std::chrono::seconds(10)));
+  EXPECT_EQ(caller, helped.get());
+  std::promise<void> never;
+  EXPECT_FALSE(worker.WaitHelpingFor(never.get_future(), std::chrono::milliseconds(5)));
+  EXPECT_THROW(worker.WaitHelpingFor(invalid, std::chrono::milliseconds(5)), std::future_error);
+  gate.set_value();
+}
+
+TEST_F(CallbackWorkerThreadTest, InvokeRunsInlineOnWorkers) {
+  CallbackWorkerThread worker(1);
+  EXPECT_EQ(3, worker.Invoke([](int a, int b) { return a + b; }, 1, 2));
+  EXPECT_THROW(worker.Invoke([]() { throw std::runtime_error("invoke"); }), std::runtime_error);
+
+  // From a worker, Invoke runs on the calling worker itself
+  auto same_thread = worker.Enqueue([&worker]() {
+    const std::thread::id self = std::this_thread::get_id();
+    return worker.Invoke([]() { return std::this_thread::get_id(); }) == self;
+  });
+  EXPECT_TRUE(same_thread.get());
+}
+
+TEST_F(CallbackWorkerThreadTest, CallerRunsPolicyRunsTaskOnSubmitter) {
+  CallbackWorkerThreadOptions options;
+  options.max_queue_size = 1;
+  options.overflow_policy = OverflowPolicy::kCallerRuns;
+  CallbackWorkerThread worker(options);
+
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  worker.Post([opened]() { opened.wait(); });
+  while (worker.GetQueueSize() != 0) {
+    std::this_thread::yield();
+  }
+  auto queued = worker.Enqueue([]() { return std::this_thread::get_id(); });
+
+  // The queue is full: the submitter runs the task before Enqueue returns
+  auto overflow = worker.Enqueue([]() { return std::this_thread::get_id(); });
+  ASSERT_EQ(std::future_status::ready, overflow.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(std::this_thread::get_id(), overflow.get());
+
+  gate.set_value();
+  EXPECT_NE(std::this_thread::get_id(), queued.get());
+}
+
+}  // namespace
+
@@ -5,6 +5,14 @@
 
 #include "callback_worker_thread/callback_worker_thread_c.h"
 
+// Flag a blocking callback spins on until the test releases it
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+typedef atomic_int ReleaseFlag;
+#else
+typedef volatile int ReleaseFlag;
+#endif
+
 // Global variables for testing
 static int g_callback_count = 0;
 static int g_last_int_value = 0;
@@ -42,6 +50,11 @@ void test_string_callback(const char* arg) {
     g_last_string_value[sizeof(g_last_string_value) - 1] = '\0';
 }
 
+void test_user_data_callback(void* user_data) {
+    int* slot = (int*)user_data;
+    (*slot)++;
+}
+
 // Reset test state
 void reset_test_state(void) {
     g_callback_count = 0;
@@ -214,6 +227,764 @@ int test_return_value_callback(void) {
     return 1;
 }
 
+int test_async_callbacks(void) {
+    printf("Running test_async_callbacks...\n");
+    
+    reset_test_state();
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerTaskHandle* handle = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(1, &worker);
+    ASSERT_SUCCESS(result);
+    
+    // Fire-and-forget submissions (no handle)
+    result = callback_worker_enqueue_no_arg_async(worker, test_no_arg_callback, NULL);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_int_async(worker, test_int_callback, 7, NULL);
+    ASSERT_SUCCESS(result);
+    
+    // A single worker runs tasks in order, so waiting on the last one covers the rest
+    result = callback_worker_enqueue_default_async(worker, test_default_callback,
+                                                   5, 2.5, "async message", &handle);
+    ASSERT_SUCCESS(result);
+    assert(handle != NULL);
+    
+    result = callback_worker_task_wait_timeout(handle, 5000);
+    ASSERT_SUCCESS(result);
+    
+    int completed = 0;
+    result = callback_worker_task_poll(handle, &completed);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, completed);
+    
+    ASSERT_EQ(3, g_callback_count);
+    ASSERT_EQ(5, g_last_int_value);
+    ASSERT_DOUBLE_EQ(2.5, g_last_double_value, 0.00001);
+    ASSERT_STR_EQ("async message", g_last_string_value);
+    
+    result = callback_worker_task_release(handle);
+    ASSERT_SUCCESS(result);
+    
+    handle = NULL;
+    result = callback_worker_enqueue_string_async(worker, test_string_callback, "later", &handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_wait(handle);
+    ASSERT_SUCCESS(result);
+    ASSERT_STR_EQ("later", g_last_string_value);
+    result = callback_worker_task_release(handle);
+    ASSERT_SUCCESS(result);
+    
+    // Error cases
+    result = callback_worker_enqueue_no_arg_async(NULL, test_no_arg_callback, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    result = callback_worker_enqueue_string_async(worker, test_string_callback, NULL, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    result = callback_worker_task_wait(NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    result = callback_worker_task_release(NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+static int g_free_count = 0;
+
+void test_free_buffer(void* buffer) {
+    g_free_count++;
+    free(buffer);
+}
+
+static char* duplicate_string(const char* text) {
+    char* copy = (char*)malloc(strlen(text) + 1);
+    strcpy(copy, text);
+    return copy;
+}
+
+int test_owned_string(void) {
+    printf("Running test_owned_string...\n");
+    
+    reset_test_state();
+    g_free_count = 0;
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerTaskHandle* handle = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(1, &worker);
+    ASSERT_SUCCESS(result);
+    
+    result = callback_worker_enqueue_string_owned(worker, test_string_callback,
+                                                  duplicate_string("handed over"),
+                                                  test_free_buffer, &handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_wait(handle);
+    ASSERT_SUCCESS(result);
+    ASSERT_STR_EQ("handed over", g_last_string_value);
+    result = callback_worker_task_release(handle);
+    ASSERT_SUCCESS(result);
+    
+    // Fire-and-forget: the buffer is released once the task is done
+    result = callback_worker_enqueue_string_owned(worker, test_string_callback,
+                                                  duplicate_string("posted"),
+                                                  test_free_buffer, NULL);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_wait_idle(worker);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(2, g_callback_count);
+    ASSERT_EQ(2, g_free_count);
+    
+    // Failed submissions still release the buffer
+    result = callback_worker_enqueue_string_owned(worker, NULL, duplicate_string("rejected"),
+                                                  test_free_buffer, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    ASSERT_EQ(3, g_free_count);
+    
+    result = callback_worker_stop(worker);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_string_owned(worker, test_string_callback,
+                                                  duplicate_string("stopped"),
+                                                  test_free_buffer, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_THREAD_STOPPED, result);
+    ASSERT_EQ(4, g_free_count);
+    ASSERT_EQ(2, g_callback_count);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+int test_allocator_stats(void) {
+    printf("Running test_allocator_stats...\n");
+    
+    reset_test_state();
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerAllocatorStats before;
+    CallbackWorkerAllocatorStats after;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(1, &worker);
+    ASSERT_SUCCESS(result);
+    
+    // Warm up the caches, then check that the same load reaches the system allocator no more
+    for (int round = 0; round < 2; ++round) {
+        if (round == 1) {
+            result = callback_worker_get_allocator_stats(&before);
+            ASSERT_SUCCESS(result);
+        }
+        for (int i = 0; i < 200; ++i) {
+            CallbackWorkerTaskHandle* handle = NULL;
+            result = callback_worker_enqueue_string_async(worker, test_string_callback,
+                                                          "slab allocated", &handle);
+            ASSERT_SUCCESS(result);
+            result = callback_worker_task_wait(handle);
+            ASSERT_SUCCESS(result);
+            result = callback_worker_task_release(handle);
+            ASSERT_SUCCESS(result);
+        }
+    }
+    result = callback_worker_get_allocator_stats(&after);
+    ASSERT_SUCCESS(result);
+    
+    ASSERT_EQ(400, g_callback_count);
+    ASSERT_STR_EQ("slab allocated", g_last_string_value);
+    ASSERT_EQ(1, before.slab_allocations == after.slab_allocations);
+    ASSERT_EQ(1, before.large_allocations == after.large_allocations);
+    
+    result = callback_worker_get_allocator_stats(NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+int test_batch_enqueue(void) {
+    printf("Running test_batch_enqueue...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerTaskHandle* handle = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(4, &worker);
+    ASSERT_SUCCESS(result);
+    
+    int slots[32] = {0};
+    CallbackWorkerBatchItem items[32];
+    for (int i = 0; i < 32; ++i) {
+        items[i].callback = test_user_data_callback;
+        items[i].user_data = &slots[i];
+    }
+    
+    result = callback_worker_enqueue_batch(worker, items, 32, &handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_wait_timeout(handle, 5000);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_release(handle);
+    ASSERT_SUCCESS(result);
+    
+    for (int i = 0; i < 32; ++i) {
+        ASSERT_EQ(1, slots[i]);
+    }
+    
+    // Fire-and-forget batch, then an empty batch
+    result = callback_worker_enqueue_batch(worker, items, 32, NULL);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_batch(worker, items, 0, NULL);
+    ASSERT_SUCCESS(result);
+    
+    // A NULL callback rejects the whole batch
+    items[5].callback = NULL;
+    result = callback_worker_enqueue_batch(worker, items, 32, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    result = callback_worker_enqueue_batch(worker, NULL, 1, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    // Destruction waits for the fire-and-forget batch
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    for (int i = 0; i < 32; ++i) {
+        ASSERT_EQ(2, slots[i]);
+    }
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+int test_priority_enqueue(void) {
+    printf("Running test_priority_enqueue...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerTaskHandle* handle = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(2, &worker);
+    ASSERT_SUCCESS(result);
+    
+    int slot = 0;
+    result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_HIGH,
+                                              test_user_data_callback, &slot, &handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_wait_timeout(handle, 5000);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_release(handle);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, slot);
+    
+    result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_LOW,
+                                              test_user_data_callback, &slot, NULL);
+    ASSERT_SUCCESS(result);
+    
+    result = callback_worker_enqueue_priority(worker, (CallbackWorkerPriority)42,
+                                              test_user_data_callback, &slot, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_INVALID_PARAM, result);
+    result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                              NULL, &slot, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(2, slot);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+void test_blocking_callback(void* user_data) {
+    ReleaseFlag* release = (ReleaseFlag*)user_data;
+    while (!*release) {
+    }
+}
+
+int test_bounded_queue(void) {
+    printf("Running test_bounded_queue...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create_bounded(1, 0, CALLBACK_WORKER_OVERFLOW_REJECT, NULL, NULL,
+                                            &worker);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_INVALID_PARAM, result);
+    result = callback_worker_create_bounded(1, 1, (CallbackWorkerOverflowPolicy)42, NULL, NULL,
+                                            &worker);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_INVALID_PARAM, result);
+    
+    result = callback_worker_create_bounded(1, 1, CALLBACK_WORKER_OVERFLOW_REJECT, NULL, NULL,
+                                            &worker);
+    ASSERT_SUCCESS(result);
+    
+    // Occupy the worker, then fill the single queue slot
+    ReleaseFlag release = 0;
+    int slot = 0;
+    CallbackWorkerTaskHandle* handle = NULL;
+    result = callback_worker_try_enqueue(worker, test_blocking_callback, (void*)&release, &handle);
+    ASSERT_SUCCESS(result);
+    size_t queue_size = 1;
+    while (queue_size != 0) {
+        callback_worker_get_queue_size(worker, &queue_size);
+    }
+    result = callback_worker_try_enqueue(worker, test_user_data_callback, &slot, NULL);
+    ASSERT_SUCCESS(result);
+    
+    result = callback_worker_try_enqueue(worker, test_user_data_callback, &slot, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_QUEUE_FULL, result);
+    result = callback_worker_enqueue_timeout(worker, test_user_data_callback, &slot, 10, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_QUEUE_FULL, result);
+    result = callback_worker_enqueue_int_async(worker, test_int_callback, 1, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_QUEUE_FULL, result);
+    
+    release = 1;
+    result = callback_worker_task_wait(handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_release(handle);
+    ASSERT_SUCCESS(result);
+    
+    result = callback_worker_enqueue_timeout(worker, test_user_data_callback, &slot, 5000, NULL);
+    ASSERT_SUCCESS(result);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(2, slot);
+    
+    // A dropped task's handle reports it, so the caller can tell it from one that ran
+    result = callback_worker_create_bounded(1, 1, CALLBACK_WORKER_OVERFLOW_DROP_OLDEST, NULL,
+                                            NULL, &worker);
+    ASSERT_SUCCESS(result);
+    release = 0;
+    reset_test_state();
+    result = callback_worker_try_enqueue(worker, test_blocking_callback, (void*)&release, &handle);
+    ASSERT_SUCCESS(result);
+    queue_size = 1;
+    while (queue_size != 0) {
+        callback_worker_get_queue_size(worker, &queue_size);
+    }
+    CallbackWorkerTaskHandle* dropped = NULL;
+    CallbackWorkerTaskHandle* kept = NULL;
+    result = callback_worker_enqueue_int_async(worker, test_int_callback, 1, &dropped);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_int_async(worker, test_int_callback, 2, &kept);
+    ASSERT_SUCCESS(result);
+    
+    int completed = 0;
+    result = callback_worker_task_poll(dropped, &completed);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_DROPPED, result);
+    ASSERT_EQ(1, completed);
+    result = callback_worker_task_wait(dropped);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_DROPPED, result);
+    
+    release = 1;
+    result = callback_worker_task_wait(kept);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_wait_timeout(kept, 0);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, g_callback_count);
+    ASSERT_EQ(2, g_last_int_value);
+    
+    callback_worker_task_release(dropped);
+    callback_worker_task_release(kept);
+    callback_worker_task_release(handle);
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+static CallbackWorkerThreadC* g_nested_worker = NULL;
+static int g_nested_result = 0;
+
+// Calls back into its own one-thread worker synchronously
+void test_nested_sync_callback(int arg) {
+    callback_worker_enqueue_int_return_sync(g_nested_worker, test_int_return_callback, arg, 1,
+                                            &g_nested_result);
+}
+
+static CallbackWorkerResult g_nested_wait_results[2];
+
+// Waits on completion handles of its own one-thread worker
+void test_nested_handle_callback(void* user_data) {
+    CallbackWorkerTaskHandle* handle = NULL;
+    callback_worker_enqueue_priority(g_nested_worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                     test_user_data_callback, user_data, &handle);
+    g_nested_wait_results[0] = callback_worker_task_wait(handle);
+    callback_worker_task_release(handle);
+    
+    callback_worker_enqueue_priority(g_nested_worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                     test_user_data_callback, user_data, &handle);
+    g_nested_wait_results[1] = callback_worker_task_wait_timeout(handle, 10000);
+    callback_worker_task_release(handle);
+}
+
+int test_caller_runs(void) {
+    printf("Running test_caller_runs...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create_bounded(1, 1, CALLBACK_WORKER_OVERFLOW_CALLER_RUNS, NULL,
+                                            NULL, &worker);
+    ASSERT_SUCCESS(result);
+    
+    // Occupy the worker and fill the single queue slot; the next task runs on this thread
+    ReleaseFlag release = 0;
+    int queued_slot = 0;
+    int inline_slot = 0;
+    CallbackWorkerTaskHandle* handle = NULL;
+    result = callback_worker_try_enqueue(worker, test_blocking_callback, (void*)&release, &handle);
+    ASSERT_SUCCESS(result);
+    size_t queue_size = 1;
+    while (queue_size != 0) {
+        callback_worker_get_queue_size(worker, &queue_size);
+    }
+    result = callback_worker_try_enqueue(worker, test_user_data_callback, &queued_slot, NULL);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                              test_user_data_callback, &inline_slot, NULL);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, inline_slot);
+    
+    release = 1;
+    result = callback_worker_task_wait(handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_release(handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, queued_slot);
+    
+    // A synchronous call from inside a callback runs the nested task instead of deadlocking
+    result = callback_worker_create(1, &g_nested_worker);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_int(g_nested_worker, test_nested_sync_callback, 41);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(42, g_nested_result);
+    
+    // So does waiting on a completion handle
+    int nested_slot = 0;
+    result = callback_worker_enqueue_priority(g_nested_worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                              test_nested_handle_callback, &nested_slot,
+                                              &handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_task_wait(handle);
+    ASSERT_SUCCESS(result);
+    callback_worker_task_release(handle);
+    ASSERT_SUCCESS(g_nested_wait_results[0]);
+    ASSERT_SUCCESS(g_nested_wait_results[1]);
+    ASSERT_EQ(2, nested_slot);
+    result = callback_worker_destroy(g_nested_worker);
+    ASSERT_SUCCESS(result);
+    g_nested_worker = NULL;
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+int test_metrics(void) {
+    printf("Running test_metrics...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerMetrics metrics;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(2, &worker);
+    ASSERT_SUCCESS(result);
+    
+    result = callback_worker_get_metrics(worker, &metrics);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(0, metrics.enabled);
+    ASSERT_EQ(2, (int)metrics.thread_count);
+    
+    result = callback_worker_set_metrics_enabled(worker, 1);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_get_metrics(worker, &metrics);
+    ASSERT_SUCCESS(result);
+    if (metrics.enabled) {
+        int slot = 0;
+        int i;
+        for (i = 0; i < 10; ++i) {
+            result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                                      test_user_data_callback, &slot, NULL);
+            ASSERT_SUCCESS(result);
+        }
+        do {
+            result = callback_worker_get_metrics(worker, &metrics);
+            ASSERT_SUCCESS(result);
+        } while (metrics.tasks_executed < 10);
+        ASSERT_EQ(10, (int)metrics.tasks_executed);
+        assert(metrics.execution_p50_ns <= metrics.execution_max_ns);
+        assert(metrics.queue_wait_p99_ns <= metrics.queue_wait_max_ns);
+        
+        // The per-worker counters add up to the totals
+        CallbackWorkerWorkerMetrics per_worker[4];
+        size_t count = 0;
+        result = callback_worker_get_worker_metrics(worker, per_worker, 4, &count);
+        ASSERT_SUCCESS(result);
+        ASSERT_EQ(2, (int)count);
+        ASSERT_EQ(10, (int)(per_worker[0].tasks_executed + per_worker[1].tasks_executed));
+        ASSERT_EQ(0, (int)(per_worker[0].exceptions + per_worker[1].exceptions));
+    }
+    
+    size_t slots = 0;
+    result = callback_worker_get_worker_metrics(worker, NULL, 0, &slots);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(2, (int)slots);
+    
+    result = callback_worker_get_metrics(worker, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    result = callback_worker_get_worker_metrics(worker, NULL, 1, &slots);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+int test_wait_idle(void) {
+    printf("Running test_wait_idle...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(2, &worker);
+    ASSERT_SUCCESS(result);
+    
+    ReleaseFlag release = 0;
+    int slots[16] = {0};
+    int i;
+    result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                              test_blocking_callback, (void*)&release, NULL);
+    ASSERT_SUCCESS(result);
+    for (i = 0; i < 16; ++i) {
+        result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                                  test_user_data_callback, &slots[i], NULL);
+        ASSERT_SUCCESS(result);
+    }
+    
+    result = callback_worker_wait_idle_timeout(worker, 10);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_TIMEOUT, result);
+    
+    release = 1;
+    result = callback_worker_wait_idle(worker);
+    ASSERT_SUCCESS(result);
+    for (i = 0; i < 16; ++i) {
+        ASSERT_EQ(1, slots[i]);
+    }
+    
+    // The pool keeps accepting work after going idle
+    result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                              test_user_data_callback, &slots[0], NULL);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_wait_idle_timeout(worker, 5000);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(2, slots[0]);
+    
+    result = callback_worker_wait_idle(NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+int test_elastic_resize(void) {
+    printf("Running test_elastic_resize...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerResult result;
+    size_t count = 0;
+    
+    result = callback_worker_create_elastic(0, 4, 100, &worker);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_INVALID_PARAM, result);
+    result = callback_worker_create_elastic(2, 1, 100, &worker);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_INVALID_PARAM, result);
+    
+    result = callback_worker_create_elastic(1, 4, 60000, &worker);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_get_thread_count(worker, &count);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, (int)count);
+    
+    result = callback_worker_resize(worker, 4);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_get_thread_count(worker, &count);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(4, (int)count);
+    
+    result = callback_worker_resize(worker, 5);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_INVALID_PARAM, result);
+    result = callback_worker_resize(NULL, 2);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    result = callback_worker_resize(worker, 2);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_get_thread_count(worker, &count);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(2, (int)count);
+    
+    int return_value = 0;
+    result = callback_worker_enqueue_int_return_sync(worker, test_int_return_callback, 2, 3,
+                                                     &return_value);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(5, return_value);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+void test_count_callback(void* user_data) {
+    ReleaseFlag* count = (ReleaseFlag*)user_data;
+    *count += 1;
+}
+
+int test_timers(void) {
+    printf("Running test_timers...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(1, &worker);
+    ASSERT_SUCCESS(result);
+    
+    // A far-off timer is cancelled before it fires; a near one runs
+    ReleaseFlag fired = 0;
+    ReleaseFlag never = 0;
+    int cancelled = 0;
+    CallbackWorkerTimer* near_timer = NULL;
+    CallbackWorkerTimer* far_timer = NULL;
+    result = callback_worker_enqueue_after(worker, 60000, test_count_callback, (void*)&never,
+                                           &far_timer);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_after(worker, 10, test_count_callback, (void*)&fired,
+                                           &near_timer);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_timer_cancel(far_timer, &cancelled);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, cancelled);
+    while (fired == 0) {
+    }
+    result = callback_worker_timer_cancel(near_timer, &cancelled);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(0, cancelled);
+    callback_worker_timer_release(near_timer);
+    callback_worker_timer_release(far_timer);
+    
+    // A periodic callback runs until cancelled
+    ReleaseFlag ticks = 0;
+    CallbackWorkerTimer* periodic = NULL;
+    result = callback_worker_schedule_periodic(worker, 0, test_count_callback, (void*)&ticks,
+                                               &periodic);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_INVALID_PARAM, result);
+    result = callback_worker_schedule_periodic(worker, 1, test_count_callback, (void*)&ticks,
+                                               &periodic);
+    ASSERT_SUCCESS(result);
+    while (ticks < 3) {
+    }
+    result = callback_worker_timer_cancel(periodic, &cancelled);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, cancelled);
+    callback_worker_timer_release(periodic);
+    
+    result = callback_worker_enqueue_after(NULL, 1, test_count_callback, NULL, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    result = callback_worker_timer_cancel(NULL, &cancelled);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(0, never);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
+int test_cancellation(void) {
+    printf("Running test_cancellation...\n");
+    
+    CallbackWorkerThreadC* worker = NULL;
+    CallbackWorkerCancelSource* source = NULL;
+    CallbackWorkerResult result;
+    
+    result = callback_worker_create(1, &worker);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_cancel_source_create(&source);
+    ASSERT_SUCCESS(result);
+    
+    // Queue callbacks behind a blocked worker, then cancel the source and one tag
+    ReleaseFlag release = 0;
+    ReleaseFlag cancelled_runs = 0;
+    ReleaseFlag kept_runs = 0;
+    CallbackWorkerTaskHandle* handle = NULL;
+    CallbackWorkerTaskHandle* tagged_handle = NULL;
+    CallbackWorkerTaskHandle* kept_handle = NULL;
+    int cancelled = 0;
+    result = callback_worker_enqueue_priority(worker, CALLBACK_WORKER_PRIORITY_NORMAL,
+                                              test_blocking_callback, (void*)&release, NULL);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_cancellable(worker, source, test_count_callback,
+                                                 (void*)&cancelled_runs, &handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_tagged(worker, 7, test_count_callback,
+                                            (void*)&cancelled_runs, &tagged_handle);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_enqueue_tagged(worker, 8, test_count_callback, (void*)&kept_runs,
+                                            &kept_handle);
+    ASSERT_SUCCESS(result);
+    
+    result = callback_worker_cancel_source_cancel(source);
+    ASSERT_SUCCESS(result);
+    result = callback_worker_cancel_source_is_cancelled(source, &cancelled);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, cancelled);
+    result = callback_worker_cancel_tag(worker, 7, &cancelled);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(1, cancelled);
+    
+    release = 1;
+    result = callback_worker_task_wait(handle);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_CANCELLED, result);
+    callback_worker_task_release(handle);
+    result = callback_worker_task_wait(tagged_handle);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_CANCELLED, result);
+    callback_worker_task_release(tagged_handle);
+    result = callback_worker_task_wait(kept_handle);
+    ASSERT_SUCCESS(result);
+    callback_worker_task_release(kept_handle);
+    result = callback_worker_wait_idle(worker);
+    ASSERT_SUCCESS(result);
+    ASSERT_EQ(0, cancelled_runs);
+    ASSERT_EQ(1, kept_runs);
+    
+    result = callback_worker_enqueue_cancellable(worker, NULL, test_count_callback, NULL, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    result = callback_worker_cancel_tag(NULL, 7, NULL);
+    ASSERT_EQ(CALLBACK_WORKER_ERROR_NULL_POINTER, result);
+    
+    callback_worker_cancel_source_release(source);
+    result = callback_worker_destroy(worker);
+    ASSERT_SUCCESS(result);
+    
+    printf("  PASSED\n");
+    return 1;
+}
+
 int test_queue_size(void) {
     printf("Running test_queue_size...\n");
     
@@ -285,6 +1056,21 @@ int test_error_string_conversion(void) {
     assert(msg != NULL);
     assert(strlen(msg) > 0);
     
+    msg = callback_worker_result_to_string(CALLBACK_WORKER_ERROR_TIMEOUT);
+    assert(msg != NULL);
+    assert(strlen(msg) > 0);
+    
+    msg = callback_worker_result_to_string(CALLBACK_WORKER_ERROR_QUEUE_FULL);
+    assert(msg != NULL);
+    assert(strlen(msg) > 0);
+    
+    msg = callback_worker_result_to_string(CALLBACK_WORKER_ERROR_DROPPED);
+    assert(msg != NULL);
+    assert(strlen(msg) > 0);
+    msg = callback_worker_result_to_string(CALLBACK_WORKER_ERROR_CANCELLED);
+    assert(msg != NULL);
+    assert(strlen(msg) > 0);
+    
     printf("  PASSED\n");
     return 1;
 }
@@ -300,6 +1086,18 @@ int main(void) {
     total++; if (test_default_callback_execution()) passed++;
     total++; if (test_various_callbacks()) passed++;
     total++; if (test_return_value_callback()) passed++;
+    total++; if (test_async_callbacks()) passed++;
+    total++; if (test_owned_string()) passed++;
+    total++; if (test_allocator_stats()) passed++;
+    total++; if (test_batch_enqueue()) passed++;
+    total++; if (test_priority_enqueue()) passed++;
+    total++; if (test_bounded_queue()) passed++;
+    total++; if (test_caller_runs()) passed++;
+    total++; if (test_metrics()) passed++;
+    total++; if (test_wait_idle()) passed++;
+    total++; if (test_elastic_resize()) passed++;
+    total++; if (test_timers()) passed++;
+    total++; if (test_cancellation()) passed++;
     total++; if (test_queue_size()) passed++;
     total++; if (test_error_handling()) passed++;
     total++; if (test_error_string_conversion()) passed++;
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/coroutine.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+CoTask<std::thread::id> WorkerId(CallbackWorkerThread& pool) {
+  co_await Schedule(pool);
+  co_return std::this_thread::get_id();
+}
+
+TEST(CoroutineTest, ScheduleResumesOnWorker) {
+  CallbackWorkerThread pool(2);
+  const std::thread::id worker = Spawn(pool, WorkerId(pool)).Get();
+  EXPECT_NE(std::this_thread::get_id(), worker);
+}
+
+CoTask<int> Add(CallbackWorkerThread& pool, int a, int b) {
+  co_await Schedule(pool);
+  co_return a + b;
+}
+
+CoTask<std::string> AddTwice(CallbackWorkerThread& pool) {
+  const int first = co_await Add(pool, 1, 2);
+  const int second = co_await Add(pool, first, 4);
+  co_return std::to_string(second);
+}
+
+TEST(CoroutineTest, AwaitedTasksResumeTheirAwaiter) {
+  CallbackWorkerThread pool(2);
+  EXPECT_EQ("7", Spawn(pool, AddTwice(pool)).Get());
+
+  // Spawned coroutines run concurrently; their futures chain like EnqueueFuture's
+  std::vector<Future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(Spawn(pool, Add(pool, i, 1)));
+  }
+  const std::vector<int> sums = WhenAll(std::move(futures)).Get();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i + 1, sums[static_cast<size_t>(i)]);
+  }
+}
+
+TEST(CoroutineTest, BoundedPoolNeverDropsResumptions) {
+  for (OverflowPolicy policy : {OverflowPolicy::kDropOldest, OverflowPolicy::kCallerRuns,
+                                OverflowPolicy::kReject}) {
+    CallbackWorkerThreadOptions options;
+    options.thread_count = 1;
+    options.max_queue_size = 1;
+    options.overflow_policy = policy;
+    CallbackWorkerThread pool(options);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.Post([opened]() { opened.wait(); });
+    while (pool.GetQueueSize() != 0) {
+      std::this_thread::yield();
+    }
+
+    // Far more resumptions than the queue admits, interleaved with ordinary posts that the
+    // policy blocks, drops, rejects or runs inline; each resumption must still run exactly once
+    std::vector<Future<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+      futures.push_back(Spawn(pool, Add(pool, i, 1)));
+      try {
+        pool.Post([]() {});
+      } catch (const QueueFullError&) {
+      }
+    }
+    gate.set_value();
+    const std::vector<int> sums = WhenAll(std::move(futures)).Get();
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(i + 1, sums[static_cast<size_t>(i)]);
+    }
+  }
+}
+
+CoTask<long> SumTo(int n) {
+  if (n == 0) {
+    co_return 0;
+  }
+  co_return n + co_await SumTo(n - 1);
+}
+
+TEST(CoroutineTest, DeepAwaitChainsOnOneWorker) {
+  // Completion transfers straight to the awaiter, so deep chains neither block the only worker
+  // nor grow the stack per level
+  CallbackWorkerThread pool(1);
+  EXPECT_EQ(50005000L, Spawn(pool, SumTo(10000)).Get());
+}
+
+CoTask<int> Fail(CallbackWorkerThread& pool) {
+  co_await Schedule(pool);
+  throw std::runtime_error("coroutine failed");
+}
+
+CoTask<void> AwaitFailure(CallbackWorkerThread& pool, bool* caught) {
+  try {
+    co_await Fail(pool);
+  } catch (const std::runtime_error&) {
+    *caught = true;
+  }
+  co_await Fail(pool);
+}
+
+TEST(CoroutineTest, ExceptionsPropagateToAwaiter) {
+  CallbackWorkerThread pool(2);
+  bool caught = false;
+  EXPECT_THROW(Spawn(pool, AwaitFailure(pool, &caught)).Get(), std::runtime_error);
+  EXPECT_TRUE(caught);
+
+  CallbackWorkerThread stopped(1);
+  stopped.Stop();
+  EXPECT_THROW(Spawn(stopped, Add(stopped, 1, 1)).Get(), std::runtime_error);
+}
+
+std::atomic<int> frames_allocated{0};
+std::atomic<int> frames_freed{0};
+
+void* CountingAllocate(size_t size) {
+  frames_allocated.fetch_add(1);
+  return std::malloc(size);
+}
+
+void CountingDeallocate(void* frame, size_t) {
+  frames_freed.fetch_add(1);
+  std::free(frame);
+}
+
+TEST(CoroutineTest, FramesUseInstalledAllocator) {
+  static const CoroutineFrameAllocator kCounting{CountingAllocate, CountingDeallocate};
+  CallbackWorkerThread pool(2);
+  SetCoroutineFrameAllocator(&kCounting);
+  // Spawn's runner, AddTwice and its two Add calls
+  EXPECT_EQ("7", Spawn(pool, AddTwice(pool)).Get());
+  {
+    // Lazily started: never awaited, so the body never runs, but the frame is freed
+    CoTask<int> unstarted = Add(pool, 1, 1);
+    EXPECT_TRUE(unstarted.Valid());
+  }
+  SetCoroutineFrameAllocator(nullptr);
+  pool.WaitIdle();
+
+  EXPECT_EQ(5, frames_allocated.load());
+  EXPECT_EQ(5, frames_freed.load());
+}
+
+}  // namespace
+
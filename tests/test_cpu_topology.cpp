@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/cpu_topology.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(CpuTopologyTest, ParseCpuList) {
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 8, 10, 11}), ParseCpuList("0-3,8,10-11\n"));
+  EXPECT_EQ((std::vector<int>{5}), ParseCpuList(" 5 "));
+  EXPECT_TRUE(ParseCpuList("").empty());
+  // Malformed entries are skipped, the rest is kept
+  EXPECT_EQ((std::vector<int>{1, 7}), ParseCpuList("1,x,4-2,-3,7"));
+}
+
+TEST(CpuTopologyTest, FromNodesMapsCpusToNodes) {
+  const CpuTopology topology = CpuTopology::FromNodes({{4, 5, 6, 7}, {}, {0, 1, 2, 3}});
+  ASSERT_EQ(2u, topology.nodes.size());
+  EXPECT_EQ(0u, topology.NodeOfCpu(5));
+  EXPECT_EQ(1u, topology.NodeOfCpu(2));
+  EXPECT_EQ(0u, topology.NodeOfCpu(-1));
+  EXPECT_EQ(0u, topology.NodeOfCpu(100));
+}
+
+TEST(CpuTopologyTest, RestrictKeepsRequestedCpus) {
+  const CpuTopology topology = CpuTopology::FromNodes({{0, 1, 2, 3}, {4, 5, 6, 7}});
+
+  const CpuTopology one_node = topology.Restrict({5, 6});
+  ASSERT_EQ(1u, one_node.nodes.size());
+  EXPECT_EQ((std::vector<int>{5, 6}), one_node.nodes[0]);
+
+  const CpuTopology both = topology.Restrict({1, 7});
+  ASSERT_EQ(2u, both.nodes.size());
+  EXPECT_EQ(1u, both.NodeOfCpu(7));
+
+  EXPECT_EQ(2u, topology.Restrict({}).nodes.size());
+  // CPUs unknown to the topology still form a node
+  EXPECT_EQ((std::vector<int>{42}), topology.Restrict({42}).nodes[0]);
+}
+
+TEST(CpuTopologyTest, DetectFindsCurrentCpu) {
+  const CpuTopology topology = CpuTopology::Detect();
+  ASSERT_FALSE(topology.nodes.empty());
+  size_t cpus = 0;
+  for (const auto& node : topology.nodes) {
+    EXPECT_FALSE(node.empty());
+    cpus += node.size();
+  }
+  EXPECT_GE(cpus, 1u);
+
+  const int cpu = GetCurrentCpu();
+  if (cpu >= 0) {
+    EXPECT_LT(topology.NodeOfCpu(cpu), topology.nodes.size());
+  }
+}
+
+TEST(CpuTopologyTest, SetCurrentThreadAffinityPinsThread) {
+  const int cpu = GetCurrentCpu();
+  if (cpu < 0) {
+    GTEST_SKIP() << "Current CPU is not available on this platform";
+  }
+
+  // Pin a fresh thread to the CPU this one is running on, which the process may certainly use
+  bool pinned = false;
+  int observed = -1;
+  std::thread thread([&]() {
+    pinned = SetCurrentThreadAffinity({cpu});
+    observed = GetCurrentCpu();
+  });
+  thread.join();
+  ASSERT_TRUE(pinned);
+  EXPECT_EQ(cpu, observed);
+
+  EXPECT_FALSE(SetCurrentThreadAffinity({}));
+}
+
+}  // namespace
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(FutureTest, ThenChainsOnThePool) {
+  CallbackWorkerThread pool(2);
+  const std::thread::id caller = std::this_thread::get_id();
+
+  std::atomic<bool> on_caller{false};
+  Future<std::string> result = pool.EnqueueFuture([](int x) { return x + 1; }, 41)
+                                   .Then([](int x) { return x * 2; })
+                                   .Then([&](int x) {
+                                     on_caller = std::this_thread::get_id() == caller;
+                                     return std::to_string(x);
+                                   });
+  EXPECT_EQ("84", result.Get());
+  EXPECT_FALSE(result.Valid());
+  EXPECT_FALSE(on_caller.load());
+
+  Future<void> done = pool.EnqueueFuture([]() {}).Then([]() {});
+  done.Get();
+}
+
+TEST(FutureTest, ExceptionSkipsContinuations) {
+  CallbackWorkerThread pool(2);
+  std::atomic<int> runs{0};
+  Future<int> result = pool.EnqueueFuture([]() -> int { throw std::runtime_error("boom"); })
+                           .Then([&](int x) {
+                             ++runs;
+                             return x;
+                           })
+                           .Then([&](int x) {
+                             ++runs;
+                             return x;
+                           });
+  EXPECT_THROW(result.Get(), std::runtime_error);
+  EXPECT_EQ(0, runs.load());
+
+  // A throwing continuation fails the future it returns
+  Future<void> failed = pool.EnqueueFuture([]() { return 1; }).Then([](int) {
+    throw std::logic_error("continuation");
+  });
+  EXPECT_THROW(failed.Get(), std::logic_error);
+}
+
+TEST(FutureTest, PromiseRules) {
+  // Continuations of a standalone promise run inline, also when attached after the fact
+  Promise<int> ready;
+  Future<int> ready_future = ready.GetFuture();
+  ready.SetValue(7);
+  EXPECT_TRUE(ready_future.IsReady());
+  const std::thread::id caller = std::this_thread::get_id();
+  std::thread::id ran_on;
+  Future<int> chained = std::move(ready_future).Then([&](int x) {
+    ran_on = std::this_thread::get_id();
+    return x + 1;
+  });
+  EXPECT_EQ(caller, ran_on);
+  EXPECT_EQ(8, chained.Get());
+
+  Promise<void> promise;
+  Future<void> future = promise.GetFuture();
+  EXPECT_THROW(promise.GetFuture(), std::future_error);
+  promise.SetValue();
+  EXPECT_THROW(promise.SetValue(), std::future_error);
+  EXPECT_THROW(promise.SetException(std::make_exception_ptr(std::runtime_error("late"))),
+               std::future_error);
+  future.Get();
+
+  // A promise destroyed unfulfilled breaks its future
+  Future<int> broken;
+  {
+    Promise<int> abandoned;
+    broken = abandoned.GetFuture();
+    EXPECT_FALSE(broken.WaitFor(std::chrono::milliseconds(1)));
+  }
+  try {
+    broken.Get();
+    FAIL() << "Expected broken_promise";
+  } catch (const std::future_error& e) {
+    EXPECT_EQ(std::future_errc::broken_promise, e.code());
+  }
+
+  Future<int> invalid;
+  EXPECT_THROW(invalid.Then([](int x) { return x; }), std::future_error);
+}
+
+TEST(FutureTest, WhenAllCollectsInInputOrder) {
+  CallbackWorkerThread pool(4);
+  std::vector<Future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.EnqueueFuture([i]() {
+      std::this_thread::sleep_for(std::chrono::microseconds((100 - i) * 10));
+      return i;
+    }));
+  }
+  const std::vector<int> values =
+      WhenAll(std::move(futures)).Then([](std::vector<int> v) { return v; }).Get();
+  ASSERT_EQ(100u, values.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, values[static_cast<size_t>(i)]);
+  }
+
+  std::atomic<int> count{0};
+  std::vector<Future<void>> voids;
+  for (int i = 0; i < 10; ++i) {
+    voids.push_back(pool.EnqueueFuture([&]() { ++count; }));
+  }
+  WhenAll(std::move(voids)).Get();
+  EXPECT_EQ(10, count.load());
+
+  EXPECT_TRUE(WhenAll(std::vector<Future<int>>()).Get().empty());
+
+  std::vector<Future<int>> failing;
+  failing.push_back(pool.EnqueueFuture([]() { return 1; }));
+  failing.push_back(pool.EnqueueFuture([]() -> int { throw std::runtime_error("fail"); }));
+  EXPECT_THROW(WhenAll(std::move(failing)).Get(), std::runtime_error);
+}
+
+TEST(FutureTest, WhenAnyReturnsFirstCompleted) {
+  CallbackWorkerThread pool(2);
+  Promise<std::string> slow;
+  std::vector<Future<std::string>> futures;
+  futures.push_back(slow.GetFuture());
+  futures.push_back(pool.EnqueueFuture([]() { return std::string("fast"); }));
+
+  WhenAnyResult<std::string> first = WhenAny(std::move(futures)).Get();
+  EXPECT_EQ(1u, first.index);
+  EXPECT_EQ("fast", first.value);
+  // Later results are discarded
+  slow.SetValue("slow");
+
+  std::vector<Future<void>> voids;
+  voids.push_back(pool.EnqueueFuture([]() {}));
+  EXPECT_EQ(0u, WhenAny(std::move(voids)).Get().index);
+
+  EXPECT_THROW(WhenAny(std::vector<Future<int>>()), std::invalid_argument);
+}
+
+TEST(FutureTest, LongChainOnOneWorkerDoesNotBlock) {
+  // With one worker, a continuation that waited for its antecedent would deadlock; chained
+  // continuations instead each run as a separate task once their input is ready
+  CallbackWorkerThread pool(1);
+  Future<int> future = pool.EnqueueFuture([]() { return 0; });
+  for (int i = 0; i < 1000; ++i) {
+    future = future.Then([](int x) { return x + 1; });
+  }
+  EXPECT_EQ(1000, future.Get());
+}
+
+TEST(FutureTest, StoppedPoolBreaksPendingContinuations) {
+  CallbackWorkerThread pool(1);
+  Promise<int> promise;
+  Future<int> chained = promise.GetFuture().Then(pool, [](int x) { return x; });
+  pool.Stop();
+
+  promise.SetValue(1);
+  EXPECT_THROW(chained.Get(), std::future_error);
+}
+
+TEST(FutureTest, FuturesOutliveTheirPool) {
+  Future<int> done;
+  Future<int> pending;
+  Promise<int> promise;
+  {
+    CallbackWorkerThread pool(1);
+    done = pool.EnqueueFuture([] { return 1; });
+    pending = promise.GetFuture().Then(pool, [](int x) { return x; });
+  }
+
+  // Both continuations target the destroyed pool, so they are dropped instead of touching it
+  Future<int> chained = done.Then([](int x) { return x + 1; });
+  promise.SetValue(1);
+  std::vector<Future<int>> inputs;
+  inputs.push_back(std::move(chained));
+  Future<std::vector<int>> all = WhenAll(std::move(inputs));
+  try {
+    all.Get();
+    FAIL() << "Expected broken_promise";
+  } catch (const std::future_error& e) {
+    EXPECT_EQ(std::future_errc::broken_promise, e.code());
+  }
+  EXPECT_THROW(pending.Get(), std::future_error);
+}
+
+}  // namespace
+
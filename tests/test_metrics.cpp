@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+#include "callback_worker_thread/metrics.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(MetricsTest, BucketsAreContiguousAndTight) {
+  for (size_t i = 0; i + 1 < HistogramBuckets::kCount; ++i) {
+    EXPECT_EQ(HistogramBuckets::UpperBound(i) + 1, HistogramBuckets::LowerBound(i + 1)) << i;
+  }
+  EXPECT_EQ(~uint64_t{0}, HistogramBuckets::UpperBound(HistogramBuckets::kCount - 1));
+
+  for (uint64_t value : {0ull, 1ull, 3ull, 4ull, 7ull, 8ull, 1000ull, 123456789ull, ~0ull}) {
+    const size_t index = HistogramBuckets::Index(value);
+    ASSERT_LT(index, HistogramBuckets::kCount);
+    EXPECT_LE(HistogramBuckets::LowerBound(index), value);
+    EXPECT_GE(HistogramBuckets::UpperBound(index), value);
+    // Bucket width is at most a quarter of its lower bound
+    EXPECT_LE(HistogramBuckets::UpperBound(index) - HistogramBuckets::LowerBound(index),
+              HistogramBuckets::LowerBound(index) / 4);
+  }
+}
+
+TEST(MetricsTest, HistogramPercentiles) {
+  LatencyHistogram histogram;
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.Record(value);
+  }
+
+  HistogramSnapshot snapshot;
+  histogram.MergeInto(snapshot);
+  EXPECT_EQ(1000u, snapshot.count);
+  EXPECT_EQ(1000u, snapshot.max);
+  EXPECT_DOUBLE_EQ(500.5, snapshot.Mean());
+
+  // Estimates are bucket upper bounds, so within one bucket width above the exact value
+  const uint64_t p50 = snapshot.Percentile(0.5);
+  EXPECT_GE(p50, 500u);
+  EXPECT_LE(p50, 500u + 500u / 4);
+  const uint64_t p99 = snapshot.Percentile(0.99);
+  EXPECT_GE(p99, 990u);
+  EXPECT_LE(p99, 1000u);
+  EXPECT_EQ(1000u, snapshot.Percentile(1.0));
+  EXPECT_EQ(0u, HistogramSnapshot().Percentile(0.5));
+}
+
+TEST(MetricsTest, PoolCollectsPerWorkerMetrics) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 2;
+  options.enable_metrics = true;
+  CallbackWorkerThread worker(options);
+  if (!worker.GetMetrics().enabled) {
+    GTEST_SKIP() << "metrics compiled out";
+  }
+
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 50; ++i) {
+    futures.push_back(worker.Enqueue([]() {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  worker.Post([]() { throw std::runtime_error("counted"); });
+
+  MetricsSnapshot snapshot;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  do {
+    snapshot = worker.GetMetrics();
+  } while (snapshot.total.tasks_executed < 51 && std::chrono::steady_clock::now() < deadline);
+
+  EXPECT_TRUE(snapshot.enabled);
+  ASSERT_EQ(2u, snapshot.workers.size());
+  EXPECT_EQ(51u, snapshot.total.tasks_executed);
+  EXPECT_EQ(1u, snapshot.total.exceptions);
+  EXPECT_EQ(51u, snapshot.execution.count);
+  EXPECT_EQ(51u, snapshot.queue_wait.count);
+  EXPECT_GE(snapshot.total.busy_ns, 50u * 100000u);
+  EXPECT_GE(snapshot.execution.Percentile(0.5), 100000u);
+  EXPECT_EQ(snapshot.workers[0].tasks_executed + snapshot.workers[1].tasks_executed, 51u);
+}
+
+TEST(MetricsTest, DisabledPoolRecordsNothing) {
+  CallbackWorkerThread worker(1);
+  worker.Enqueue([]() {}).get();
+
+  MetricsSnapshot snapshot = worker.GetMetrics();
+  EXPECT_FALSE(snapshot.enabled);
+  EXPECT_EQ(0u, snapshot.total.tasks_executed);
+  EXPECT_EQ(0u, snapshot.execution.count);
+
+  // Runtime switch (a no-op when the library is built with ENABLE_METRICS=OFF)
+  worker.SetMetricsEnabled(true);
+  if (!worker.GetMetrics().enabled) {
+    GTEST_SKIP() << "metrics compiled out";
+  }
+  worker.Enqueue([]() {}).get();
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  do {
+    snapshot = worker.GetMetrics();
+  } while (snapshot.total.tasks_executed == 0 && std::chrono::steady_clock::now() < deadline);
+  EXPECT_EQ(1u, snapshot.total.tasks_executed);
+  EXPECT_EQ(1u, snapshot.queue_wait.count);
+}
+
+}  // namespace
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/mpmc_queue.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(MpmcQueueTest, CapacityIsRoundedUpToPowerOfTwo) {
+  EXPECT_EQ(2u, MpmcQueue<int>(1).Capacity());
+  EXPECT_EQ(8u, MpmcQueue<int>(5).Capacity());
+  EXPECT_EQ(16u, MpmcQueue<int>(16).Capacity());
+  EXPECT_THROW(MpmcQueue<int>(0), std::invalid_argument);
+}
+
+TEST(MpmcQueueTest, FifoOrderAndFullEmptyDetection) {
+  MpmcQueue<int> queue(4);
+  int value = 0;
+
+  EXPECT_FALSE(queue.TryPop(value));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.TryPush(int(i)));
+  }
+  EXPECT_FALSE(queue.TryPush(99));
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(MpmcQueueTest, MoveOnlyElementsAndDestruction) {
+  auto tracker = std::make_shared<int>(0);
+  {
+    MpmcQueue<std::shared_ptr<int>> queue(8);
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_TRUE(queue.TryPush(std::shared_ptr<int>(tracker)));
+    }
+    std::shared_ptr<int> popped;
+    ASSERT_TRUE(queue.TryPop(popped));
+    EXPECT_EQ(tracker, popped);
+    EXPECT_EQ(4, tracker.use_count());
+  }
+  // Elements left in the queue are destroyed with it
+  EXPECT_EQ(1, tracker.use_count());
+}
+
+TEST(MpmcQueueTest, ConcurrentProducersAndConsumers) {
+  MpmcQueue<int> queue(64);
+  const int producer_count = 4;
+  const int consumer_count = 4;
+  const int items_per_producer = 20000;
+
+  std::atomic<long long> sum(0);
+  std::atomic<int> consumed(0);
+  std::vector<std::thread> threads;
+
+  for (int p = 0; p < producer_count; ++p) {
+    threads.emplace_back([&queue]() {
+      for (int i = 1; i <= items_per_producer; ++i) {
+        int value = i;
+        while (!queue.TryPush(std::move(value))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  const int total = producer_count * items_per_producer;
+  for (int c = 0; c < consumer_count; ++c) {
+    threads.emplace_back([&]() {
+      int value = 0;
+      while (consumed.load() < total) {
+        if (queue.TryPop(value)) {
+          sum += value;
+          consumed++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const long long expected =
+      static_cast<long long>(producer_count) * items_per_producer * (items_per_producer + 1) / 2;
+  EXPECT_EQ(total, consumed.load());
+  EXPECT_EQ(expected, sum.load());
+}
+
+}  // namespace
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/parallel.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(ParallelTest, ForVisitsEveryIndexOnce) {
+  CallbackWorkerThread pool(4);
+  for (size_t grain : {size_t{0}, size_t{1}, size_t{7}, size_t{100000}}) {
+    std::vector<std::atomic<int>> visits(10000);
+    ParallelFor(pool, 0, 10000, [&](int i) { visits[static_cast<size_t>(i)].fetch_add(1); },
+                grain);
+    for (const auto& count : visits) {
+      ASSERT_EQ(1, count.load()) << "grain " << grain;
+    }
+  }
+
+  // Signed ranges, empty and reversed ranges
+  std::atomic<int64_t> sum{0};
+  ParallelFor(pool, int64_t{-500}, int64_t{501}, [&](int64_t i) { sum += i; });
+  EXPECT_EQ(0, sum.load());
+  std::atomic<int> visited{0};
+  ParallelFor(pool, int16_t{INT16_MIN}, int16_t{INT16_MAX}, [&](int16_t i) {
+    if (i >= INT16_MIN && i < INT16_MAX) {
+      visited++;
+    }
+  });
+  EXPECT_EQ(65535, visited.load());
+  int calls = 0;
+  ParallelFor(pool, 5, 5, [&](int) { ++calls; });
+  ParallelFor(pool, 5, 2, [&](int) { ++calls; });
+  EXPECT_EQ(0, calls);
+}
+
+TEST(ParallelTest, CallerParticipates) {
+  CallbackWorkerThread pool(2);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  ParallelFor(pool, 0, 1000, [&](int) {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.insert(std::this_thread::get_id());
+  }, 10);
+  // The caller always runs the lowest chunk itself
+  EXPECT_EQ(1u, threads.count(std::this_thread::get_id()));
+}
+
+TEST(ParallelTest, NestedLoopsOnOneWorkerDoNotDeadlock) {
+  CallbackWorkerThread pool(1);
+  std::atomic<int> count{0};
+  pool.Enqueue([&]() {
+    ParallelFor(pool, 0, 100, [&](int) {
+      ParallelFor(pool, 0, 100, [&](int) { ++count; }, 1);
+    }, 1);
+  }).get();
+  EXPECT_EQ(10000, count.load());
+}
+
+TEST(ParallelTest, ExceptionPropagates) {
+  CallbackWorkerThread pool(4);
+  EXPECT_THROW(ParallelFor(pool, 0, 1000, [](int i) {
+    if (i == 637) {
+      throw std::runtime_error("bad index");
+    }
+  }, 1), std::runtime_error);
+
+  // The pool is still usable afterwards
+  std::atomic<int> count{0};
+  ParallelFor(pool, 0, 100, [&](int) { ++count; });
+  EXPECT_EQ(100, count.load());
+}
+
+TEST(ParallelTest, ReduceCombinesInIndexOrder) {
+  CallbackWorkerThread pool(4);
+  const int64_t sum = ParallelReduce(
+      pool, 1, 100001, int64_t{0}, [](int i) { return static_cast<int64_t>(i); },
+      [](int64_t a, int64_t b) { return a + b; });
+  EXPECT_EQ(int64_t{5000050000}, sum);
+
+  // Concatenation is associative but not commutative
+  const std::string text = ParallelReduce(
+      pool, 0, 26, std::string(), [](int i) { return std::string(1, static_cast<char>('a' + i)); },
+      [](std::string a, const std::string& b) { return a + b; }, 1);
+  EXPECT_EQ("abcdefghijklmnopqrstuvwxyz", text);
+
+  EXPECT_EQ(42, ParallelReduce(pool, 3, 3, 42, [](int i) { return i; },
+                               [](int a, int b) { return a + b; }));
+}
+
+TEST(ParallelTest, TransformWritesEveryElement) {
+  CallbackWorkerThread pool(4);
+  std::vector<int> input(5000);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<int>(i);
+  }
+  std::vector<int64_t> output(input.size());
+  auto end = ParallelTransform(pool, input.begin(), input.end(), output.begin(),
+                               [](int x) { return int64_t{x} * x; });
+  EXPECT_EQ(output.end(), end);
+  for (size_t i = 0; i < output.size(); ++i) {
+    ASSERT_EQ(static_cast<int64_t>(i * i), output[i]);
+  }
+
+  // In place
+  ParallelTransform(pool, input.begin(), input.end(), input.begin(), [](int x) { return -x; });
+  EXPECT_EQ(-4999, input.back());
+}
+
+TEST(ParallelTest, StoppedPoolRunsOnCaller) {
+  CallbackWorkerThread pool(2);
+  pool.Stop();
+  std::set<std::thread::id> threads;
+  ParallelFor(pool, 0, 100, [&](int) { threads.insert(std::this_thread::get_id()); }, 1);
+  EXPECT_EQ(std::set<std::thread::id>{std::this_thread::get_id()}, threads);
+}
+
+}  // namespace
+
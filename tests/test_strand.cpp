@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/strand.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(StrandTest, RunsTasksInOrderWithoutOverlap) {
+  CallbackWorkerThread pool(4);
+  Strand strand(pool);
+
+  // Unsynchronized on purpose: the strand alone must serialize access
+  std::vector<int> order;
+  std::atomic<int> active{0};
+  std::atomic<bool> overlapped{false};
+  for (int i = 0; i < 2000; ++i) {
+    strand.Post([&, i]() {
+      if (active.fetch_add(1) != 0) {
+        overlapped = true;
+      }
+      order.push_back(i);
+      active.fetch_sub(1);
+    });
+  }
+  pool.WaitIdle();
+
+  EXPECT_FALSE(overlapped.load());
+  ASSERT_EQ(2000u, order.size());
+  for (int i = 0; i < 2000; ++i) {
+    EXPECT_EQ(i, order[static_cast<size_t>(i)]);
+  }
+}
+
+TEST(StrandTest, EnqueueReturnsResultsAndExceptions) {
+  CallbackWorkerThread pool(2);
+  Strand strand(pool);
+
+  auto sum = strand.Enqueue([](int a, int b) { return a + b; }, 2, 3);
+  auto failing = strand.Enqueue([]() -> int { throw std::runtime_error("strand failure"); });
+  EXPECT_EQ(5, sum.get());
+  EXPECT_THROW(failing.get(), std::runtime_error);
+
+  std::promise<std::string> reported;
+  pool.SetExceptionHandler([&reported](std::exception_ptr exception) {
+    try {
+      std::rethrow_exception(exception);
+    } catch (const std::exception& e) {
+      reported.set_value(e.what());
+    }
+  });
+  strand.Post([]() { throw std::runtime_error("posted failure"); });
+  EXPECT_EQ("posted failure", reported.get_future().get());
+}
+
+TEST(StrandTest, DifferentStrandsRunInParallel) {
+  CallbackWorkerThread pool(2);
+  Strand first(pool);
+  Strand second(pool);
+
+  // Each task waits for the other to start, which only succeeds if they overlap
+  std::promise<void> first_started;
+  std::promise<void> second_started;
+  auto first_seen = first_started.get_future().share();
+  auto second_seen = second_started.get_future().share();
+  auto a = first.Enqueue([&first_started, second_seen]() {
+    first_started.set_value();
+    return second_seen.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+  });
+  auto b = second.Enqueue([&second_started, first_seen]() {
+    second_started.set_value();
+    return first_seen.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+  });
+  EXPECT_TRUE(a.get());
+  EXPECT_TRUE(b.get());
+}
+
+TEST(StrandTest, RunningInThisThread) {
+  CallbackWorkerThread pool(2);
+  Strand strand(pool);
+  Strand other(pool);
+
+  EXPECT_FALSE(strand.RunningInThisThread());
+  auto inside = strand.Enqueue([&]() {
+    return strand.RunningInThisThread() && !other.RunningInThisThread();
+  });
+  EXPECT_TRUE(inside.get());
+
+  // A copy is the same strand
+  Strand copy = strand;
+  EXPECT_TRUE(copy.Enqueue([&strand]() { return strand.RunningInThisThread(); }).get());
+}
+
+TEST(StrandTest, StoppedPoolRejectsSubmission) {
+  CallbackWorkerThread pool;
+  Strand strand(pool);
+  pool.Stop();
+  EXPECT_THROW(strand.Post([]() {}), std::runtime_error);
+  EXPECT_THROW(strand.Enqueue([]() {}), std::runtime_error);
+}
+
+TEST(StrandTest, DropOldestNeverDropsTheDrainTask) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 1;
+  options.max_queue_size = 1;
+  options.overflow_policy = OverflowPolicy::kDropOldest;
+  CallbackWorkerThread pool(options);
+  Strand strand(pool);
+
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  pool.Post([opened]() { opened.wait(); });
+  while (pool.GetQueueSize() != 0) {
+    std::this_thread::yield();
+  }
+
+  // The full queue holds only the strand's drain task, which must survive the next post
+  std::atomic<int> runs{0};
+  strand.Post([&runs]() { runs++; });
+  pool.Post([]() {});
+  gate.set_value();
+  pool.WaitIdle();
+  EXPECT_EQ(1, runs.load());
+
+  auto later = strand.Enqueue([]() { return 7; });
+  ASSERT_EQ(std::future_status::ready, later.wait_for(std::chrono::seconds(2)));
+  EXPECT_EQ(7, later.get());
+}
+
+TEST(KeyedStrandDispatcherTest, KeepsPerKeyOrder) {
+  CallbackWorkerThread pool(4);
+  EXPECT_THROW((KeyedStrandDispatcher<int>(pool, 0)), std::invalid_argument);
+
+  KeyedStrandDispatcher<int> dispatcher(pool, 16);
+  EXPECT_EQ(16u, dispatcher.strand_count());
+  EXPECT_EQ(&dispatcher.StrandFor(7), &dispatcher.StrandFor(7));
+
+  constexpr int kKeys = 64;
+  constexpr int kTasksPerKey = 200;
+  std::vector<std::vector<int>> per_key(kKeys);
+  for (int i = 0; i < kTasksPerKey; ++i) {
+    for (int key = 0; key < kKeys; ++key) {
+      dispatcher.Post(key, [&per_key, key, i]() {
+        per_key[static_cast<size_t>(key)].push_back(i);
+      });
+    }
+  }
+  auto last = dispatcher.Enqueue(0, []() { return true; });
+  EXPECT_TRUE(last.get());
+  pool.WaitIdle();
+
+  for (const auto& sequence : per_key) {
+    ASSERT_EQ(static_cast<size_t>(kTasksPerKey), sequence.size());
+    for (int i = 0; i < kTasksPerKey; ++i) {
+      EXPECT_EQ(i, sequence[static_cast<size_t>(i)]);
+    }
+  }
+}
+
+}  // namespace
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <memory>
+#include <utility>
+
+#include "callback_worker_thread/task.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+// Counts live instances so tests can check that Task destroys what it stores
+struct Tracked {
+  static int live;
+  explicit Tracked(int* calls) : calls_(calls) { ++live; }
+  Tracked(Tracked&& other) noexcept : calls_(other.calls_) { ++live; }
+  Tracked(const Tracked& other) : calls_(other.calls_) { ++live; }
+  ~Tracked() { --live; }
+  void operator()() { ++*calls_; }
+  int* calls_;
+};
+int Tracked::live = 0;
+
+TEST(TaskTest, DefaultConstructedIsEmpty) {
+  Task task;
+  EXPECT_FALSE(static_cast<bool>(task));
+}
+
+TEST(TaskTest, SmallCallableIsStoredInline) {
+  auto small = [value = 1]() { (void)value; };
+  std::array<char, Task::kInlineSize + 1> big_payload{};
+  auto big = [big_payload]() { (void)big_payload; };
+
+  EXPECT_TRUE(Task::IsStoredInline<decltype(small)>());
+  EXPECT_FALSE(Task::IsStoredInline<decltype(big)>());
+}
+
+TEST(TaskTest, InvokesMoveOnlyCallable) {
+  auto pointer = std::make_unique<int>(41);
+  int result = 0;
+  Task task([pointer = std::move(pointer), &result]() { result = *pointer + 1; });
+
+  ASSERT_TRUE(static_cast<bool>(task));
+  task();
+  EXPECT_EQ(42, result);
+}
+
+TEST(TaskTest, MoveTransfersOwnershipInlineAndHeap) {
+  int calls = 0;
+  {
+    Task inline_task{Tracked(&calls)};
+    std::array<char, Task::kInlineSize> padding{};
+    Task heap_task([tracked = Tracked(&calls), padding]() mutable {
+      (void)padding;
+      tracked();
+    });
+    EXPECT_EQ(2, Tracked::live);
+
+    Task moved_inline(std::move(inline_task));
+    Task moved_heap;
+    moved_heap = std::move(heap_task);
+    EXPECT_FALSE(static_cast<bool>(inline_task));
+    EXPECT_FALSE(static_cast<bool>(heap_task));
+    EXPECT_EQ(2, Tracked::live);
+
+    moved_inline();
+    moved_heap();
+    EXPECT_EQ(2, calls);
+
+    // Assigning over a non-empty task destroys the old callable
+    moved_inline = std::move(moved_heap);
+    EXPECT_EQ(1, Tracked::live);
+  }
+  EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(TaskTest, ExceptionsPropagate) {
+  Task task([]() { throw std::runtime_error("boom"); });
+  EXPECT_THROW(task(), std::runtime_error);
+}
+
+TEST(TaskTest, TimestampTravelsWithTask) {
+  Task task([]() {});
+  EXPECT_EQ(0u, task.timestamp());
+  task.set_timestamp(42);
+
+  Task moved(std::move(task));
+  EXPECT_EQ(42u, moved.timestamp());
+  Task assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(42u, assigned.timestamp());
+}
+
+}  // namespace
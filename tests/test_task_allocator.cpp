@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/callback_worker_thread.h"
+#include "callback_worker_thread/task_allocator.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+class TaskAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#if defined(CALLBACK_WORKER_THREAD_NO_TASK_ALLOCATOR)
+    GTEST_SKIP() << "built with ENABLE_TASK_ALLOCATOR=OFF";
+#endif
+    // Make sure this thread's cache exists before the tests take their snapshots
+    detail::TaskDeallocate(detail::TaskAllocate(1));
+  }
+};
+
+TEST_F(TaskAllocatorTest, BlocksAreAlignedAndWritable) {
+  for (size_t size : {size_t{1}, size_t{48}, size_t{100}, size_t{500}, kMaxTaskBlockSize,
+                      kMaxTaskBlockSize + 1}) {
+    void* block = detail::TaskAllocate(size);
+    ASSERT_NE(nullptr, block);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t)) << size;
+    std::memset(block, 0xab, size);
+    detail::TaskDeallocate(block);
+  }
+}
+
+TEST_F(TaskAllocatorTest, ReusesFreedBlocks) {
+  const TaskAllocatorStats before = GetTaskAllocatorStats();
+  for (int i = 0; i < 10000; ++i) {
+    detail::TaskDeallocate(detail::TaskAllocate(64));
+  }
+  const TaskAllocatorStats after = GetTaskAllocatorStats();
+
+  EXPECT_LE(after.slab_allocations, before.slab_allocations + 1);
+  EXPECT_EQ(before.large_allocations, after.large_allocations);
+}
+
+TEST_F(TaskAllocatorTest, LargeRequestsUseOperatorNew) {
+  const TaskAllocatorStats before = GetTaskAllocatorStats();
+  void* block = detail::TaskAllocate(4096);
+  detail::TaskDeallocate(block);
+
+  EXPECT_EQ(before.large_allocations + 1, GetTaskAllocatorStats().large_allocations);
+}
+
+TEST_F(TaskAllocatorTest, RemoteFreesReturnToOwner) {
+  constexpr size_t kBlocks = 500;
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < kBlocks; ++i) {
+    blocks.push_back(detail::TaskAllocate(200));
+  }
+  const TaskAllocatorStats before = GetTaskAllocatorStats();
+
+  std::thread([&blocks] {
+    for (void* block : blocks) {
+      detail::TaskDeallocate(block);
+    }
+  }).join();
+
+  // The blocks freed by the other thread come back in one batch instead of new slabs
+  for (size_t i = 0; i < kBlocks; ++i) {
+    blocks[i] = detail::TaskAllocate(200);
+  }
+  const TaskAllocatorStats after = GetTaskAllocatorStats();
+  for (void* block : blocks) {
+    detail::TaskDeallocate(block);
+  }
+
+  EXPECT_EQ(before.slab_allocations, after.slab_allocations);
+  EXPECT_GT(after.remote_free_batches, before.remote_free_batches);
+}
+
+TEST_F(TaskAllocatorTest, CacheOutlivesItsThread) {
+  const TaskAllocatorStats before = GetTaskAllocatorStats();
+
+  std::vector<void*> blocks;
+  std::thread([&blocks] {
+    for (int i = 0; i < 3; ++i) {
+      blocks.push_back(detail::TaskAllocate(32));
+    }
+  }).join();
+  EXPECT_EQ(before.thread_caches + 1, GetTaskAllocatorStats().thread_caches);
+
+  for (void* block : blocks) {
+    std::memset(block, 0, 32);
+    detail::TaskDeallocate(block);
+  }
+  const TaskAllocatorStats after = GetTaskAllocatorStats();
+  EXPECT_EQ(before.thread_caches, after.thread_caches);
+  EXPECT_EQ(before.reserved_bytes, after.reserved_bytes);
+}
+
+TEST_F(TaskAllocatorTest, CacheCountsRemoteFreesBeforeAndAfterExit) {
+  const TaskAllocatorStats before = GetTaskAllocatorStats();
+
+  // The owner exits with some blocks still in its remote-free list and others still in use
+  std::vector<void*> blocks;
+  std::thread([&blocks] {
+    for (int i = 0; i < 6; ++i) {
+      blocks.push_back(detail::TaskAllocate(32));
+    }
+    std::thread([&blocks] {
+      for (int i = 0; i < 3; ++i) {
+        detail::TaskDeallocate(blocks[i]);
+      }
+    }).join();
+  }).join();
+  EXPECT_EQ(before.thread_caches + 1, GetTaskAllocatorStats().thread_caches);
+
+  for (int i = 3; i < 6; ++i) {
+    detail::TaskDeallocate(blocks[i]);
+  }
+  const TaskAllocatorStats after = GetTaskAllocatorStats();
+  EXPECT_EQ(before.thread_caches, after.thread_caches);
+  EXPECT_EQ(before.reserved_bytes, after.reserved_bytes);
+}
+
+TEST_F(TaskAllocatorTest, SteadyStateEnqueueNeedsNoNewSlabs) {
+  CallbackWorkerThread worker;
+  std::array<char, 2 * Task::kInlineSize> payload{};
+  auto run_batch = [&] {
+    for (int i = 0; i < 1000; ++i) {
+      // Too large for the inline buffer, so the task state is a slab block too
+      worker.Enqueue([payload](int value) { return payload[0] + value; }, i).get();
+    }
+  };
+
+  run_batch();
+  const TaskAllocatorStats before = GetTaskAllocatorStats();
+  run_batch();
+  const TaskAllocatorStats after = GetTaskAllocatorStats();
+
+  EXPECT_EQ(before.slab_allocations, after.slab_allocations);
+  EXPECT_EQ(before.large_allocations, after.large_allocations);
+}
+
+TEST_F(TaskAllocatorTest, WorkStealingDequeEntriesAreRecycled) {
+  CallbackWorkerThreadOptions options;
+  options.thread_count = 1;
+  options.work_stealing = true;
+  CallbackWorkerThread worker(options);
+  auto run_batch = [&worker] {
+    // Tasks posted from a worker go to its own deque; with one worker none are stolen
+    worker.Enqueue([&worker] {
+      for (int i = 0; i < 1000; ++i) {
+        worker.Post([] {});
+      }
+    }).get();
+    worker.WaitIdle();
+  };
+
+  const TaskAllocatorStats start = GetTaskAllocatorStats();
+  run_batch();
+  const TaskAllocatorStats before = GetTaskAllocatorStats();
+  run_batch();
+  const TaskAllocatorStats after = GetTaskAllocatorStats();
+
+  // The entries are the worker's only allocations: they fill its slabs once, then recycle
+  EXPECT_GT(before.slab_allocations, start.slab_allocations);
+  EXPECT_EQ(before.slab_allocations, after.slab_allocations);
+  EXPECT_EQ(before.large_allocations, after.large_allocations);
+}
+
+}  // namespace
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "callback_worker_thread/task_graph.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(TaskGraphTest, SuccessorsRunAfterAllPredecessors) {
+  CallbackWorkerThread pool(4);
+  TaskGraph graph;
+  std::atomic<int> clock{0};
+  int a = -1, b = -1, c = -1, d = -1;
+  const auto na = graph.Emplace([&]() { a = clock.fetch_add(1); });
+  const auto nb = graph.Emplace([&]() { b = clock.fetch_add(1); });
+  const auto nc = graph.Emplace([&]() { c = clock.fetch_add(1); });
+  const auto nd = graph.Emplace([&]() { d = clock.fetch_add(1); });
+  graph.Precede(na, nb);
+  graph.Precede(na, nc);
+  graph.Precede(nb, nd);
+  graph.Precede(nc, nd);
+  EXPECT_EQ(4u, graph.size());
+
+  graph.Run(pool).get();
+  EXPECT_EQ(0, a);
+  EXPECT_LT(a, b);
+  EXPECT_LT(a, c);
+  EXPECT_EQ(3, d);
+}
+
+TEST(TaskGraphTest, GraphIsReusableAndRunsConcurrently) {
+  CallbackWorkerThread pool(4);
+  TaskGraph graph;
+  std::atomic<int> runs{0};
+  const auto source = graph.Emplace([]() {});
+  const auto sink = graph.Emplace([&runs]() { runs.fetch_add(1); });
+  for (int i = 0; i < 100; ++i) {
+    const auto middle = graph.Emplace([]() {});
+    graph.Precede(source, middle);
+    graph.Precede(middle, sink);
+  }
+
+  graph.Run(pool).get();
+  auto first = graph.Run(pool);
+  auto second = graph.Run(pool);
+  first.get();
+  second.get();
+  EXPECT_EQ(3, runs.load());
+}
+
+TEST(TaskGraphTest, DeepGraphRunsOnSingleWorker) {
+  // A blocking pipeline of futures would need one thread per stage; the graph needs none
+  CallbackWorkerThread pool(1);
+  TaskGraph graph;
+  std::vector<int> order;
+  TaskGraph::NodeId previous = graph.Emplace([&order]() { order.push_back(0); });
+  for (int i = 1; i < 10000; ++i) {
+    const auto node = graph.Emplace([&order, i]() { order.push_back(i); });
+    graph.Precede(previous, node);
+    previous = node;
+  }
+
+  graph.Run(pool).get();
+  ASSERT_EQ(10000u, order.size());
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(i, order[static_cast<size_t>(i)]);
+  }
+}
+
+TEST(TaskGraphTest, ExceptionSkipsRemainingNodes) {
+  CallbackWorkerThread pool(2);
+  TaskGraph graph;
+  std::atomic<bool> fail{true};
+  std::atomic<int> downstream{0};
+  const auto thrower = graph.Emplace([&fail]() {
+    if (fail) {
+      throw std::runtime_error("node failure");
+    }
+  });
+  const auto after = graph.Emplace([&downstream]() { downstream.fetch_add(1); });
+  graph.Precede(thrower, after);
+
+  EXPECT_THROW(graph.Run(pool).get(), std::runtime_error);
+  EXPECT_EQ(0, downstream.load());
+
+  fail = false;
+  graph.Run(pool).get();
+  EXPECT_EQ(1, downstream.load());
+}
+
+TEST(TaskGraphTest, ValidatesStructure) {
+  CallbackWorkerThread pool;
+  TaskGraph graph;
+  graph.Run(pool).get();
+
+  const auto a = graph.Emplace([]() {});
+  const auto b = graph.Emplace([]() {});
+  EXPECT_THROW(graph.Precede(a, 5), std::out_of_range);
+  EXPECT_THROW(graph.Precede(a, a), std::invalid_argument);
+
+  graph.Precede(a, b);
+  graph.Precede(b, a);
+  EXPECT_THROW(graph.Run(pool), std::invalid_argument);
+
+  pool.Stop();
+  TaskGraph single;
+  single.Emplace([]() {});
+  EXPECT_THROW(single.Run(pool), std::runtime_error);
+}
+
+}  // namespace
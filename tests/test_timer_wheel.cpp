@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "callback_worker_thread/timer_wheel.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+struct TestTimer : TimerWheel::Entry {
+  int id = 0;
+};
+
+// Advance and collect the ids of the expired timers
+std::vector<int> AdvanceTo(TimerWheel& wheel, uint64_t tick) {
+  std::vector<int> fired;
+  wheel.Advance(tick, [&fired](TimerWheel::Entry* entry) {
+    fired.push_back(static_cast<TestTimer*>(entry)->id);
+  });
+  return fired;
+}
+
+TEST(TimerWheelTest, ExpiresInDeadlineOrderAcrossLevels) {
+  TimerWheel wheel(1000);
+  // Deadlines on levels 0, 1, 2 and 3, inserted out of order
+  const uint64_t deltas[] = {300000, 5, 70, 4100, 63, 64};
+  std::vector<TestTimer> timers(6);
+  for (size_t i = 0; i < timers.size(); ++i) {
+    timers[i].id = static_cast<int>(i);
+    wheel.Insert(&timers[i], 1000 + deltas[i]);
+  }
+  EXPECT_EQ(6u, wheel.size());
+
+  EXPECT_TRUE(AdvanceTo(wheel, 1004).empty());
+  EXPECT_EQ((std::vector<int>{1}), AdvanceTo(wheel, 1005));
+  EXPECT_EQ((std::vector<int>{4, 5, 2}), AdvanceTo(wheel, 1070));
+  EXPECT_EQ((std::vector<int>{3}), AdvanceTo(wheel, 1000 + 4100));
+  EXPECT_TRUE(AdvanceTo(wheel, 1000 + 299999).empty());
+  EXPECT_EQ((std::vector<int>{0}), AdvanceTo(wheel, 1000 + 400000));
+  EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimerWheelTest, DueEntriesFireOnNextTick) {
+  TimerWheel wheel(50);
+  TestTimer timer;
+  wheel.Insert(&timer, 10);
+  EXPECT_EQ(51u, wheel.NextEventTick());
+  EXPECT_EQ(1u, AdvanceTo(wheel, 51).size());
+}
+
+TEST(TimerWheelTest, RemoveUnlinksInConstantTime) {
+  TimerWheel wheel(0);
+  std::vector<TestTimer> timers(3);
+  for (size_t i = 0; i < timers.size(); ++i) {
+    timers[i].id = static_cast<int>(i);
+    wheel.Insert(&timers[i], 10);
+  }
+  wheel.Remove(&timers[1]);
+  EXPECT_FALSE(timers[1].linked);
+  EXPECT_EQ(2u, wheel.size());
+
+  std::vector<int> fired = AdvanceTo(wheel, 10);
+  EXPECT_EQ(2u, fired.size());
+  EXPECT_EQ(0u, wheel.size());
+  EXPECT_EQ(TimerWheel::kNever, wheel.NextEventTick());
+}
+
+TEST(TimerWheelTest, NextEventTickSkipsEmptySlots) {
+  TimerWheel wheel(0);
+  EXPECT_EQ(TimerWheel::kNever, wheel.NextEventTick());
+
+  TestTimer near;
+  TestTimer far;
+  wheel.Insert(&near, 7);
+  wheel.Insert(&far, 1000);
+  EXPECT_EQ(7u, wheel.NextEventTick());
+  AdvanceTo(wheel, 7);
+  // The far entry sits on level 1 and needs a cascade at its slot boundary first
+  EXPECT_EQ(960u, wheel.NextEventTick());
+  EXPECT_TRUE(AdvanceTo(wheel, 999).empty());
+  EXPECT_EQ(1000u, wheel.NextEventTick());
+}
+
+TEST(TimerWheelTest, EntriesBeyondRangeAreKept) {
+  TimerWheel wheel(0);
+  TestTimer timer;
+  const uint64_t expiry = uint64_t{1} << 40;
+  wheel.Insert(&timer, expiry);
+
+  EXPECT_TRUE(AdvanceTo(wheel, expiry - 1).empty());
+  EXPECT_EQ(1u, wheel.size());
+  EXPECT_EQ(1u, AdvanceTo(wheel, expiry).size());
+}
+
+TEST(TimerWheelTest, CallbackMayReinsert) {
+  TimerWheel wheel(0);
+  TestTimer timer;
+  wheel.Insert(&timer, 10);
+
+  int runs = 0;
+  auto rearm = [&](TimerWheel::Entry* entry) {
+    ++runs;
+    wheel.Insert(entry, entry->expiry + 10);
+  };
+  wheel.Advance(35, rearm);
+  EXPECT_EQ(3, runs);
+  EXPECT_EQ(40u, timer.expiry);
+  EXPECT_EQ(1u, wheel.size());
+}
+
+TEST(TimerWheelTest, ClearUnlinksEverything) {
+  TimerWheel wheel(0);
+  std::vector<TestTimer> timers(4);
+  const uint64_t expiries[] = {3, 100, 10000, 1000000};
+  for (size_t i = 0; i < timers.size(); ++i) {
+    wheel.Insert(&timers[i], expiries[i]);
+  }
+
+  size_t cleared = 0;
+  wheel.Clear([&cleared](TimerWheel::Entry* entry) {
+    EXPECT_FALSE(entry->linked);
+    ++cleared;
+  });
+  EXPECT_EQ(4u, cleared);
+  EXPECT_EQ(0u, wheel.size());
+  EXPECT_EQ(TimerWheel::kNever, wheel.NextEventTick());
+}
+
+}  // namespace
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "callback_worker_thread/work_stealing_deque.h"
+
+namespace {
+
+using namespace callback_worker_thread;
+
+TEST(WorkStealingDequeTest, OwnerPopsLifoThiefStealsFifo) {
+  WorkStealingDeque<int> deque(4);
+  for (int i = 0; i < 4; ++i) {
+    deque.Push(i);
+  }
+  EXPECT_EQ(4u, deque.Size());
+
+  int value = -1;
+  ASSERT_TRUE(deque.Steal(value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(deque.Pop(value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(deque.Pop(value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(deque.Steal(value));
+  EXPECT_EQ(1, value);
+
+  EXPECT_FALSE(deque.Pop(value));
+  EXPECT_FALSE(deque.Steal(value));
+  EXPECT_EQ(0u, deque.Size());
+}
+
+TEST(WorkStealingDequeTest, GrowsBeyondInitialCapacity) {
+  WorkStealingDeque<int> deque(2);
+  const int count = 1000;
+  for (int i = 0; i < count; ++i) {
+    deque.Push(i);
+  }
+
+  int value = -1;
+  for (int i = count - 1; i >= 0; --i) {
+    ASSERT_TRUE(deque.Pop(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(deque.Pop(value));
+}
+
+TEST(WorkStealingDequeTest, ConcurrentStealingTakesEveryElementOnce) {
+  WorkStealingDeque<int> deque(8);
+  const int count = 100000;
+  const int thief_count = 3;
+  std::vector<std::atomic<int>> seen(count);
+  std::atomic<int> taken(0);
+  std::atomic<bool> done(false);
+
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < thief_count; ++t) {
+    thieves.emplace_back([&]() {
+      int value = 0;
+      while (!done.load() || deque.Size() > 0) {
+        if (deque.Steal(value)) {
+          seen[value]++;
+          taken++;
+        }
+      }
+    });
+  }
+
+  // The owner interleaves pushes and pops while the thieves steal
+  int value = 0;
+  for (int i = 0; i < count; ++i) {
+    deque.Push(i);
+    if (i % 3 == 0 && deque.Pop(value)) {
+      seen[value]++;
+      taken++;
+    }
+  }
+  while (deque.Pop(value)) {
+    seen[value]++;
+    taken++;
+  }
+  done = true;
+
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+
+  EXPECT_EQ(count, taken.load());
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(1, seen[i].load()) << "element " << i;
+  }
+}
+
+}  // namespace